@@ -447,6 +447,16 @@ void ParseCommandLine(int argc, const char* argv[],
              (*plainJsonPtr)["dev_score_calc_obj_block_size"] = size;
          });
 
+    parser.AddLongOption("dev-permuted-features-ram-limit",
+                         "CPU only. Memory for copies of quantized features reordered by fold permutations."
+                         " Folds that do not fit are read through the permutation."
+                         " Used only for learning speed tuning, does not change results."
+                         " Allowed suffixes: GB, MB, KB in different cases")
+         .RequiredArgument("SIZE")
+         .Handler1T<TString>([plainJsonPtr](const TString& limit) {
+             (*plainJsonPtr)["dev_permuted_features_ram_limit"] = limit;
+         });
+
     parser.AddLongOption("random-strength")
         .RequiredArgument("float")
         .Handler1T<float>([plainJsonPtr](float randomStrength) {
@@ -501,6 +511,7 @@ void ParseCommandLine(int argc, const char* argv[],
               " Poisson,"
               " Bayesian,"
               " Bernoulli,"
+              " GOSS,"
               " No. By default CatBoost uses bayesian bootstrap type")
         .Handler1T<TString>([plainJsonPtr](const TString& type) {
             (*plainJsonPtr)["bootstrap_type"] = type;
@@ -527,7 +538,16 @@ void ParseCommandLine(int argc, const char* argv[],
         .Handler1T<float>([plainJsonPtr](float rate) {
             (*plainJsonPtr)["subsample"] = rate;
         })
-        .Help("Controls sample rate for bagging. Could be used iff bootstrap-type is Poisson, Bernoulli. Possible values are from (0, 1]; 0.66 by default."
+        .Help("Controls sample rate for bagging. Could be used iff bootstrap-type is Poisson, Bernoulli, GOSS. Possible values are from (0, 1]; 0.66 by default."
+        );
+
+    parser
+        .AddLongOption("large-gradient-fraction")
+        .RequiredArgument("Float")
+        .Handler1T<float>([plainJsonPtr](float fraction) {
+            (*plainJsonPtr)["large_gradient_fraction"] = fraction;
+        })
+        .Help("Fraction of objects with the largest gradients always taken by GOSS bootstrap, the rest are sampled with subsample rate. Possible values are from (0, 1); 0.2 by default."
         );
 
     parser
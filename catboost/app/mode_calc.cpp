@@ -33,6 +33,16 @@ static TEvalResult Apply(
     } else {
         rawValues[0].resize(model.ObliviousTrees.ApproxDimension, TVector<double>(pool.Docs.GetDocCount(), 0.0));
     }
+    if (begin + evalPeriod >= end) {
+        // single prediction, features of the pool are passed to CalcFlatTransposed without copying
+        const auto approx = ApplyModelMulti(model, pool, EPredictionType::InternalRawFormulaVal, begin, end, *executor);
+        for (size_t i = 0; i < approx.size(); ++i) {
+            for (size_t j = 0; j < approx[0].size(); ++j) {
+                rawValues[0][i][j] += approx[i][j];
+            }
+        }
+        return resultApprox;
+    }
     TModelCalcerOnPool modelCalcerOnPool(model, pool, *executor);
     TVector<double> flatApprox;
     TVector<TVector<double>> approx;
@@ -115,32 +125,41 @@ int mode_calc(int argc, const char* argv[]) {
     NPar::TLocalExecutor executor;
     executor.RunAdditionalThreads(params.ThreadCount - 1);
 
+    const auto visibleLabelsHelper = BuildLabelsHelper<TExternalLabelsHelper>(model);
+
     SetVerboseLogingMode();
     bool IsFirstBlock = true;
-    ReadAndProceedPoolInBlocks(params, blockSize, [&](const TPool& poolPart) {
-        if (IsFirstBlock) {
-            ValidateColumnOutput(params.OutputColumnsIds, poolPart, true);
-        }
-        auto approx = Apply(model, poolPart, 0, iterationsLimit, evalPeriod, &executor);
-        auto visibleLabelsHelper = BuildLabelsHelper<TExternalLabelsHelper>(model);
-
-        SetSilentLogingMode();
-        approx.OutputToFile(
-                &executor,
-                params.OutputColumnsIds,
-                visibleLabelsHelper,
-                poolPart,
-                true,
-                &outputStream,
-                // TODO: src file columns output is incompatible with block processing
-                /*testSetPath*/NCB::TPathWithScheme(),
-                /*testFileWhichOf*/ {0, 0},
-                params.DsvPoolFormatParams.Format,
-                IsFirstBlock,
-                std::make_pair(evalPeriod, iterationsLimit)
-        );
-        IsFirstBlock = false;
-    }, &executor);
+    ReadProcessAndWritePoolInBlocks<TEvalResult>(
+        params,
+        blockSize,
+        /*maxBlocksInFlight*/ 4,
+        [&](const TPool& poolPart) {
+            return Apply(model, poolPart, 0, iterationsLimit, evalPeriod, &executor);
+        },
+        [&](const TPool& poolPart, TEvalResult&& approx) {
+            if (IsFirstBlock) {
+                ValidateColumnOutput(params.OutputColumnsIds, poolPart, true);
+            }
+
+            SetSilentLogingMode();
+            approx.OutputToFile(
+                    &executor,
+                    params.OutputColumnsIds,
+                    visibleLabelsHelper,
+                    poolPart,
+                    true,
+                    &outputStream,
+                    // TODO: src file columns output is incompatible with block processing
+                    /*testSetPath*/NCB::TPathWithScheme(),
+                    /*testFileWhichOf*/ {0, 0},
+                    params.DsvPoolFormatParams.Format,
+                    IsFirstBlock,
+                    std::make_pair(evalPeriod, iterationsLimit)
+            );
+            IsFirstBlock = false;
+        },
+        &executor
+    );
 
     return 0;
 }
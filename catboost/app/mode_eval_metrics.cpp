@@ -105,6 +105,11 @@ int mode_eval_metrics(int argc, const char* argv[]) {
         .SetFlag(&calcOnParts)
         .NoArgument();
 
+    bool exactNonAdditiveMetrics = false;
+    parser.AddLongOption("exact-non-additive-metrics", "With --calc-on-parts: save approxes to tmp-dir instead of approximate evaluation by sketches (AUC error is at most half of the share of pairs with approxes within 2^-7 relative distance, MedianAbsoluteError relative error is at most 2^-8)")
+        .SetFlag(&exactNonAdditiveMetrics)
+        .NoArgument();
+
     parser.SetFreeArgsNum(0);
     {
         NLastGetopt::TOptsParseResult parseResult(&parser, argc, argv);
@@ -145,6 +150,12 @@ int mode_eval_metrics(int argc, const char* argv[]) {
         metrics
     );
 
+    if (calcOnParts && !exactNonAdditiveMetrics && plotCalcer.HasNonAdditiveMetric()) {
+        if (!plotCalcer.SetUseMetricSketches(true)) {
+            MATRIXNET_WARNING_LOG << "Some of non-additive metrics don't support sketches, approxes will be saved to tmp-dir" << Endl;
+        }
+    }
+
     auto labelConverter = BuildLabelsHelper<TLabelConverter>(model);
 
     TVector<TPool> datasetParts;
@@ -11,6 +11,7 @@
 #include <library/getopt/small/last_getopt.h>
 
 #include <util/generic/ptr.h>
+#include <util/stream/file.h>
 #include <util/system/fs.h>
 #include <util/string/iterator.h>
 
@@ -66,7 +67,7 @@ int mode_fstr(int argc, const char* argv[]) {
     params.BindParserOpts(parser);
     parser.FindLongOption("output-path")
         ->DefaultValue("feature_strength.tsv");
-    parser.AddLongOption("fstr-type", "Should be one of: FeatureImportance, InternalFeatureImportance, Interaction, InternalInteraction, ShapValues")
+    parser.AddLongOption("fstr-type", "Should be one of: FeatureImportance, InternalFeatureImportance, Interaction, InternalInteraction, ShapValues, LossFunctionChange")
         .RequiredArgument("fstr-type")
         .Handler1T<TString>([&params](const TString& fstrType) {
             CB_ENSURE(TryFromString<EFstrType>(fstrType, params.FstrType), fstrType + " fstr type is not supported");
@@ -77,6 +78,18 @@ int mode_fstr(int argc, const char* argv[]) {
             CB_ENSURE(TryFromString<int>(verbose, params.Verbose), "verbose should be integer");
             CB_ENSURE(params.Verbose >= 0, "verbose should be non-negative");
         });
+    TString shapPreparedTreesPath;
+    parser.AddLongOption("shap-prepared-trees", "File with prepared trees for ShapValues, they are loaded if the file exists and saved to it otherwise")
+        .RequiredArgument("PATH")
+        .StoreResult(&shapPreparedTreesPath);
+    double lossChangeSampleRate = 1.0;
+    parser.AddLongOption("loss-change-sample-rate", "LossFunctionChange is calculated on a random sample of this part of the pool")
+        .DefaultValue("1")
+        .StoreResult(&lossChangeSampleRate);
+    ui64 lossChangeRandomSeed = 0;
+    parser.AddLongOption("loss-change-random-seed", "Random seed for sampling of the pool for LossFunctionChange")
+        .DefaultValue("0")
+        .StoreResult(&lossChangeRandomSeed);
     parser.SetFreeArgsNum(0);
     NLastGetopt::TOptsParseResult parserResult{&parser, argc, argv};
 
@@ -109,8 +122,31 @@ int mode_fstr(int argc, const char* argv[]) {
         case EFstrType::InternalInteraction:
             CalcAndOutputInteraction(model, nullptr, &params.OutputPath);
             break;
-        case EFstrType::ShapValues:
-            CalcAndOutputShapValues(model, poolLoader(), params.OutputPath, params.ThreadCount, params.Verbose);
+        case EFstrType::ShapValues: {
+            if (shapPreparedTreesPath.empty()) {
+                CalcAndOutputShapValues(model, poolLoader(), params.OutputPath, params.ThreadCount, params.Verbose);
+                break;
+            }
+            NPar::TLocalExecutor localExecutor;
+            localExecutor.RunAdditionalThreads(params.ThreadCount - 1);
+            TShapPreparedTrees preparedTrees;
+            if (NFs::Exists(shapPreparedTreesPath)) {
+                preparedTrees = LoadShapPreparedTrees(model, poolLoader(), shapPreparedTreesPath);
+            } else {
+                preparedTrees = PrepareTrees(model, poolLoader(), &localExecutor, params.Verbose);
+                SaveShapPreparedTrees(preparedTrees, shapPreparedTreesPath);
+            }
+            TFileOutput out(params.OutputPath);
+            CalcAndOutputShapValues(model, poolLoader(), preparedTrees, &out, &localExecutor, params.Verbose);
+            break;
+        }
+        case EFstrType::LossFunctionChange:
+            CalcAndOutputLossFunctionChange(model,
+                                            poolLoader(),
+                                            lossChangeSampleRate,
+                                            lossChangeRandomSeed,
+                                            params.ThreadCount,
+                                            params.OutputPath);
             break;
         default:
             Y_ASSERT(false);
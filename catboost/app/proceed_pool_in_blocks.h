@@ -4,19 +4,26 @@
 
 #include <catboost/libs/data/doc_pool_data_provider.h>
 #include <catboost/libs/data/load_data.h>
+#include <catboost/libs/helpers/bounded_queue.h>
 
 #include <library/threading/local_executor/local_executor.h>
 
-template <class TConsumer>
-inline void ReadAndProceedPoolInBlocks(const TAnalyticalModeCommonParams& params,
-                                       ui32 blockSize,
-                                       TConsumer&& poolConsumer,
-                                       NPar::TLocalExecutor* localExecutor) {
-    TPool pool;
-    THolder<NCB::IPoolBuilder> poolBuilder = NCB::InitBuilder(params.InputPath, *localExecutor, &pool);
-    NCB::TTargetConverter targetConverter = NCB::MakeTargetConverter(params.ClassNames);
+#include <util/generic/ptr.h>
+#include <util/generic/vector.h>
+#include <util/system/guard.h>
+#include <util/system/mutex.h>
+#include <util/system/thread.h>
 
-    auto docPoolDataProvider = NCB::GetProcessor<NCB::IDocPoolDataProvider>(
+#include <exception>
+#include <functional>
+
+inline THolder<NCB::IDocPoolDataProvider> CreatePoolInBlocksDataProvider(
+    const TAnalyticalModeCommonParams& params,
+    ui32 blockSize,
+    NCB::TTargetConverter* targetConverter,
+    NPar::TLocalExecutor* localExecutor
+) {
+    return NCB::GetProcessor<NCB::IDocPoolDataProvider>(
         params.InputPath, // for choosing processor
 
         // processor args
@@ -30,13 +37,140 @@ inline void ReadAndProceedPoolInBlocks(const TAnalyticalModeCommonParams& params
                 MakeCdProviderFromFile(params.DsvPoolFormatParams.CdFilePath),
                 /*ignoredFeatures*/ {},
                 blockSize,
-                &targetConverter,
+                targetConverter,
                 localExecutor
             }
         }
     );
+}
+
+template <class TConsumer>
+inline void ReadAndProceedPoolInBlocks(const TAnalyticalModeCommonParams& params,
+                                       ui32 blockSize,
+                                       TConsumer&& poolConsumer,
+                                       NPar::TLocalExecutor* localExecutor) {
+    TPool pool;
+    THolder<NCB::IPoolBuilder> poolBuilder = NCB::InitBuilder(params.InputPath, *localExecutor, &pool);
+    NCB::TTargetConverter targetConverter = NCB::MakeTargetConverter(params.ClassNames);
+
+    auto docPoolDataProvider = CreatePoolInBlocksDataProvider(params, blockSize, &targetConverter, localExecutor);
 
     while (docPoolDataProvider->DoBlock(poolBuilder.Get())) {
         poolConsumer(pool);
     }
 }
+
+/*
+ * Same as ReadAndProceedPoolInBlocks with the consumer split into two stages, but the stages run
+ *  as a pipeline: while block i is written, block i + 1 is processed and block i + 2 is read.
+ *  So the total time is determined by the slowest stage instead of the sum of all of them.
+ *
+ * processFunc should be of type 'TResult(const TPool& poolPart)',
+ *  it runs in a separate thread and can use localExecutor.
+ * writeFunc should be of type 'void(const TPool& poolPart, TResult&& result)',
+ *  it runs in a separate thread and is called for blocks in the order they are read.
+ *
+ * At most maxBlocksInFlight blocks are kept in memory, it must be at least 3 for all stages to overlap.
+ * Exceptions from any stage stop the pipeline and are rethrown.
+ */
+template <class TResult, class TProcessFunc, class TWriteFunc>
+inline void ReadProcessAndWritePoolInBlocks(const TAnalyticalModeCommonParams& params,
+                                            ui32 blockSize,
+                                            ui32 maxBlocksInFlight,
+                                            TProcessFunc&& processFunc,
+                                            TWriteFunc&& writeFunc,
+                                            NPar::TLocalExecutor* localExecutor) {
+    CB_ENSURE(maxBlocksInFlight > 0, "maxBlocksInFlight == 0");
+
+    struct TBlock {
+        TPool Pool;
+        THolder<NCB::IPoolBuilder> PoolBuilder;
+        TResult Result;
+    };
+
+    // pool builders keep pointers to pools, so blocks are never moved
+    TVector<THolder<TBlock>> blocks;
+    NCB::TBoundedQueue<ui32> freeBlocks(maxBlocksInFlight);
+    for (ui32 blockIdx = 0; blockIdx < maxBlocksInFlight; ++blockIdx) {
+        blocks.push_back(MakeHolder<TBlock>());
+        blocks.back()->PoolBuilder = NCB::InitBuilder(params.InputPath, *localExecutor, &blocks.back()->Pool);
+        freeBlocks.Push(blockIdx);
+    }
+    NCB::TBoundedQueue<ui32> readBlocks(maxBlocksInFlight);
+    NCB::TBoundedQueue<ui32> processedBlocks(maxBlocksInFlight);
+
+    TMutex exceptionMutex;
+    std::exception_ptr firstException;
+    auto runStage = [&] (auto&& stage) {
+        try {
+            stage();
+        } catch (...) {
+            with_lock (exceptionMutex) {
+                if (!firstException) {
+                    firstException = std::current_exception();
+                }
+            }
+            freeBlocks.Stop();
+            readBlocks.Stop();
+            processedBlocks.Stop();
+        }
+    };
+
+    std::function<void()> processStage = [&] () {
+        runStage([&] () {
+            ui32 blockIdx;
+            while (readBlocks.Pop(&blockIdx)) {
+                TBlock& block = *blocks[blockIdx];
+                block.Result = processFunc(block.Pool);
+                if (!processedBlocks.Push(blockIdx)) {
+                    return;
+                }
+            }
+            processedBlocks.Finish();
+        });
+    };
+    std::function<void()> writeStage = [&] () {
+        runStage([&] () {
+            ui32 blockIdx;
+            while (processedBlocks.Pop(&blockIdx)) {
+                TBlock& block = *blocks[blockIdx];
+                writeFunc(block.Pool, std::move(block.Result));
+                block.Result = TResult();
+                if (!freeBlocks.Push(blockIdx)) {
+                    return;
+                }
+            }
+        });
+    };
+    auto runFunction = [] (void* function) -> void* {
+        (*static_cast<std::function<void()>*>(function))();
+        return nullptr;
+    };
+    TThread processThread(runFunction, &processStage);
+    TThread writeThread(runFunction, &writeStage);
+    processThread.Start();
+    writeThread.Start();
+
+    // read stage
+    runStage([&] () {
+        NCB::TTargetConverter targetConverter = NCB::MakeTargetConverter(params.ClassNames);
+        auto docPoolDataProvider = CreatePoolInBlocksDataProvider(params, blockSize, &targetConverter, localExecutor);
+
+        ui32 blockIdx;
+        while (freeBlocks.Pop(&blockIdx)) {
+            if (!docPoolDataProvider->DoBlock(blocks[blockIdx]->PoolBuilder.Get())) {
+                break;
+            }
+            if (!readBlocks.Push(blockIdx)) {
+                return;
+            }
+        }
+        readBlocks.Finish();
+    });
+
+    processThread.Join();
+    writeThread.Join();
+    if (firstException) {
+        std::rethrow_exception(firstException);
+    }
+}
@@ -410,7 +410,7 @@ void NCatboostCuda::ReadPool(
     NPar::TLocalExecutor* const localExecutor,
     TDataProviderBuilder* const poolBuilder) {
 
-    if (poolPath.Scheme != "quantized" && poolPath.Scheme != "yt-quantized") {
+    if (poolPath.Scheme != "quantized" && poolPath.Scheme != "yt-quantized" && poolPath.Scheme != "bc-quantized") {
         ::NCB::ReadPool(
             poolPath,
             pairsFilePath,
@@ -438,7 +438,7 @@ void NCatboostCuda::ReadPool(
     loadParameters.LockMemory = false;
     loadParameters.Precharge = false;
 
-    const auto pool = NCB::LoadQuantizedPool(poolPath.Path, loadParameters);
+    const auto pool = NCB::LoadQuantizedPool(poolPath, loadParameters);
     const auto& poolMetaInfo = GetPoolMetaInfo(pool, groupWeightsFilePath.Inited());
 
     const auto columnIndexToFeatureIndex = GetColumnIndexToFeatureIndexMap(pool);
@@ -466,8 +466,8 @@ void NCatboostCuda::ReadPool(
         baselineIndex += static_cast<size_t>(columnType == EColumn::Baseline);
     }
 
-    NCB::SetGroupWeights(groupWeightsFilePath, poolBuilder);
-    NCB::SetPairs(pairsFilePath, poolMetaInfo.HasGroupWeight, poolBuilder);
+    NCB::SetGroupWeights(groupWeightsFilePath, localExecutor, poolBuilder);
+    NCB::SetPairs(pairsFilePath, poolMetaInfo.HasGroupWeight, localExecutor, poolBuilder);
 
     poolBuilder->Finish();
 }
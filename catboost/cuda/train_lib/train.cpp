@@ -325,12 +325,14 @@ namespace NCatboostCuda {
         TVector<ui64> indices(learnPool.Docs.GetDocCount());
         std::iota(indices.begin(), indices.end(), 0);
 
-        ui64 minTimestamp = *MinElement(learnPool.Docs.Timestamp.begin(), learnPool.Docs.Timestamp.end());
-        ui64 maxTimestamp = *MaxElement(learnPool.Docs.Timestamp.begin(), learnPool.Docs.Timestamp.end());
-
-        if (minTimestamp != maxTimestamp) {
-            indices = CreateOrderByKey(learnPool.Docs.Timestamp);
-            catBoostOptions.DataProcessingOptions->HasTimeFlag = true;
+        const auto& timestamps = learnPool.Docs.Timestamp;
+        if (!timestamps.empty()) {
+            ui64 minTimestamp = *MinElement(timestamps.begin(), timestamps.end());
+            ui64 maxTimestamp = *MaxElement(timestamps.begin(), timestamps.end());
+            if (minTimestamp != maxTimestamp) {
+                indices = CreateOrderByKey(timestamps);
+                catBoostOptions.DataProcessingOptions->HasTimeFlag = true;
+            }
         }
 
         const ui32 numThreads = catBoostOptions.SystemOptions->NumThreads;
@@ -441,7 +443,7 @@ namespace NCatboostCuda {
         TVector<TTargetClassifier> targetClassifiers;
         //will be set to skip if pool without categorical features
         EFinalCtrComputationMode ctrComputationMode = outputOptions.GetFinalCtrComputationMode();
-        if (poolLoadOptions.LearnSetPath.Scheme == "quantized") {
+        if (poolLoadOptions.LearnSetPath.Scheme == "quantized" || poolLoadOptions.LearnSetPath.Scheme == "bc-quantized") {
             // TODO(yazevnul): quantized pool do not support categorical features yet
             ctrComputationMode = EFinalCtrComputationMode::Skip;
         }
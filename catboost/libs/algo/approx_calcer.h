@@ -15,13 +15,13 @@
 #include <catboost/libs/logging/profile_info.h>
 #include <catboost/libs/options/enum_helpers.h>
 
-template <bool StoreExpApprox, int VectorWidth>
-inline void UpdateApproxKernel(const double* leafValues, const TIndexType* indices, double* resArr) {
+template <bool StoreExpApprox, int VectorWidth, typename TLeafIndex>
+inline void UpdateApproxKernel(const double* leafValues, const TLeafIndex* indices, double* resArr) {
     Y_ASSERT(VectorWidth == 4);
-    const TIndexType idx0 = indices[0];
-    const TIndexType idx1 = indices[1];
-    const TIndexType idx2 = indices[2];
-    const TIndexType idx3 = indices[3];
+    const TLeafIndex idx0 = indices[0];
+    const TLeafIndex idx1 = indices[1];
+    const TLeafIndex idx2 = indices[2];
+    const TLeafIndex idx3 = indices[3];
     const double resArr0 = resArr[0];
     const double resArr1 = resArr[1];
     const double resArr2 = resArr[2];
@@ -36,11 +36,11 @@ inline void UpdateApproxKernel(const double* leafValues, const TIndexType* indic
     resArr[3] = UpdateApprox<StoreExpApprox>(resArr3, value3);
 }
 
-template <bool StoreExpApprox>
+template <bool StoreExpApprox, typename TLeafIndex>
 inline void UpdateApproxBlock(
     const NPar::TLocalExecutor::TExecRangeParams& params,
     const double* leafValues,
-    const TIndexType* indices,
+    const TLeafIndex* indices,
     int blockIdx,
     double* resArr
 ) {
@@ -56,9 +56,9 @@ inline void UpdateApproxBlock(
     }
 }
 
-template <bool StoreExpApprox>
+template <bool StoreExpApprox, typename TLeafIndex>
 inline void UpdateApproxDeltas(
-    const TVector<TIndexType>& indices,
+    const TVector<TLeafIndex>& indices,
     int docCount,
     NPar::TLocalExecutor* localExecutor,
     TVector<double>* leafValues,
@@ -67,7 +67,7 @@ inline void UpdateApproxDeltas(
     ExpApproxIf(StoreExpApprox, leafValues);
 
     double* resArrData = resArr->data();
-    const TIndexType* indicesData = indices.data();
+    const TLeafIndex* indicesData = indices.data();
     const double* leafValuesData = leafValues->data();
 
     NPar::TLocalExecutor::TExecRangeParams blockParams(0, docCount);
@@ -109,11 +109,44 @@ void CalcShiftedApproxDers(
         );
     }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
+
+// count of tail objects with derivatives calculated in parallel before their sequential bucket updates
+inline int GetTailDersBlockSize(const NPar::TLocalExecutor& localExecutor) {
+    return APPROX_BLOCK_SIZE * (localExecutor.GetThreadCount() + 1);
+}
+
+// ders are indexed by z - blockStart, sumAllWeights is the weight of all objects before blockStart
+template <ELeavesEstimation LeafEstimationType, bool StoreExpApprox, typename TLeafIndex>
+void CalcTailModelBlock(
+    const TDers* ders,
+    const TLeafIndex* indices,
+    const TVector<float>& weights,
+    int blockStart,
+    int blockFinish,
+    int iteration,
+    float l2Regularizer,
+    double* sumAllWeights,
+    TSum* buckets,
+    double* approxDeltas
+) {
+    double avrg[1];
+    for (int z = blockStart; z < blockFinish; ++z) {
+        TSum& bucket = buckets[indices[z]];
+        const double w = weights.empty() ? 1 : weights[z];
+        UpdateBucket<LeafEstimationType>(ders[z - blockStart], w, iteration, &bucket);
+        avrg[0] = CalcModel<LeafEstimationType>(bucket, iteration, l2Regularizer, *sumAllWeights, z);
+        *sumAllWeights += w;
+        if (StoreExpApprox) {
+            FastExpInplace(avrg, 1);
+        }
+        approxDeltas[z] = UpdateApprox<StoreExpApprox>(approxDeltas[z], avrg[0]);
+    }
+}
 } // anonymous namespace
 
-template <typename TError>
+template <typename TError, typename TLeafIndex>
 void CalcApproxDersRange(
-    const TVector<TIndexType>& indices,
+    const TVector<TLeafIndex>& indices,
     const TVector<float>& targets,
     const TVector<float>& weights,
     const TVector<double>& approxes,
@@ -123,8 +156,7 @@ void CalcApproxDersRange(
     int iteration,
     ELeavesEstimation estimationMethod,
     NPar::TLocalExecutor* localExecutor,
-    TVector<TSum>* buckets,
-    TVector<TDers>* weightedDers
+    TVector<TSum>* buckets
 ) {
     NPar::TLocalExecutor::TExecRangeParams blockParams(0, sampleCount);
     blockParams.SetBlockCount(CB_THREAD_LIMIT);
@@ -137,15 +169,15 @@ void CalcApproxDersRange(
     // Check speedup on flights dataset.
     TVector<TVector<double>> blockBucketSumWeights(blockParams.GetBlockCount(), TVector<double>(leafCount, 0));
     TVector<double>* blockBucketSumWeightsData = blockBucketSumWeights.data();
-    const TIndexType* indicesData = indices.data();
+    const TLeafIndex* indicesData = indices.data();
     const float* targetsData = targets.data();
     const float* weightsData = weights.data();
     const double* approxesData = approxes.data();
     const double* approxesDeltaData = approxesDelta.data();
-    TDers* weightedDersData = weightedDers->data();
     localExecutor->ExecRange([=](int blockId) {
         constexpr int innerBlockSize = APPROX_BLOCK_SIZE;
-        TDers* approxesDer = weightedDersData + innerBlockSize * blockId;
+        double firstDers[innerBlockSize];
+        double secondDers[innerBlockSize];
 
         const int blockStart = blockId * blockParams.GetBlockSize();
         const int nextBlockStart = Min(sampleCount, blockStart + blockParams.GetBlockSize());
@@ -163,20 +195,20 @@ void CalcApproxDersRange(
                 approxesDeltaData,
                 targetsData,
                 weightsData,
-                approxesDer - innerBlockStart
+                TDersArrays{firstDers - innerBlockStart, secondDers - innerBlockStart, /*Der3*/ nullptr}
             );
             if (weightsData != nullptr) {
                 for (int z = innerBlockStart; z < nextInnerBlockStart; ++z) {
                     TDers& ders = bucketDers[indicesData[z]];
-                    ders.Der1 += approxesDer[z - innerBlockStart].Der1;
-                    ders.Der2 += approxesDer[z - innerBlockStart].Der2;
+                    ders.Der1 += firstDers[z - innerBlockStart];
+                    ders.Der2 += secondDers[z - innerBlockStart];
                     bucketSumWeights[indicesData[z]] += weightsData[z];
                 }
             } else {
                 for (int z = innerBlockStart; z < nextInnerBlockStart; ++z) {
                     TDers& ders = bucketDers[indicesData[z]];
-                    ders.Der1 += approxesDer[z - innerBlockStart].Der1;
-                    ders.Der2 += approxesDer[z - innerBlockStart].Der2;
+                    ders.Der1 += firstDers[z - innerBlockStart];
+                    ders.Der2 += secondDers[z - innerBlockStart];
                     bucketSumWeights[indicesData[z]] += 1;
                 }
             }
@@ -213,9 +245,9 @@ void CalcApproxDersRange(
     }
 }
 
-template <typename TError>
+template <typename TError, typename TLeafIndex>
 void UpdateBucketsSimple(
-    const TVector<TIndexType>& indices,
+    const TVector<TLeafIndex>& indices,
     const TFold& ff,
     const TFold::TBodyTail& bt,
     const TVector<double>& approxes,
@@ -244,8 +276,7 @@ void UpdateBucketsSimple(
             iteration,
             estimationMethod,
             localExecutor,
-            buckets,
-            scratchDers
+            buckets
         );
     } else {
         Y_ASSERT(error.GetErrorType() == EErrorType::QuerywiseError || error.GetErrorType() == EErrorType::PairwiseError);
@@ -323,9 +354,9 @@ inline void CalcMixedModelSimple(
     }
 }
 
-template <typename TError>
+template <typename TError, typename TLeafIndex>
 void CalcTailModelSimple(
-    const TVector<TIndexType>& indices,
+    const TVector<TLeafIndex>& indices,
     const TFold& ff,
     const TFold::TBodyTail& bt,
     const TError& error,
@@ -348,52 +379,44 @@ void CalcTailModelSimple(
     const TVector<TQueryInfo>& queriesInfo = shouldGenerateYetiRankPairs ? recalculatedQueriesInfo : ff.LearnQueriesInfo;
     const TVector<float>& weights = bt.PairwiseWeights.empty() ? ff.GetLearnWeights() : shouldGenerateYetiRankPairs ? recalculatedPairwiseWeights : bt.PairwiseWeights;
 
-    if (error.GetErrorType() == EErrorType::PerObjectError) {
-        CalcShiftedApproxDers(bt.Approx[0], *approxDeltas, ff.LearnTarget, weights, error, bt.BodyFinish, bt.TailFinish, weightedDers, ctx);
-    } else {
-        Y_ASSERT(error.GetErrorType() == EErrorType::QuerywiseError || error.GetErrorType() == EErrorType::PairwiseError);
-        CalculateDersForQueries(bt.Approx[0], *approxDeltas, ff.LearnTarget, weights, queriesInfo, error, bt.BodyQueryFinish, bt.TailQueryFinish, weightedDers);
-    }
-    TSum* bucketsData = buckets->data();
-    const TIndexType* indicesData = indices.data();
-    const TDers* scratchDersData = weightedDers->data();
-    double* approxDeltasData = approxDeltas->data();
-    TVector<double> avrg;
-    avrg.yresize(1);
     const auto treeLearnerOptions = ctx->Params.ObliviousTreeOptions.Get();
     const ELeavesEstimation estimationMethod = treeLearnerOptions.LeavesEstimationMethod;
-    if (estimationMethod == ELeavesEstimation::Newton) {
-        double sumAllWeights = bt.BodySumWeight;
-        for (int z = bt.BodyFinish; z < bt.TailFinish; ++z) {
-            TSum& bucket = bucketsData[indicesData[z]];
-            double w = weights.empty() ? 1 : weights[z];
-            UpdateBucket<ELeavesEstimation::Newton>(scratchDersData[z - bt.BodyFinish], w, iteration, &bucket);
-            avrg[0] = CalcModel<ELeavesEstimation::Newton>(bucket, iteration, l2Regularizer, sumAllWeights, z);
-            sumAllWeights += w;
-            ExpApproxIf(TError::StoreExpApprox, &avrg);
-            approxDeltasData[z] = UpdateApprox<TError::StoreExpApprox>(approxDeltasData[z], avrg[0]);
+    double sumAllWeights = bt.BodySumWeight;
+    const auto calcTailModelBlock = [&] (const TDers* ders, int blockStart, int blockFinish) {
+        if (estimationMethod == ELeavesEstimation::Newton) {
+            CalcTailModelBlock<ELeavesEstimation::Newton, TError::StoreExpApprox>(
+                ders, indices.data(), weights, blockStart, blockFinish, iteration, l2Regularizer, &sumAllWeights, buckets->data(), approxDeltas->data()
+            );
+        } else {
+            Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
+            CalcTailModelBlock<ELeavesEstimation::Gradient, TError::StoreExpApprox>(
+                ders, indices.data(), weights, blockStart, blockFinish, iteration, l2Regularizer, &sumAllWeights, buckets->data(), approxDeltas->data()
+            );
         }
-    } else {
-        Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
-        double sumAllWeights = bt.BodySumWeight;
-        for (int z = bt.BodyFinish; z < bt.TailFinish; ++z) {
-            TSum& bucket = bucketsData[indicesData[z]];
-            double w = weights.empty() ? 1 : weights[z];
-            UpdateBucket<ELeavesEstimation::Gradient>(scratchDersData[z - bt.BodyFinish], w, iteration, &bucket);
-            avrg[0] = CalcModel<ELeavesEstimation::Gradient>(bucket, iteration, l2Regularizer, sumAllWeights, z);
-            sumAllWeights += w;
-            ExpApproxIf(TError::StoreExpApprox, &avrg);
-            approxDeltasData[z] = UpdateApprox<TError::StoreExpApprox>(approxDeltasData[z], avrg[0]);
+    };
+
+    if (error.GetErrorType() == EErrorType::PerObjectError) {
+        // derivatives of a tail object do not depend on the updates of the previous ones,
+        // so they are calculated in parallel by blocks bounding the scratch space
+        const int blockSize = GetTailDersBlockSize(ctx->LocalExecutor);
+        for (int blockStart = bt.BodyFinish; blockStart < bt.TailFinish; blockStart += blockSize) {
+            const int blockFinish = Min(blockStart + blockSize, bt.TailFinish);
+            CalcShiftedApproxDers(bt.Approx[0], *approxDeltas, ff.LearnTarget, weights, error, blockStart, blockFinish, weightedDers, ctx);
+            calcTailModelBlock(weightedDers->data(), blockStart, blockFinish);
         }
+    } else {
+        Y_ASSERT(error.GetErrorType() == EErrorType::QuerywiseError || error.GetErrorType() == EErrorType::PairwiseError);
+        CalculateDersForQueries(bt.Approx[0], *approxDeltas, ff.LearnTarget, weights, queriesInfo, error, bt.BodyQueryFinish, bt.TailQueryFinish, weightedDers);
+        calcTailModelBlock(weightedDers->data(), bt.BodyFinish, bt.TailFinish);
     }
 }
 
-template <typename TError>
+template <typename TError, typename TLeafIndex>
 void CalcApproxDeltaSimple(
     const TFold& ff,
     int leafCount,
     const TError& error,
-    const TVector<TIndexType>& indices,
+    const TVector<TLeafIndex>& indices,
     ui64 randomSeed,
     TLearnContext* ctx,
     TVector<TVector<TVector<double>>>* approxesDelta
@@ -418,9 +441,11 @@ void CalcApproxDeltaSimple(
         const double initValue = GetNeutralApprox<TError::StoreExpApprox>();
         Fill(resArr[0].begin(), resArr[0].end(), initValue);
 
+        const bool isPerObjectError = error.GetErrorType() == EErrorType::PerObjectError;
+        const int tailSize = bt.TailFinish - bt.BodyFinish;
         const int scratchSize = Max(
-            !ctx->Params.BoostingOptions->ApproxOnFullHistory ? 0 : bt.TailFinish - bt.BodyFinish,
-            error.GetErrorType() == EErrorType::PerObjectError ? APPROX_BLOCK_SIZE * CB_THREAD_LIMIT : bt.BodyFinish
+            !ctx->Params.BoostingOptions->ApproxOnFullHistory ? 0 : isPerObjectError ? Min(tailSize, GetTailDersBlockSize(localExecutor)) : tailSize,
+            isPerObjectError ? 0 : bt.BodyFinish
         );
 
         TVector<TDers> weightedDers;
@@ -454,7 +479,7 @@ void CalcLeafValuesSimple(
     TVector<TVector<double>>* leafValues
 ) {
     const int scratchSize = error.GetErrorType() == EErrorType::PerObjectError
-        ? APPROX_BLOCK_SIZE * CB_THREAD_LIMIT
+        ? 0
         : ff.GetLearnSampleCount();
     TVector<TDers> weightedDers(scratchSize);
 
@@ -515,9 +540,16 @@ void CalcApproxForLeafStruct(
     TLearnContext* ctx,
     TVector<TVector<TVector<double>>>* approxesDelta // [bodyTailId][approxDim][docIdxInPermuted]
 ) {
-    const TVector<TIndexType> indices = BuildIndices(fold, tree, learnData, testDataPtrs, &ctx->LocalExecutor);
     const int approxDimension = fold.GetApproxDimension();
     const int leafCount = tree.GetLeafCount();
+    if (approxDimension == 1 && IsCompactLeafIndexApplicable(tree.GetDepth())) {
+        // leaf indices are gathered on every leaf estimation iteration of every body tail,
+        // so they are stored with the narrowest type sufficient for the tree depth
+        const TVector<ui8> indices = BuildIndices<ui8>(fold, tree, learnData, testDataPtrs, &ctx->LocalExecutor);
+        CalcApproxDeltaSimple(fold, leafCount, error, indices, randomSeed, ctx, approxesDelta);
+        return;
+    }
+    const TVector<TIndexType> indices = BuildIndices(fold, tree, learnData, testDataPtrs, &ctx->LocalExecutor);
     if (approxDimension == 1) {
         CalcApproxDeltaSimple(fold, leafCount, error, indices, randomSeed, ctx, approxesDelta);
     } else {
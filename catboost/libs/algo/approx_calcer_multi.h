@@ -19,41 +19,77 @@ inline void UpdateApproxDeltasMulti(
     }
 }
 
-template <typename TError>
-void AddSampleToBucketNewtonMulti(
+/* Calls addDers(objectIdx, der, der2) for objects in [begin, end) with derivatives calculated by blocks
+ *  with one TError::CalcDersMultiRange call per block, der2 is nullptr if !calcDer2.
+ * Approx of an object is UpdateApprox(approx[dim][z], approxDelta[dim][z]) or approxDelta[dim][z] if approx is empty.
+ * addDers can modify approxDelta of the object it is called for.
+ */
+template <typename TError, typename TAddDers>
+void CalcDersMultiByBlocks(
     const TError& error,
-    const TVector<double>& approx,
-    float target,
-    double weight,
-    int iteration,
-    TVector<double>* curDer,
-    THessianInfo* curDer2,
-    TSumMulti* bucket
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TVector<TVector<double>>& approx,
+    const TVector<TVector<double>>& approxDelta,
+    int begin,
+    int end,
+    bool calcDer2,
+    TAddDers&& addDers
 ) {
-    Y_ASSERT(curDer != nullptr && curDer2 != nullptr);
-    error.CalcDersMulti(approx, target, weight, curDer, curDer2);
-    bucket->AddDerDer2(*curDer, *curDer2, iteration);
+    constexpr int BlockSize = 256;
+    const int approxDimension = approxDelta.ysize();
+    Y_ASSERT(approxDimension > 0);
+    const int der2Size = CalcInternalDer2DataSize(TError::GetHessianType(), approxDimension);
+    TVector<double> approxBlock;
+    approxBlock.yresize(BlockSize * approxDimension);
+    TVector<double> derBlock;
+    derBlock.yresize(BlockSize * approxDimension);
+    TVector<double> der2Block;
+    der2Block.yresize(calcDer2 ? BlockSize * der2Size : 0);
+    for (int blockBegin = begin; blockBegin < end; blockBegin += BlockSize) {
+        const int blockSize = Min(BlockSize, end - blockBegin);
+        for (int i = 0; i < blockSize; ++i) {
+            const int z = blockBegin + i;
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                approxBlock[i * approxDimension + dim] = approx.empty()
+                    ? approxDelta[dim][z]
+                    : UpdateApprox<TError::StoreExpApprox>(approx[dim][z], approxDelta[dim][z]);
+            }
+        }
+        error.CalcDersMultiRange(
+            blockSize,
+            approxDimension,
+            approxBlock.data(),
+            target.data() + blockBegin,
+            weight.empty() ? nullptr : weight.data() + blockBegin,
+            derBlock.data(),
+            calcDer2 ? der2Block.data() : nullptr
+        );
+        for (int i = 0; i < blockSize; ++i) {
+            addDers(blockBegin + i, &derBlock[i * approxDimension], calcDer2 ? &der2Block[i * der2Size] : nullptr);
+        }
+    }
 }
 
-template <typename TError>
-void AddSampleToBucketGradientMulti(
-    const TError& error,
-    const TVector<double>& approx,
-    float target,
+inline void AddDersToBucketMulti(
+    ELeavesEstimation estimationMethod,
+    const double* der,
+    const double* der2,
     double weight,
     int iteration,
-    TVector<double>* curDer,
-    THessianInfo* /*curDer2*/,
     TSumMulti* bucket
 ) {
-    Y_ASSERT(curDer != nullptr);
-    error.CalcDersMulti(approx, target, weight, curDer, nullptr);
-    bucket->AddDerWeight(*curDer, weight, iteration);
+    if (estimationMethod == ELeavesEstimation::Newton) {
+        bucket->AddDerDer2(der, der2, iteration);
+    } else {
+        Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
+        bucket->AddDerWeight(der, weight, iteration);
+    }
 }
 
-template <typename TError, typename TAddSampleToBucket>
+template <typename TError>
 void UpdateBucketsMulti(
-    TAddSampleToBucket AddSampleToBucket,
+    ELeavesEstimation estimationMethod,
     const TVector<TIndexType>& indices,
     const TVector<float>& target,
     const TVector<float>& weight,
@@ -64,19 +100,19 @@ void UpdateBucketsMulti(
     int iteration,
     TVector<TSumMulti>* buckets
 ) {
-    const int approxDimension = resArr.ysize();
-    Y_ASSERT(approxDimension > 0);
-    TVector<double> curApprox(approxDimension);
-    TVector<double> bufferDer(approxDimension);
-    THessianInfo bufferDer2(approxDimension, TError::GetHessianType());
-    for (int z = 0; z < sampleCount; ++z) {
-        for (int dim = 0; dim < approxDimension; ++dim) {
-            curApprox[dim] = approx.empty() ? resArr[dim][z] : UpdateApprox<TError::StoreExpApprox>(approx[dim][z], resArr[dim][z]);
+    CalcDersMultiByBlocks(
+        error,
+        target,
+        weight,
+        approx,
+        resArr,
+        /*begin*/ 0,
+        sampleCount,
+        /*calcDer2*/ estimationMethod == ELeavesEstimation::Newton,
+        [&] (int z, const double* der, const double* der2) {
+            AddDersToBucketMulti(estimationMethod, der, der2, weight.empty() ? 1 : weight[z], iteration, &(*buckets)[indices[z]]);
         }
-        TSumMulti& bucket = (*buckets)[indices[z]];
-        AddSampleToBucket(error, curApprox, target[z], weight.empty() ? 1 : weight[z], iteration,
-                          &bufferDer, &bufferDer2, &bucket);
-    }
+    );
 }
 
 template <typename TCalcModel>
@@ -99,10 +135,10 @@ void CalcMixedModelMulti(
     }
 }
 
-template <typename TError, typename TCalcModel, typename TAddSampleToBucket>
+template <typename TError, typename TCalcModel>
 void CalcApproxDeltaIterationMulti(
     TCalcModel CalcModel,
-    TAddSampleToBucket AddSampleToBucket,
+    ELeavesEstimation estimationMethod,
     const TVector<TIndexType>& indices,
     const TVector<float>& target,
     const TVector<float>& weight,
@@ -113,7 +149,7 @@ void CalcApproxDeltaIterationMulti(
     TVector<TSumMulti>* buckets,
     TVector<TVector<double>>* resArr
 ) {
-    UpdateBucketsMulti(AddSampleToBucket, indices, target, weight, bt.Approx, *resArr, error, bt.BodyFinish, iteration, buckets);
+    UpdateBucketsMulti(estimationMethod, indices, target, weight, bt.Approx, *resArr, error, bt.BodyFinish, iteration, buckets);
 
     // compute mixed model
     const int approxDimension = resArr->ysize();
@@ -122,26 +158,28 @@ void CalcApproxDeltaIterationMulti(
     CalcMixedModelMulti(CalcModel, *buckets, iteration, l2Regularizer, bt.BodySumWeight, bt.BodyFinish, &curLeafValues);
     UpdateApproxDeltasMulti<TError::StoreExpApprox>(indices, bt.BodyFinish, &curLeafValues, resArr);
 
-    // compute tail
-    TVector<double> curApprox(approxDimension);
+    // compute tail, derivatives of a tail object do not depend on the updates of the previous ones
     TVector<double> avrg(approxDimension);
-    TVector<double> bufferDer(approxDimension);
-    THessianInfo bufferDer2(approxDimension, TError::GetHessianType());
-    for (int z = bt.BodyFinish; z < bt.TailFinish; ++z) {
-        for (int dim = 0; dim < approxDimension; ++dim) {
-            curApprox[dim] = UpdateApprox<TError::StoreExpApprox>(bt.Approx[dim][z], (*resArr)[dim][z]);
-        }
-
-        TSumMulti& bucket = (*buckets)[indices[z]];
-        AddSampleToBucket(error, curApprox, target[z], weight.empty() ? 1 : weight[z], iteration,
-                          &bufferDer, &bufferDer2, &bucket);
+    CalcDersMultiByBlocks(
+        error,
+        target,
+        weight,
+        bt.Approx,
+        *resArr,
+        bt.BodyFinish,
+        bt.TailFinish,
+        /*calcDer2*/ estimationMethod == ELeavesEstimation::Newton,
+        [&] (int z, const double* der, const double* der2) {
+            TSumMulti& bucket = (*buckets)[indices[z]];
+            AddDersToBucketMulti(estimationMethod, der, der2, weight.empty() ? 1 : weight[z], iteration, &bucket);
 
-        CalcModel(bucket, iteration, l2Regularizer, bt.BodySumWeight, bt.BodyFinish, &avrg);
-        ExpApproxIf(TError::StoreExpApprox, &avrg);
-        for (int dim = 0; dim < approxDimension; ++dim) {
-            (*resArr)[dim][z] = UpdateApprox<TError::StoreExpApprox>((*resArr)[dim][z], avrg[dim]);
+            CalcModel(bucket, iteration, l2Regularizer, bt.BodySumWeight, bt.BodyFinish, &avrg);
+            ExpApproxIf(TError::StoreExpApprox, &avrg);
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                (*resArr)[dim][z] = UpdateApprox<TError::StoreExpApprox>((*resArr)[dim][z], avrg[dim]);
+            }
         }
-    }
+    );
 }
 
 
@@ -176,12 +214,12 @@ void CalcApproxDeltaMulti(
         TVector<TSumMulti> buckets(leafCount, TSumMulti(gradientIterations, approxDimension, TError::GetHessianType()));
         for (int it = 0; it < gradientIterations; ++it) {
             if (estimationMethod == ELeavesEstimation::Newton) {
-                CalcApproxDeltaIterationMulti(CalcModelNewtonMulti, AddSampleToBucketNewtonMulti<TError>,
+                CalcApproxDeltaIterationMulti(CalcModelNewtonMulti, estimationMethod,
                                               indices, ff.LearnTarget, ff.GetLearnWeights(), bt, error, it, l2Regularizer,
                                               &buckets, &resArr);
             } else {
                 Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
-                CalcApproxDeltaIterationMulti(CalcModelGradientMulti, AddSampleToBucketGradientMulti<TError>,
+                CalcApproxDeltaIterationMulti(CalcModelGradientMulti, estimationMethod,
                                               indices, ff.LearnTarget, ff.GetLearnWeights(), bt, error, it, l2Regularizer,
                                               &buckets, &resArr);
             }
@@ -189,10 +227,10 @@ void CalcApproxDeltaMulti(
     }, 0, ff.BodyTailArr.ysize(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
-template <typename TCalcModel, typename TAddSampleToBucket, typename TError>
+template <typename TCalcModel, typename TError>
 void CalcLeafValuesIterationMulti(
     TCalcModel CalcModel,
-    TAddSampleToBucket AddSampleToBucket,
+    ELeavesEstimation estimationMethod,
     const TVector<TIndexType>& indices,
     const TVector<float>& target,
     const TVector<float>& weight,
@@ -207,7 +245,7 @@ void CalcLeafValuesIterationMulti(
     int approxDimension = approx->ysize();
     int learnSampleCount = (*approx)[0].ysize();
 
-    UpdateBucketsMulti(AddSampleToBucket, indices, target, weight, /*approx*/ TVector<TVector<double>>(), *approx, error, learnSampleCount, iteration, buckets);
+    UpdateBucketsMulti(estimationMethod, indices, target, weight, /*approx*/ TVector<TVector<double>>(), *approx, error, learnSampleCount, iteration, buckets);
 
     TVector<TVector<double>> curLeafValues(approxDimension, TVector<double>(leafCount));
     CalcMixedModelMulti(CalcModel, *buckets, iteration, l2Regularizer, sumWeight, learnSampleCount, &curLeafValues);
@@ -239,12 +277,12 @@ void CalcLeafValuesMulti(
     const float l2Regularizer = treeLearnerOptions.L2Reg;
     for (int it = 0; it < gradientIterations; ++it) {
         if (estimationMethod == ELeavesEstimation::Newton) {
-            CalcLeafValuesIterationMulti(CalcModelNewtonMulti, AddSampleToBucketNewtonMulti<TError>,
+            CalcLeafValuesIterationMulti(CalcModelNewtonMulti, estimationMethod,
                                          indices, ff.LearnTarget, ff.GetLearnWeights(), error, it, l2Regularizer,
                                          ff.GetSumWeight(), &buckets, &approx);
         } else {
             Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
-            CalcLeafValuesIterationMulti(CalcModelGradientMulti, AddSampleToBucketGradientMulti<TError>,
+            CalcLeafValuesIterationMulti(CalcModelGradientMulti, estimationMethod,
                                          indices, ff.LearnTarget, ff.GetLearnWeights(), error, it, l2Regularizer,
                                          ff.GetSumWeight(), &buckets, &approx);
         }
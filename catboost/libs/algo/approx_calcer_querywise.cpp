@@ -20,9 +20,10 @@ static void UpdateBucketsForLeaves(
     }
 }
 
+template <typename TLeafIndex>
 void UpdateBucketsForQueries(
     TVector<TDers> weightedDers,
-    const TVector<TIndexType>& indices,
+    const TVector<TLeafIndex>& indices,
     const TVector<float>& weights,
     const TVector<TQueryInfo>& queriesInfo,
     int queryStartIndex,
@@ -64,3 +65,5 @@ void UpdateBucketsForQueries(
     }
 }
 
+template void UpdateBucketsForQueries<ui8>(TVector<TDers>, const TVector<ui8>&, const TVector<float>&, const TVector<TQueryInfo>&, int, int, ELeavesEstimation, int, TVector<TSum>*);
+template void UpdateBucketsForQueries<TIndexType>(TVector<TDers>, const TVector<TIndexType>&, const TVector<float>&, const TVector<TQueryInfo>&, int, int, ELeavesEstimation, int, TVector<TSum>*);
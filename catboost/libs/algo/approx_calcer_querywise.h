@@ -27,9 +27,11 @@ void CalculateDersForQueries(
     error.CalcDersForQueries(queryStartIndex, queryEndIndex, fullApproxes, targets, weights, queriesInfo, weightedDers);
 }
 
+// instantiated for ui8 and TIndexType leaf indices
+template <typename TLeafIndex>
 void UpdateBucketsForQueries(
     TVector<TDers> weightedDers,
-    const TVector<TIndexType>& indices,
+    const TVector<TLeafIndex>& indices,
     const TVector<float>& weights,
     const TVector<TQueryInfo>& queriesInfo,
     int queryStartIndex,
@@ -24,6 +24,16 @@ static inline double ApplyLearningRate(double approxDelta, double learningRate)
     return StoreExpApprox ? fast_exp(FastLogf(approxDelta) * learningRate) : approxDelta * learningRate;
 }
 
+/* approxes[i] = UpdateApprox(approxes[i], ApplyLearningRate(approxDeltas[i], learningRate)) for i in [0, count),
+ * exponents are calculated by scalar fast_exp, as in ApplyLearningRate, so results don't depend on the instruction set
+ */
+template<bool StoreExpApprox>
+static inline void UpdateApproxRange(const double* approxDeltas, double learningRate, int count, double* approxes) {
+    for (int i = 0; i < count; ++i) {
+        approxes[i] = UpdateApprox<StoreExpApprox>(approxes[i], ApplyLearningRate<StoreExpApprox>(approxDeltas[i], learningRate));
+    }
+}
+
 static inline double GetNeutralApprox(bool storeExpApproxes) {
     if (storeExpApproxes) {
         return GetNeutralApprox</*StoreExpApprox*/ true>();
@@ -0,0 +1,106 @@
+#include <catboost/libs/algo/approx_calcer.h>
+#include <catboost/libs/algo/yetirank_helpers.h>
+
+#include <library/testing/benchmark/bench.h>
+
+#include <util/generic/singleton.h>
+#include <util/random/fast.h>
+
+// every benchmark iteration processes one document, so iterations/sec is docs/sec
+namespace {
+    template <int QuerySize>
+    struct TYetiRankData {
+        static constexpr int QueryCount = 20;
+        static constexpr int DocCount = QueryCount * QuerySize;
+
+        TVector<double> ExpApproxes;
+        TVector<float> Relevances;
+        TVector<TQueryInfo> QueriesInfo;
+
+        TYetiRankData() {
+            TReallyFastRng32 rng(0);
+            for (int docId = 0; docId < DocCount; ++docId) {
+                ExpApproxes.push_back(0.5 + rng.GenRandReal1());
+                Relevances.push_back(rng.Uniform(5));
+            }
+            for (int queryIdx = 0; queryIdx < QueryCount; ++queryIdx) {
+                QueriesInfo.emplace_back(queryIdx * QuerySize, (queryIdx + 1) * QuerySize);
+            }
+        }
+    };
+}
+
+template <int QuerySize>
+static void GenerateYetiRankPairs(size_t docCount) {
+    using TData = TYetiRankData<QuerySize>;
+    const auto& data = *Singleton<TData>();
+    TVector<TQueryInfo> queriesInfo = data.QueriesInfo;
+    NPar::TLocalExecutor localExecutor;
+    for (size_t processedDocCount = 0; processedDocCount < docCount; processedDocCount += TData::DocCount) {
+        UpdatePairsForYetiRank(
+            data.ExpApproxes,
+            data.Relevances,
+            TData::QueryCount,
+            /*permutationCount*/ 10,
+            /*decaySpeed*/ 0.99,
+            /*randomSeed*/ processedDocCount,
+            &queriesInfo,
+            &localExecutor
+        );
+        Y_DO_NOT_OPTIMIZE_AWAY(queriesInfo);
+    }
+}
+
+Y_CPU_BENCHMARK(YetiRankQuerySize30, iface) {
+    GenerateYetiRankPairs<30>(iface.Iterations());
+}
+
+Y_CPU_BENCHMARK(YetiRankQuerySize300, iface) {
+    GenerateYetiRankPairs<300>(iface.Iterations());
+}
+
+Y_CPU_BENCHMARK(YetiRankQuerySize3000, iface) {
+    GenerateYetiRankPairs<3000>(iface.Iterations());
+}
+
+namespace {
+    template <typename TLeafIndex>
+    struct TLeafIndicesData {
+        static constexpr int DocCount = 1 << 20;
+        static constexpr int LeafCount = 64;
+
+        TVector<TLeafIndex> Indices;
+        TVector<double> LeafValues;
+
+        TLeafIndicesData() {
+            TReallyFastRng32 rng(0);
+            for (int docId = 0; docId < DocCount; ++docId) {
+                Indices.push_back(rng.Uniform(LeafCount));
+            }
+            for (int leaf = 0; leaf < LeafCount; ++leaf) {
+                LeafValues.push_back(rng.GenRandReal1() - 0.5);
+            }
+        }
+    };
+}
+
+template <typename TLeafIndex>
+static void UpdateApproxDeltasByLeafIndices(size_t docCount) {
+    using TData = TLeafIndicesData<TLeafIndex>;
+    const auto& data = *Singleton<TData>();
+    TVector<double> leafValues = data.LeafValues;
+    TVector<double> approxDeltas(TData::DocCount);
+    NPar::TLocalExecutor localExecutor;
+    for (size_t processedDocCount = 0; processedDocCount < docCount; processedDocCount += TData::DocCount) {
+        UpdateApproxDeltas</*StoreExpApprox*/ false>(data.Indices, TData::DocCount, &localExecutor, &leafValues, &approxDeltas);
+        Y_DO_NOT_OPTIMIZE_AWAY(approxDeltas);
+    }
+}
+
+Y_CPU_BENCHMARK(UpdateApproxDeltasIndexType, iface) {
+    UpdateApproxDeltasByLeafIndices<TIndexType>(iface.Iterations());
+}
+
+Y_CPU_BENCHMARK(UpdateApproxDeltasCompactIndex, iface) {
+    UpdateApproxDeltasByLeafIndices<ui8>(iface.Iterations());
+}
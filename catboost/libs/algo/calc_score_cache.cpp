@@ -199,6 +199,8 @@ static int GetMaxTailFinish(const TVector<TFold>& folds, int bodyTailIdx) {
 void TCalcScoreFold::Create(const TVector<TFold>& folds, bool isPairwiseScoring, int defaultCalcStatsObjBlockSize, float sampleRate) {
     BernoulliSampleRate = sampleRate;
     Y_ASSERT(BernoulliSampleRate > 0.0f && BernoulliSampleRate <= 1.0f);
+    HasSampledControl = false;
+    IsIndexInFoldIdentity = false;
     DocCount = folds[0].LearnPermutation.ysize();
     Y_ASSERT(DocCount > 0);
     Indices.yresize(DocCount);
@@ -317,11 +319,20 @@ void TCalcScoreFold::SelectSmallestSplitSide(int curDepth, const TCalcScoreFold&
         SetElements(srcControlRef, srcBlock.GetConstRef(fold.IndexInFold), GetElement<size_t>, dstBlock.GetRef(IndexInFold), &ignored);
         SelectBlockFromFold(fold, srcBlock, dstBlock);
     }, 0, blockCount, NPar::TLocalExecutor::WAIT_COMPLETE);
+    PermutedLearnFeatures = fold.PermutedLearnFeatures;
+    IsIndexInFoldIdentity = false;
     SetPermutationBlockSizeAndCalcStatsRanges(FoldPermutationBlockSizeNotSet);
 }
 
-void TCalcScoreFold::Sample(const TFold& fold, const TVector<TIndexType>& indices, TRestorableFastRng64* rand, NPar::TLocalExecutor* localExecutor) {
-    SetSampledControl(indices.ysize(), rand);
+void TCalcScoreFold::Sample(
+    const TFold& fold,
+    const TVector<TIndexType>& indices,
+    bool isPlainMode,
+    bool hasZeroSampleWeights,
+    TRestorableFastRng64* rand,
+    NPar::TLocalExecutor* localExecutor
+) {
+    SetSampledControl(fold, indices.ysize(), isPlainMode, hasZeroSampleWeights, rand, localExecutor);
 
     TVectorSlicing srcBlocks;
     TVectorSlicing dstBlocks;
@@ -349,7 +360,10 @@ void TCalcScoreFold::Sample(const TFold& fold, const TVector<TIndexType>& indice
         SetElements(srcControlRef, srcBlock.GetConstRef(TVector<size_t>()), [=](const size_t*, size_t j) { return srcBlock.Offset + j; }, dstBlock.GetRef(IndexInFold), &ignored);
         SelectBlockFromFold(fold, srcBlock, dstBlock);
     }, 0, blockCount, NPar::TLocalExecutor::WAIT_COMPLETE);
-    SetPermutationBlockSizeAndCalcStatsRanges((BernoulliSampleRate == 1.0f || IsPairwiseScoring) ? fold.PermutationBlockSize : FoldPermutationBlockSizeNotSet);
+    PermutedLearnFeatures = fold.HasPermutedLearnFeatures ? &fold.PermutedLearnFeatures : nullptr;
+    // stats ranges are aligned by blocks of the fold permutation, not by blocks of the identity IndexInFold
+    IsIndexInFoldIdentity = !HasSampledControl;
+    SetPermutationBlockSizeAndCalcStatsRanges(HasSampledControl ? FoldPermutationBlockSizeNotSet : fold.PermutationBlockSize);
 }
 
 void TCalcScoreFold::UpdateIndices(const TVector<TIndexType>& indices, NPar::TLocalExecutor* localExecutor) {
@@ -360,7 +374,7 @@ void TCalcScoreFold::UpdateIndices(const TVector<TIndexType>& indices, NPar::TLo
     srcBlocks.Create(blockParams);
 
     TVectorSlicing dstBlocks;
-    if (BernoulliSampleRate < 1.0f && !IsPairwiseScoring) {
+    if (HasSampledControl) {
         dstBlocks.CreateByControl(blockParams, Control, localExecutor);
     } else {
         dstBlocks = srcBlocks;
@@ -432,13 +446,56 @@ void TCalcScoreFold::SetSmallestSideControl(int curDepth, int docCount, const TU
     }
 }
 
-void TCalcScoreFold::SetSampledControl(int docCount, TRestorableFastRng64* rand) {
-    if (BernoulliSampleRate == 1.0f || IsPairwiseScoring) {
+void TCalcScoreFold::SetSampledControl(
+    const TFold& fold,
+    int docCount,
+    bool isPlainMode,
+    bool hasZeroSampleWeights,
+    TRestorableFastRng64* rand,
+    NPar::TLocalExecutor* localExecutor
+) {
+    if (IsPairwiseScoring) {
         Fill(Control.begin(), Control.end(), true);
+        HasSampledControl = false;
         return;
     }
-    for (int docIdx = 0; docIdx < docCount; ++docIdx) {
-        Control[docIdx] = rand->GenRandReal1() < BernoulliSampleRate;
+    HasSampledControl = BernoulliSampleRate < 1.0f;
+    if (HasSampledControl) {
+        for (int docIdx = 0; docIdx < docCount; ++docIdx) {
+            Control[docIdx] = rand->GenRandReal1() < BernoulliSampleRate;
+        }
+    } else {
+        Fill(Control.begin(), Control.end(), true);
+    }
+    if (HasPairwiseWeights) { // statistics are weighted by per body tail pairwise weights
+        return;
+    }
+    if (!hasZeroSampleWeights) {
+        return;
+    }
+
+    // an object with zero sample weight adds zeros to the statistics of its bucket unless
+    // it is in the body of an ordered boosting fold, where learn weights are used instead
+    const float* sampleWeightsData = GetDataPtr(fold.SampleWeights);
+    const float* learnWeightsData = GetDataPtr(fold.GetLearnWeights());
+    if (!isPlainMode && learnWeightsData == nullptr) {
+        return;
+    }
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, docCount);
+    blockParams.SetBlockSize(4000);
+    TVector<int> droppedDocCount(blockParams.GetBlockCount(), 0);
+    bool* controlData = GetDataPtr(Control);
+    localExecutor->ExecRange([=, &droppedDocCount](int blockIdx) {
+        int dropped = 0; // use a local var instead of droppedDocCount[blockIdx] so that the compiler can use a register
+        NPar::TLocalExecutor::BlockedLoopBody(blockParams, [=, &dropped](int docIdx) {
+            const bool isZeroWeight = sampleWeightsData[docIdx] == 0.0f && (isPlainMode || learnWeightsData[docIdx] == 0.0f);
+            dropped += isZeroWeight && controlData[docIdx];
+            controlData[docIdx] = controlData[docIdx] && !isZeroWeight;
+        })(blockIdx);
+        droppedDocCount[blockIdx] = dropped;
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+    for (int dropped : droppedDocCount) {
+        HasSampledControl |= dropped > 0;
     }
 }
 
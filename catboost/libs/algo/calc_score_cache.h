@@ -158,16 +158,40 @@ struct TCalcScoreFold {
     TUnsizedVector<TBodyTail> BodyTailArr; // [tail][dim][doc]
     bool SmallestSplitSideValue;
     int PermutationBlockSize = FoldPermutationBlockSizeNotSet;
+    // learn features of the source fold in its order (see TFold::PermutedLearnFeatures), nullptr if there are none
+    const TAllFeatures* PermutedLearnFeatures = nullptr;
 
     void Create(const TVector<TFold>& folds, bool isPairwiseScoring, int defaultCalcStatsObjBlockSize, float sampleRate = 1.0f);
     void SelectSmallestSplitSide(int curDepth, const TCalcScoreFold& fold, NPar::TLocalExecutor* localExecutor);
-    void Sample(const TFold& fold, const TVector<TIndexType>& indices, TRestorableFastRng64* rand, NPar::TLocalExecutor* localExecutor);
+    /* gathers sampled objects into contiguous buffers, objects that add nothing to the statistics are dropped for any bootstrap type,
+     * objects with zero sample weights are searched for only if hasZeroSampleWeights (user weights or bootstrap can produce them)
+     */
+    void Sample(
+        const TFold& fold,
+        const TVector<TIndexType>& indices,
+        bool isPlainMode,
+        bool hasZeroSampleWeights,
+        TRestorableFastRng64* rand,
+        NPar::TLocalExecutor* localExecutor
+    );
     void UpdateIndices(const TVector<TIndexType>& indices, NPar::TLocalExecutor* localExecutor);
     int GetDocCount() const;
     int GetBodyTailCount() const;
     int GetApproxDimension() const;
     const TVector<float>& GetLearnWeights() const { return LearnWeights; }
 
+    // features for float and one-hot splits and the doc indices in them
+    const TAllFeatures& GetLearnFeatures(const TAllFeatures& learnFeatures) const {
+        return PermutedLearnFeatures ? *PermutedLearnFeatures : learnFeatures;
+    }
+    const size_t* GetLearnFeaturesDocSubset() const {
+        return PermutedLearnFeatures ? GetIndexInFoldDocSubset() : GetDataPtr(LearnPermutation);
+    }
+    // doc indices in data of the source fold order (e.g. online ctrs), nullptr if they are the same as in this fold
+    const size_t* GetIndexInFoldDocSubset() const {
+        return IsIndexInFoldIdentity ? nullptr : GetDataPtr(IndexInFold);
+    }
+
     bool HasQueryInfo() const;
 
     // for data with queries - query indices, object indices otherwise
@@ -183,7 +207,14 @@ private:
     template<typename TFoldType>
     void SelectBlockFromFold(const TFoldType& fold, TSlice srcBlock, TSlice dstBlock);
     void SetSmallestSideControl(int curDepth, int docCount, const TUnsizedVector<TIndexType>& indices, NPar::TLocalExecutor* localExecutor);
-    void SetSampledControl(int docCount, TRestorableFastRng64* rand);
+    void SetSampledControl(
+        const TFold& fold,
+        int docCount,
+        bool isPlainMode,
+        bool hasZeroSampleWeights,
+        TRestorableFastRng64* rand,
+        NPar::TLocalExecutor* localExecutor
+    );
 
     void CreateBlocksAndUpdateQueriesInfoByControl(
         NPar::TLocalExecutor* localExecutor,
@@ -203,6 +234,8 @@ private:
     int BodyTailCount;
     int ApproxDimension;
     float BernoulliSampleRate;
+    bool HasSampledControl = false; // some objects are dropped by the last Sample
+    bool IsIndexInFoldIdentity = false; // IndexInFold[i] == i, no objects are dropped by the last Sample
     bool HasPairwiseWeights;
     bool IsPairwiseScoring;
     int DefaultCalcStatsObjBlockSize;
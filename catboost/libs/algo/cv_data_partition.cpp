@@ -32,6 +32,8 @@ void BuildCvPools(
     Shuffle(learnPool->Docs.QueryId, rand, &permutation);
     NPar::TLocalExecutor localExecutor;
     localExecutor.RunAdditionalThreads(threadCount - 1);
+    // generated ids are position-based, keep original ones after shuffle
+    learnPool->Docs.MakeDocIdsExplicit();
     ApplyPermutation(InvertPermutation(permutation), learnPool, &localExecutor);
     testPool->CatFeatures = learnPool->CatFeatures;
 
@@ -67,8 +69,9 @@ void BuildCvPools(
     int learnCount = docCount - testCount;
 
     bool hasSubgroupId = !allDocs.SubgroupId.empty();
-    learnPool->Docs.Resize(learnCount, allDocs.GetEffectiveFactorCount(), allDocs.GetBaselineDimension(), hasQueryId, hasSubgroupId);
-    testPool->Docs.Resize(testCount, allDocs.GetEffectiveFactorCount(), allDocs.GetBaselineDimension(), hasQueryId, hasSubgroupId);
+    bool hasTimestamp = !allDocs.Timestamp.empty();
+    learnPool->Docs.Resize(learnCount, allDocs.GetEffectiveFactorCount(), allDocs.GetBaselineDimension(), hasQueryId, hasSubgroupId, hasTimestamp);
+    testPool->Docs.Resize(testCount, allDocs.GetEffectiveFactorCount(), allDocs.GetBaselineDimension(), hasQueryId, hasSubgroupId, hasTimestamp);
 
     size_t learnIdx = 0;
     size_t testIdx = 0;
@@ -92,6 +92,125 @@ void TCrossEntropyError::CalcDersRange(
     }
 }
 
+template<bool CalcThirdDer>
+static void CalcCrossEntropyErrorDersArraysImpl(
+    int start,
+    int count,
+    const double* __restrict approxExps,
+    const double* __restrict approxDeltas,
+    const float* __restrict targets,
+    const float* __restrict weights,
+    double* __restrict der1,
+    double* __restrict der2,
+    double* __restrict der3
+) {
+    if (approxDeltas != nullptr) {
+#pragma clang loop vectorize_width(4) interleave_count(2)
+        for (int i = start; i < start + count; ++i) {
+            const double p = approxExps[i] * approxDeltas[i] / (1 + approxExps[i] * approxDeltas[i]);
+            der1[i] = targets[i] - p;
+            der2[i] = -p * (1 - p);
+            if (CalcThirdDer) {
+                der3[i] = -p * (1 - p) * (1 - 2 * p);
+            }
+        }
+    } else {
+#pragma clang loop vectorize_width(4) interleave_count(2)
+        for (int i = start; i < start + count; ++i) {
+            const double p = approxExps[i] / (1 + approxExps[i]);
+            der1[i] = targets[i] - p;
+            der2[i] = -p * (1 - p);
+            if (CalcThirdDer) {
+                der3[i] = -p * (1 - p) * (1 - 2 * p);
+            }
+        }
+    }
+    if (weights != nullptr) {
+#pragma clang loop vectorize_width(4) interleave_count(2)
+        for (int i = start; i < start + count; ++i) {
+            der1[i] *= weights[i];
+            der2[i] *= weights[i];
+            if (CalcThirdDer) {
+                der3[i] *= weights[i];
+            }
+        }
+    }
+}
+
+void TCrossEntropyError::CalcDersRange(
+    int start,
+    int count,
+    bool calcThirdDer,
+    const double* approxExps,
+    const double* approxDeltas,
+    const float* targets,
+    const float* weights,
+    const TDersArrays& ders
+) const {
+    if (calcThirdDer) {
+        CalcCrossEntropyErrorDersArraysImpl<true>(start, count, approxExps, approxDeltas, targets, weights, ders.Der1, ders.Der2, ders.Der3);
+    } else {
+        CalcCrossEntropyErrorDersArraysImpl<false>(start, count, approxExps, approxDeltas, targets, weights, ders.Der1, ders.Der2, nullptr);
+    }
+}
+
+void TMultiClassError::CalcFirstDerMultiRange(
+    int start,
+    int count,
+    const TVector<TVector<double>>& approx,
+    const float* targets,
+    const float* weights,
+    TVector<TVector<double>>* ders
+) const {
+    const int approxDimension = approx.ysize();
+
+    TVector<double> maxApprox(approx[0].begin() + start, approx[0].begin() + start + count);
+    for (int dim = 1; dim < approxDimension; ++dim) {
+        const double* approxData = approx[dim].data() + start;
+        for (int i = 0; i < count; ++i) {
+            maxApprox[i] = Max(maxApprox[i], approxData[i]);
+        }
+    }
+
+    TVector<double> expApprox; // [i * approxDimension + dim]
+    expApprox.yresize(approxDimension * count);
+    for (int dim = 0; dim < approxDimension; ++dim) {
+        const double* approxData = approx[dim].data() + start;
+        for (int i = 0; i < count; ++i) {
+            expApprox[i * approxDimension + dim] = approxData[i] - maxApprox[i];
+        }
+    }
+    // exponents are calculated per object, as in CalcSoftmax, so results don't depend on the size of the range
+    for (int i = 0; i < count; ++i) {
+        FastExpInplace(expApprox.data() + i * approxDimension, approxDimension);
+    }
+
+    TVector<double> sumExpApprox(count, 0.0);
+    for (int i = 0; i < count; ++i) {
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            sumExpApprox[i] += expApprox[i * approxDimension + dim];
+        }
+    }
+
+    for (int dim = 0; dim < approxDimension; ++dim) {
+        double* derData = (*ders)[dim].data() + start;
+        for (int i = 0; i < count; ++i) {
+            derData[i] = -(expApprox[i * approxDimension + dim] / sumExpApprox[i]);
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        (*ders)[static_cast<int>(targets[start + i])][start + i] += 1;
+    }
+    if (weights != nullptr) {
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            double* derData = (*ders)[dim].data() + start;
+            for (int i = 0; i < count; ++i) {
+                derData[i] *= weights[start + i];
+            }
+        }
+    }
+}
+
 void CheckDerivativeOrderForTrain(ui32 derivativeOrder, ELeavesEstimation estimationMethod) {
     if (estimationMethod == ELeavesEstimation::Newton) {
         CB_ENSURE(derivativeOrder >= 2, "Current error function doesn't support Newton leaves estimation method");
@@ -100,6 +100,43 @@ public:
         }
     }
 
+    // same as above, but derivatives are stored as structure of arrays, ders.Der3 is used only if calcThirdDer
+    void CalcDersRange(
+        int start,
+        int count,
+        bool calcThirdDer,
+        const double* approxes,
+        const double* approxDeltas,
+        const float* targets,
+        const float* weights,
+        const TDersArrays& ders
+    ) const {
+        if (approxDeltas != nullptr) {
+            if (calcThirdDer) {
+                CalcDersArraysImpl</*HasDeltas*/ true, /*CalcThirdDer*/ true>(start, count, approxes, approxDeltas, targets, ders.Der1, ders.Der2, ders.Der3);
+            } else {
+                CalcDersArraysImpl</*HasDeltas*/ true, /*CalcThirdDer*/ false>(start, count, approxes, approxDeltas, targets, ders.Der1, ders.Der2, nullptr);
+            }
+        } else {
+            if (calcThirdDer) {
+                CalcDersArraysImpl</*HasDeltas*/ false, /*CalcThirdDer*/ true>(start, count, approxes, nullptr, targets, ders.Der1, ders.Der2, ders.Der3);
+            } else {
+                CalcDersArraysImpl</*HasDeltas*/ false, /*CalcThirdDer*/ false>(start, count, approxes, nullptr, targets, ders.Der1, ders.Der2, nullptr);
+            }
+        }
+        if (weights != nullptr) {
+            for (int i = start; i < start + count; ++i) {
+                ders.Der1[i] *= weights[i];
+                ders.Der2[i] *= weights[i];
+            }
+            if (calcThirdDer) {
+                for (int i = start; i < start + count; ++i) {
+                    ders.Der3[i] *= weights[i];
+                }
+            }
+        }
+    }
+
     void CalcDersMulti(
         const TVector<double>& /*approx*/,
         float /*target*/,
@@ -110,6 +147,62 @@ public:
         CB_ENSURE(false, "Not implemented");
     }
 
+    /* derivatives of count objects, approxes and ders are indexed by [objectIdx][dim],
+     * der2 is indexed by [objectIdx][THessianInfo::Data index] and is not calculated if nullptr,
+     * weights is nullptr for unweighted objects
+     */
+    void CalcDersMultiRange(
+        int count,
+        int approxDimension,
+        const double* approxes,
+        const float* targets,
+        const float* weights,
+        double* ders,
+        double* der2
+    ) const {
+        TVector<double> curApprox(approxDimension);
+        TVector<double> curDer(approxDimension);
+        THessianInfo curDer2(approxDimension, TChild::GetHessianType());
+        const int der2Size = curDer2.Data.ysize();
+        for (int i = 0; i < count; ++i) {
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                curApprox[dim] = approxes[i * approxDimension + dim];
+            }
+            static_cast<const TChild*>(this)->CalcDersMulti(curApprox, targets[i], weights == nullptr ? 1 : weights[i], &curDer, der2 == nullptr ? nullptr : &curDer2);
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                ders[i * approxDimension + dim] = curDer[dim];
+            }
+            if (der2 != nullptr) {
+                for (int idx = 0; idx < der2Size; ++idx) {
+                    der2[i * der2Size + idx] = curDer2.Data[idx];
+                }
+            }
+        }
+    }
+
+    // weighted first derivatives of objects in [start, start + count), approx and ders are indexed by [dim][objectIdx]
+    void CalcFirstDerMultiRange(
+        int start,
+        int count,
+        const TVector<TVector<double>>& approx,
+        const float* targets,
+        const float* weights,
+        TVector<TVector<double>>* ders
+    ) const {
+        const int approxDimension = approx.ysize();
+        TVector<double> curApprox(approxDimension);
+        TVector<double> curDer(approxDimension);
+        for (int i = start; i < start + count; ++i) {
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                curApprox[dim] = approx[dim][i];
+            }
+            static_cast<const TChild*>(this)->CalcDersMulti(curApprox, targets[i], weights == nullptr ? 1 : weights[i], &curDer, nullptr);
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                (*ders)[dim][i] = curDer[dim];
+            }
+        }
+    }
+
     void CalcDersForQueries(
         int /*queryStartIndex*/,
         int /*queryEndIndex*/,
@@ -155,6 +248,28 @@ private:
             ders->Der3 = CalcDer3(approx, target);
         }
     }
+
+    // derivatives of simple losses are inlined and branchless, so this loop is vectorized
+    template<bool HasDeltas, bool CalcThirdDer>
+    void CalcDersArraysImpl(
+        int start,
+        int count,
+        const double* __restrict approxes,
+        const double* __restrict approxDeltas,
+        const float* __restrict targets,
+        double* __restrict der1,
+        double* __restrict der2,
+        double* __restrict der3
+    ) const {
+        for (int i = start; i < start + count; ++i) {
+            const double approx = HasDeltas ? UpdateApprox<StoreExpApprox>(approxes[i], approxDeltas[i]) : approxes[i];
+            der1[i] = CalcDer(approx, targets[i]);
+            der2[i] = CalcDer2(approx, targets[i]);
+            if (CalcThirdDer) {
+                der3[i] = CalcDer3(approx, targets[i]);
+            }
+        }
+    }
 };
 
 class TCrossEntropyError : public IDerCalcer<TCrossEntropyError, /*StoreExpApproxParam*/ true> {
@@ -208,6 +323,17 @@ public:
         const float* weights,
         TDers* ders
     ) const;
+
+    void CalcDersRange(
+        int start,
+        int count,
+        bool calcThirdDer,
+        const double* approxes,
+        const double* approxDeltas,
+        const float* targets,
+        const float* weights,
+        const TDersArrays& ders
+    ) const;
 };
 
 class TRMSEError : public IDerCalcer<TRMSEError, /*StoreExpApproxParam*/ false> {
@@ -369,6 +495,16 @@ public:
         return 2;
     }
 
+    // softmax of all objects of the range is calculated without per-object allocations, results equal CalcDersMulti
+    void CalcFirstDerMultiRange(
+        int start,
+        int count,
+        const TVector<TVector<double>>& approx,
+        const float* targets,
+        const float* weights,
+        TVector<TVector<double>>* ders
+    ) const;
+
     void CalcDersMulti(
         const TVector<double>& approx,
         float target,
@@ -415,7 +551,7 @@ public:
     }
 };
 
-class TMultiClassOneVsAllError : public IDerCalcer<TMultiClassError, /*StoreExpApproxParam*/ false> {
+class TMultiClassOneVsAllError : public IDerCalcer<TMultiClassOneVsAllError, /*StoreExpApproxParam*/ false> {
 public:
     explicit TMultiClassOneVsAllError(bool storeExpApprox) {
         CB_ENSURE(storeExpApprox == StoreExpApprox, "Approx format does not match");
@@ -749,6 +885,63 @@ public:
         Descriptor.CalcDersMulti(approx, target, weight, der, der2, Descriptor.CustomData);
     }
 
+    // one callback call for all objects if the descriptor provides batched derivatives
+    void CalcDersMultiRange(
+        int count,
+        int approxDimension,
+        const double* approxes,
+        const float* targets,
+        const float* weights,
+        double* ders,
+        double* der2
+    ) const {
+        if (Descriptor.CalcDersMultiRange == nullptr) {
+            IDerCalcer::CalcDersMultiRange(count, approxDimension, approxes, targets, weights, ders, der2);
+            return;
+        }
+        Descriptor.CalcDersMultiRange(count, approxDimension, approxes, targets, weights, ders, der2, Descriptor.CustomData);
+    }
+
+    // one callback call for the range if the descriptor provides batched derivatives, approx and ders are [dim][objectIdx]
+    void CalcFirstDerMultiRange(
+        int start,
+        int count,
+        const TVector<TVector<double>>& approx,
+        const float* targets,
+        const float* weights,
+        TVector<TVector<double>>* ders
+    ) const {
+        if (Descriptor.CalcDersMultiRange == nullptr) {
+            IDerCalcer::CalcFirstDerMultiRange(start, count, approx, targets, weights, ders);
+            return;
+        }
+        const int approxDimension = approx.ysize();
+        TVector<double> approxes; // [objectIdx * approxDimension + dim]
+        approxes.yresize(count * approxDimension);
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            for (int i = 0; i < count; ++i) {
+                approxes[i * approxDimension + dim] = approx[dim][start + i];
+            }
+        }
+        TVector<double> rangeDers;
+        rangeDers.yresize(count * approxDimension);
+        Descriptor.CalcDersMultiRange(
+            count,
+            approxDimension,
+            approxes.data(),
+            targets + start,
+            weights == nullptr ? nullptr : weights + start,
+            rangeDers.data(),
+            /*der2*/ nullptr,
+            Descriptor.CustomData
+        );
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            for (int i = 0; i < count; ++i) {
+                (*ders)[dim][start + i] = rangeDers[i * approxDimension + dim];
+            }
+        }
+    }
+
     void CalcDersRange(
         int start,
         int count,
@@ -771,6 +964,24 @@ public:
         }
     }
 
+    void CalcDersRange(
+        int start,
+        int count,
+        bool calcThirdDer,
+        const double* approxes,
+        const double* approxDeltas,
+        const float* targets,
+        const float* weights,
+        const TDersArrays& ders
+    ) const {
+        TVector<TDers> derivatives(count, {0.0, 0.0, 0.0});
+        CalcDersRange(start, count, calcThirdDer, approxes, approxDeltas, targets, weights, derivatives.data() - start);
+        for (int i = start; i < start + count; ++i) {
+            ders.Der1[i] = derivatives[i - start].Der1;
+            ders.Der2[i] = derivatives[i - start].Der2;
+        }
+    }
+
     void CalcFirstDerRange(
         int start,
         int count,
@@ -258,6 +258,59 @@ void TFold::AssignTarget(const TVector<float>& target, const TVector<TTargetClas
     }
 }
 
+void TFold::PermuteLearnFeatures(const TAllFeatures& learnFeatures, NPar::TLocalExecutor* localExecutor) {
+    PermutedLearnFeatures.FloatHistograms.resize(learnFeatures.FloatHistograms.size());
+    PermutedLearnFeatures.CatFeaturesRemapped.resize(learnFeatures.CatFeaturesRemapped.size());
+    PermutedLearnFeatures.OneHotValues = learnFeatures.OneHotValues;
+    PermutedLearnFeatures.IsOneHot = learnFeatures.IsOneHot;
+    const int floatFeatureCount = learnFeatures.FloatHistograms.ysize();
+    const int catFeatureCount = learnFeatures.CatFeaturesRemapped.ysize();
+    localExecutor->ExecRange(
+        [&](int featureIdx) {
+            if (featureIdx < floatFeatureCount) {
+                // const features have empty histograms
+                if (!learnFeatures.FloatHistograms[featureIdx].empty()) {
+                    AssignPermuted(learnFeatures.FloatHistograms[featureIdx], &PermutedLearnFeatures.FloatHistograms[featureIdx]);
+                }
+            } else {
+                const int catFeatureIdx = featureIdx - floatFeatureCount;
+                if (!learnFeatures.CatFeaturesRemapped[catFeatureIdx].empty()) {
+                    AssignPermuted(learnFeatures.CatFeaturesRemapped[catFeatureIdx], &PermutedLearnFeatures.CatFeaturesRemapped[catFeatureIdx]);
+                }
+            }
+        },
+        0,
+        floatFeatureCount + catFeatureCount,
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+    HasPermutedLearnFeatures = true;
+}
+
+void TFold::TBodyTail::ApplyPendingApproxDelta(bool storeExpApprox, NPar::TLocalExecutor* localExecutor) {
+    if (!HasPendingApproxDelta) {
+        return;
+    }
+    localExecutor->ExecRange(
+        [=](int blockIdx) {
+            if (storeExpApprox) {
+                ApplyPendingApproxDeltaBlock</*StoreExpApprox*/ true>(blockIdx);
+            } else {
+                ApplyPendingApproxDeltaBlock</*StoreExpApprox*/ false>(blockIdx);
+            }
+        },
+        0,
+        GetPendingApproxDeltaBlockCount(),
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+    HasPendingApproxDelta = false;
+}
+
+void TFold::ApplyPendingApproxDeltas(bool storeExpApprox, NPar::TLocalExecutor* localExecutor) {
+    for (auto& bt : BodyTailArr) {
+        bt.ApplyPendingApproxDelta(storeExpApprox, localExecutor);
+    }
+}
+
 void TFold::SaveApproxes(IOutputStream* s) const {
     const ui64 bodyTailCount = BodyTailArr.size();
     ::Save(s, bodyTailCount);
@@ -6,12 +6,15 @@
 #include "approx_util.h"
 #include "projection.h"
 
+#include <catboost/libs/data/quantized_features.h>
 #include <catboost/libs/data_types/pair.h>
 #include <catboost/libs/data_types/query.h>
 #include <catboost/libs/helpers/clear_array.h>
 #include <catboost/libs/model/online_ctr.h>
 #include <catboost/libs/options/defaults_helper.h>
 
+#include <library/threading/local_executor/local_executor.h>
+
 #include <util/generic/vector.h>
 #include <util/random/shuffle.h>
 #include <util/generic/ymath.h>
@@ -40,6 +43,34 @@ struct TFold {
         TVector<TVector<double>> SampleWeightedDerivatives;
         TVector<float> PairwiseWeights;
         TVector<float> SamplePairwiseWeights;
+        // Approx deltas of the last tree, they are applied to Approx by the first pass that reads it
+        TVector<TVector<double>> PendingApproxDelta; // [dim][docIdx]
+        double PendingLearningRate = 0.0;
+        bool HasPendingApproxDelta = false;
+
+        // all passes apply pending deltas by the same blocks, so results do not depend on the pass
+        static constexpr int PendingApproxDeltaBlockSize = 1000;
+
+        int GetPendingApproxDeltaBlockCount() const {
+            return (TailFinish + PendingApproxDeltaBlockSize - 1) / PendingApproxDeltaBlockSize;
+        }
+
+        template <bool StoreExpApprox>
+        void ApplyPendingApproxDeltaBlock(int blockIdx) {
+            Y_ASSERT(HasPendingApproxDelta);
+            const int blockOffset = blockIdx * PendingApproxDeltaBlockSize;
+            const int blockSize = Min(PendingApproxDeltaBlockSize, TailFinish - blockOffset);
+            for (int dim = 0; dim < Approx.ysize(); ++dim) {
+                UpdateApproxRange<StoreExpApprox>(
+                    PendingApproxDelta[dim].data() + blockOffset,
+                    PendingLearningRate,
+                    blockSize,
+                    Approx[dim].data() + blockOffset
+                );
+            }
+        }
+
+        void ApplyPendingApproxDelta(bool storeExpApprox, NPar::TLocalExecutor* localExecutor);
 
         int GetBodyDocCount() const { return BodyFinish; }
 
@@ -58,6 +89,10 @@ struct TFold {
     TVector<TVector<int>> LearnTargetClass;
     TVector<int> TargetClassesCount;
     int PermutationBlockSize = FoldPermutationBlockSizeNotSet;
+    // Quantized learn features in LearnPermutation order, filled only if the fold fits into
+    // the permuted features RAM budget. Then passes over the fold read features sequentially.
+    TAllFeatures PermutedLearnFeatures;
+    bool HasPermutedLearnFeatures = false;
 
     TOnlineCTRHash& GetCtrs(const TProjection& proj) {
         return proj.HasSingleFeature() ? OnlineSingleCtrs : OnlineCTR;
@@ -92,6 +127,18 @@ struct TFold {
         }
     }
 
+    void PermuteLearnFeatures(const TAllFeatures& learnFeatures, NPar::TLocalExecutor* localExecutor);
+
+    // features to index by the position in the fold and the permutation to apply to them,
+    // nullptr if the features are already in the fold order
+    const TAllFeatures& GetLearnFeatures(const TAllFeatures& learnFeatures) const {
+        return HasPermutedLearnFeatures ? PermutedLearnFeatures : learnFeatures;
+    }
+
+    const TVector<size_t>* GetLearnFeaturesPermutation() const {
+        return HasPermutedLearnFeatures ? nullptr : &LearnPermutation;
+    }
+
     int GetApproxDimension() const {
         return BodyTailArr[0].Approx.ysize();
     }
@@ -104,6 +151,8 @@ struct TFold {
 
     const TVector<float>& GetLearnWeights() const { return LearnWeights; }
 
+    void ApplyPendingApproxDeltas(bool storeExpApprox, NPar::TLocalExecutor* localExecutor);
+
     void SaveApproxes(IOutputStream* s) const;
     void LoadApproxes(IInputStream* s);
 
@@ -1,6 +1,7 @@
 #include "helpers.h"
 
 #include <catboost/libs/helpers/exception.h>
+#include <catboost/libs/helpers/resource_constrained_executor.h>
 #include <catboost/libs/logging/logging.h>
 
 #include <library/malloc/api/malloc.h>
@@ -38,17 +39,15 @@ void GenerateBorders(const TPool& pool, TLearnContext* ctx, TVector<TFloatFeatur
         std::iota(randomShuffle.begin(), randomShuffle.end(), 0);
         Shuffle(randomShuffle.begin(), randomShuffle.end(), ctx->Rand);
     }
-    // Estimate how many threads can generate borders
-    const size_t bytes1M = 1024 * 1024, bytesThreadStack = 2 * bytes1M;
+    // Memory for one feature: copy of sampled values + BestSplit internal structures
+    const size_t bytes1M = 1024 * 1024;
     const size_t bytesUsed = NMemInfo::GetMemInfo().RSS;
     const size_t bytesBestSplit = CalcMemoryForFindBestSplit(borderCount, samplesToBuildBorders, borderType);
     const size_t bytesGenerateBorders = sizeof(float) * samplesToBuildBorders;
-    const size_t bytesRequiredPerThread = bytesThreadStack + bytesGenerateBorders + bytesBestSplit;
+    const size_t bytesRequiredPerFeature = bytesGenerateBorders + bytesBestSplit;
     const size_t usedRamLimit = ParseMemorySizeDescription(ctx->Params.SystemOptions->CpuUsedRamLimit);
-    const i64 availableMemory = (i64)usedRamLimit - bytesUsed;
-    const size_t threadCount = availableMemory > 0 ? Min(reasonCount, (ui64)availableMemory / bytesRequiredPerThread) : 1;
-    if (!(usedRamLimit >= bytesUsed)) {
-        MATRIXNET_WARNING_LOG << "CatBoost needs " << (bytesUsed + bytesRequiredPerThread) / bytes1M + 1 << " Mb of memory to generate borders" << Endl;
+    if (usedRamLimit < bytesUsed + bytesRequiredPerFeature) {
+        MATRIXNET_WARNING_LOG << "CatBoost needs " << (bytesUsed + bytesRequiredPerFeature) / bytes1M + 1 << " Mb of memory to generate borders" << Endl;
     }
     TAtomic taskFailedBecauseOfNans = 0;
     THashSet<int> ignoredFeatureIndexes(ctx->Params.DataProcessingOptions->IgnoredFeatures->begin(), ctx->Params.DataProcessingOptions->IgnoredFeatures->end());
@@ -92,18 +91,25 @@ void GenerateBorders(const TPool& pool, TLearnContext* ctx, TVector<TFloatFeatur
         }
         floatFeature.Borders.swap(bordersBlock);
     };
-    size_t nReason = 0;
-    if (threadCount > 1) {
-        for (; nReason + threadCount <= reasonCount; nReason += threadCount) {
-            ctx->LocalExecutor.ExecRange(calcOneFeatureBorder, nReason, nReason + threadCount,
-                                         NPar::TLocalExecutor::WAIT_COMPLETE);
-            CB_ENSURE(taskFailedBecauseOfNans == 0,
-                      "There are nan factors and nan values for float features are not allowed. Set nan_mode != Forbidden.");
+    {
+        // features are processed as soon as there is a free thread and enough memory,
+        // if memory is not enough even for one feature they are processed one by one
+        NCB::TResourceConstrainedExecutor executor(
+            ctx->LocalExecutor,
+            "CPU RAM",
+            Max(usedRamLimit > bytesUsed ? usedRamLimit - bytesUsed : 0, bytesRequiredPerFeature),
+            /*lenientMode*/ false
+        );
+        for (size_t nReason = 0; nReason < reasonCount; ++nReason) {
+            if (ignoredFeatureIndexes.has(floatFeatures->at(nReason).FlatFeatureIndex)) {
+                continue;
+            }
+            executor.Add({bytesRequiredPerFeature, [&calcOneFeatureBorder, nReason] () { calcOneFeatureBorder(nReason); }});
         }
+        executor.ExecTasks();
     }
-    for (; nReason < reasonCount; ++nReason) {
-        calcOneFeatureBorder(nReason);
-    }
+    CB_ENSURE(taskFailedBecauseOfNans == 0,
+              "There are nan factors and nan values for float features are not allowed. Set nan_mode != Forbidden.");
 
     MATRIXNET_INFO_LOG << "Borders for float features generated" << Endl;
 }
@@ -128,19 +134,26 @@ void CalcErrors(
         TVector<bool> skipMetricOnTrain = GetSkipMetricOnTrain(errors);
         const auto& data = learnData;
         ctx->LearnProgress.MetricsAndTimeHistory.LearnMetricsHistory.emplace_back();
+        TVector<const IMetric*> learnMetrics;
         for (int i = 0; i < errors.ysize(); ++i) {
-            const TMap<TString, TString> hints = errors[i]->GetHints();
             if (calcAllMetrics && !skipMetricOnTrain[i]) {
-                ctx->LearnProgress.MetricsAndTimeHistory.LearnMetricsHistory.back().push_back(EvalErrors(
-                    ctx->LearnProgress.AvrgApprox,
-                    data.Target,
-                    data.Weights,
-                    data.QueryInfo,
-                    errors[i],
-                    &ctx->LocalExecutor
-                ));
+                learnMetrics.push_back(errors[i].Get());
             }
         }
+        if (ctx->LearnMetricsCache.GetDocCount() != data.Target.ysize()) {
+            ctx->LearnMetricsCache.Reset(data.Target.ysize());
+        }
+        if (!learnMetrics.empty()) {
+            ctx->MarkLearnApproxChanges();
+        }
+        ctx->LearnProgress.MetricsAndTimeHistory.LearnMetricsHistory.back() = ctx->LearnMetricsCache.EvalErrors(
+            ctx->LearnProgress.AvrgApprox,
+            data.Target,
+            data.Weights,
+            data.QueryInfo,
+            learnMetrics,
+            &ctx->LocalExecutor
+        );
     }
 
     const int errorTrackerMetricIdx = calcErrorTrackerMetric ? 0 : -1;
@@ -159,18 +172,20 @@ void CalcErrors(
             }
             const auto& testApprox = ctx->LearnProgress.TestApprox[testIdx];
             const auto& data = *testDataPtrs[testIdx];
+            TVector<const IMetric*> testMetrics;
             for (int i = 0; i < errors.ysize(); ++i) {
                 if (calcAllMetrics || i == errorTrackerMetricIdx) {
-                    testMetricErrors.back().push_back(EvalErrors(
-                        testApprox,
-                        data.Target,
-                        data.Weights,
-                        data.QueryInfo,
-                        errors[i],
-                        &ctx->LocalExecutor
-                    ));
+                    testMetrics.push_back(errors[i].Get());
                 }
             }
+            testMetricErrors.back() = EvalErrors(
+                testApprox,
+                data.Target,
+                data.Weights,
+                data.QueryInfo,
+                testMetrics,
+                &ctx->LocalExecutor
+            );
         }
     }
 }
@@ -31,8 +31,8 @@ static inline const TVector<int>& GetRemappedCatFeatures(const TSplit& split, co
     return features.CatFeaturesRemapped[split.FeatureIdx];
 }
 
-template <typename TCount, bool (*CmpOp)(TCount, TCount), int vectorWidth>
-void BuildIndicesKernel(const size_t* permutation, const TCount* histogram, TCount value, int level, TIndexType* indices) {
+template <typename TCount, bool (*CmpOp)(TCount, TCount), int vectorWidth, typename TLeafIndex>
+void BuildIndicesKernel(const size_t* permutation, const TCount* histogram, TCount value, int level, TLeafIndex* indices) {
     Y_ASSERT(vectorWidth == 4);
     const int perm0 = permutation[0];
     const int perm1 = permutation[1];
@@ -42,27 +42,34 @@ void BuildIndicesKernel(const size_t* permutation, const TCount* histogram, TCou
     const TCount hist1 = histogram[perm1];
     const TCount hist2 = histogram[perm2];
     const TCount hist3 = histogram[perm3];
-    const TIndexType idx0 = indices[0];
-    const TIndexType idx1 = indices[1];
-    const TIndexType idx2 = indices[2];
-    const TIndexType idx3 = indices[3];
+    const TLeafIndex idx0 = indices[0];
+    const TLeafIndex idx1 = indices[1];
+    const TLeafIndex idx2 = indices[2];
+    const TLeafIndex idx3 = indices[3];
     indices[0] = idx0 + CmpOp(hist0, value) * level;
     indices[1] = idx1 + CmpOp(hist1, value) * level;
     indices[2] = idx2 + CmpOp(hist2, value) * level;
     indices[3] = idx3 + CmpOp(hist3, value) * level;
 }
 
-template <typename TCount, bool (*CmpOp)(TCount, TCount)>
+template <typename TCount, bool (*CmpOp)(TCount, TCount), typename TLeafIndex>
 void OfflineCtrBlock(const NPar::TLocalExecutor::TExecRangeParams& params,
                      int blockIdx,
                      const TFold& fold,
                      const TCount* histogram,
                      TCount value,
                      int level,
-                     TIndexType* indices) {
-    const size_t* permutation = fold.LearnPermutation.data();
+                     TLeafIndex* indices) {
     const int blockStart = blockIdx * params.GetBlockSize();
     const int nextBlockStart = Min<ui64>(blockStart + params.GetBlockSize(), params.LastId);
+    if (fold.GetLearnFeaturesPermutation() == nullptr) {
+        // histogram is already in the fold order
+        for (int doc = blockStart; doc < nextBlockStart; ++doc) {
+            indices[doc] += CmpOp(histogram[doc], value) * level;
+        }
+        return;
+    }
+    const size_t* permutation = fold.LearnPermutation.data();
     constexpr int vectorWidth = 4;
     int doc;
     for (doc = blockStart; doc + vectorWidth <= nextBlockStart; doc += vectorWidth) {
@@ -88,9 +95,10 @@ void SetPermutedIndices(const TSplit& split,
 
     const int splitWeight = 1 << (curDepth - 1);
     TIndexType* indicesData = indices->data();
+    const TAllFeatures& foldFeatures = fold.GetLearnFeatures(features);
     if (split.Type == ESplitType::FloatFeature) {
         localExecutor->ExecRange([&](int blockIdx) {
-            OfflineCtrBlock<ui8, IsTrueHistogram>(blockParams, blockIdx, fold, GetFloatHistogram(split, features).data(),
+            OfflineCtrBlock<ui8, IsTrueHistogram>(blockParams, blockIdx, fold, GetFloatHistogram(split, foldFeatures).data(),
                                                   GetFeatureSplitIdx(split), splitWeight, indicesData);
         }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
     } else if (split.Type == ESplitType::OnlineCtr) {
@@ -101,7 +109,7 @@ void SetPermutedIndices(const TSplit& split,
     } else {
         Y_ASSERT(split.Type == ESplitType::OneHotFeature);
         localExecutor->ExecRange([&] (int blockIdx) {
-            OfflineCtrBlock<int, IsTrueOneHotFeature>(blockParams, blockIdx, fold, GetRemappedCatFeatures(split, features).data(),
+            OfflineCtrBlock<int, IsTrueOneHotFeature>(blockParams, blockIdx, fold, GetRemappedCatFeatures(split, foldFeatures).data(),
                                                       split.BinBorder, splitWeight, indicesData);
         }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
     }
@@ -148,16 +156,18 @@ static TVector<const TOnlineCTR*> GetOnlineCtrs(const TFold& fold, const TSplitT
     return onlineCtrs;
 }
 
+template <typename TLeafIndex>
 static void BuildIndicesForLearn(const TSplitTree& tree,
                                  const TDataset& learnData,
                                  int learnSampleCount,
                                  const TVector<const TOnlineCTR*>& onlineCtrs,
                                  const TFold& fold,
                                  NPar::TLocalExecutor* localExecutor,
-                                 TIndexType* indices) {
+                                 TLeafIndex* indices) {
     const int blockSize = 1000;
     NPar::TLocalExecutor::TExecRangeParams learnBlockParams(0, learnSampleCount);
     learnBlockParams.SetBlockSize(blockSize);
+    const TAllFeatures& foldFeatures = fold.GetLearnFeatures(learnData.AllFeatures);
 
     auto updateLearnIndex = [&](int blockIdx) {
         for (int splitIdx = 0; splitIdx < tree.GetDepth(); ++splitIdx) {
@@ -165,7 +175,7 @@ static void BuildIndicesForLearn(const TSplitTree& tree,
             const int splitWeight = 1 << splitIdx;
             if (split.Type == ESplitType::FloatFeature) {
                 OfflineCtrBlock<ui8, IsTrueHistogram>(learnBlockParams, blockIdx, fold,
-                    GetFloatHistogram(split, learnData.AllFeatures).data(),
+                    GetFloatHistogram(split, foldFeatures).data(),
                     GetFeatureSplitIdx(split), splitWeight, indices);
             } else if (split.Type == ESplitType::OnlineCtr) {
                 const TOnlineCTR& splitOnlineCtr = *onlineCtrs[splitIdx];
@@ -175,7 +185,7 @@ static void BuildIndicesForLearn(const TSplitTree& tree,
             } else {
                 Y_ASSERT(split.Type == ESplitType::OneHotFeature);
                 OfflineCtrBlock<int, IsTrueOneHotFeature>(learnBlockParams, blockIdx, fold,
-                    GetRemappedCatFeatures(split, learnData.AllFeatures).data(),
+                    GetRemappedCatFeatures(split, foldFeatures).data(),
                     split.BinBorder, splitWeight, indices);
             }
         }
@@ -184,19 +194,20 @@ static void BuildIndicesForLearn(const TSplitTree& tree,
     localExecutor->ExecRange(updateLearnIndex, 0, learnBlockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
+template <typename TLeafIndex>
 static void BuildIndicesForTest(const TSplitTree& tree,
                                 const TDataset& testData,
                                 int tailSampleCount,
                                 const TVector<const TOnlineCTR*>& onlineCtrs,
                                 int docOffset,
                                 NPar::TLocalExecutor* localExecutor,
-                                TIndexType* indices) {
+                                TLeafIndex* indices) {
     const int blockSize = 1000;
     NPar::TLocalExecutor::TExecRangeParams tailBlockParams(0, tailSampleCount);
     tailBlockParams.SetBlockSize(blockSize);
 
     auto updateTailIndex = [&](int blockIdx) {
-        TIndexType* tailIndices = indices;
+        TLeafIndex* tailIndices = indices;
         for (int splitIdx = 0; splitIdx < tree.GetDepth(); ++splitIdx) {
             const auto& split = tree.Splits[splitIdx];
             const int splitWeight = 1 << splitIdx;
@@ -225,17 +236,19 @@ static void BuildIndicesForTest(const TSplitTree& tree,
     localExecutor->ExecRange(updateTailIndex, 0, tailBlockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
-TVector<TIndexType> BuildIndices(const TFold& fold,
+template <typename TLeafIndex>
+TVector<TLeafIndex> BuildIndices(const TFold& fold,
                                  const TSplitTree& tree,
                                  const TDataset& learnData,
                                  const TDatasetPtrs& testDataPtrs,
                                  NPar::TLocalExecutor* localExecutor) {
+    CB_ENSURE(static_cast<ui64>(tree.GetLeafCount() - 1) <= Max<TLeafIndex>(), "Leaf index type is too narrow for tree depth " << tree.GetDepth());
     int learnSampleCount = learnData.GetSampleCount();
     int tailSampleCount = GetSampleCount(testDataPtrs);
 
     const TVector<const TOnlineCTR*>& onlineCtrs = GetOnlineCtrs(fold, tree);
 
-    TVector<TIndexType> indices(learnSampleCount + tailSampleCount);
+    TVector<TLeafIndex> indices(learnSampleCount + tailSampleCount);
 
     BuildIndicesForLearn(tree, learnData, learnSampleCount, onlineCtrs, fold, localExecutor, indices.begin());
     int docOffset = learnSampleCount;
@@ -247,6 +260,9 @@ TVector<TIndexType> BuildIndices(const TFold& fold,
     return indices;
 }
 
+template TVector<ui8> BuildIndices<ui8>(const TFold&, const TSplitTree&, const TDataset&, const TDatasetPtrs&, NPar::TLocalExecutor*);
+template TVector<TIndexType> BuildIndices<TIndexType>(const TFold&, const TSplitTree&, const TDataset&, const TDatasetPtrs&, NPar::TLocalExecutor*);
+
 void BinarizeFeatures(const TFullModel& model,
                       const TPool& pool,
                       size_t start,
@@ -4,10 +4,12 @@
 #include <catboost/libs/distributed/master.h>
 #include <catboost/libs/helpers/progress_helper.h>
 #include <catboost/libs/options/defaults_helper.h>
+#include <catboost/libs/options/system_options.h>
 
 #include <library/digest/crc32c/crc32c.h>
 #include <library/digest/md5/md5.h>
 
+#include <util/generic/algorithm.h>
 #include <util/generic/guid.h>
 #include <util/folder/path.h>
 #include <util/system/fs.h>
@@ -59,6 +61,47 @@ static ui32 CalcFeaturesCheckSum(const TAllFeatures& allFeatures) {
     return checkSum;
 }
 
+static ui64 GetLearnFeaturesSize(const TAllFeatures& features) {
+    ui64 size = 0;
+    for (const auto& histogram : features.FloatHistograms) {
+        size += histogram.size() * sizeof(ui8);
+    }
+    for (const auto& catFeature : features.CatFeaturesRemapped) {
+        size += catFeature.size() * sizeof(int);
+    }
+    return size;
+}
+
+// Learning folds are read at every depth of every tree, so they get the budget before the averaging fold.
+// Folds in the original order are read sequentially anyway and need no copy.
+static void PermuteFoldsLearnFeatures(
+    const TAllFeatures& learnFeatures,
+    ui64 ramLimit,
+    TLearnProgress* learnProgress,
+    NPar::TLocalExecutor* localExecutor
+) {
+    const ui64 foldFeaturesSize = GetLearnFeaturesSize(learnFeatures);
+    if (foldFeaturesSize == 0) {
+        return;
+    }
+    TVector<TFold*> folds;
+    for (auto& fold : learnProgress->Folds) {
+        folds.push_back(&fold);
+    }
+    folds.push_back(&learnProgress->AveragingFold);
+    ui64 usedRam = 0;
+    for (TFold* fold : folds) {
+        if (IsSorted(fold->LearnPermutation.begin(), fold->LearnPermutation.end())) {
+            continue;
+        }
+        if (usedRam + foldFeaturesSize > ramLimit) {
+            break;
+        }
+        fold->PermuteLearnFeatures(learnFeatures, localExecutor);
+        usedRam += foldFeaturesSize;
+    }
+}
+
 void TLearnContext::InitContext(const TDataset& learnData, const TDatasetPtrs& testDataPtrs) {
     LearnProgress.PoolCheckSum = CalcFeaturesCheckSum(learnData.AllFeatures);
     for (const TDataset* testData : testDataPtrs) {
@@ -137,10 +180,21 @@ void TLearnContext::InitContext(const TDataset& learnData, const TDatasetPtrs& t
         Rand
     );
 
+    // distributed workers build their own folds from the parts of the learn set
+    if (Params.SystemOptions->IsSingleHost()) {
+        PermuteFoldsLearnFeatures(
+            learnData.AllFeatures,
+            ParseMemorySizeDescription(Params.SystemOptions->PermutedFeaturesRamLimit.Get()),
+            &LearnProgress,
+            &LocalExecutor
+        );
+    }
+
     LearnProgress.AvrgApprox.resize(LearnProgress.ApproxDimension, TVector<double>(learnData.GetSampleCount()));
     if (!learnData.Baseline.empty()) {
         LearnProgress.AvrgApprox = learnData.Baseline;
     }
+    LearnMetricsCache.Reset(learnData.GetSampleCount());
     ResizeRank2(testDataPtrs.size(), LearnProgress.ApproxDimension, LearnProgress.TestApprox);
     for (size_t testIdx = 0; testIdx < testDataPtrs.size(); ++testIdx) {
         const auto* testData = testDataPtrs[testIdx];
@@ -157,10 +211,50 @@ void TLearnContext::InitContext(const TDataset& learnData, const TDatasetPtrs& t
     }
 }
 
+void TLearnContext::AddLearnApproxChanges(const TVector<TVector<double>>& treeValues, TVector<TIndexType>&& averagingFoldIndices) {
+    if (!IsLastTreeLeafChanged.empty()) {
+        // learn metrics were not evaluated after the previous tree
+        LearnMetricsCache.MarkAllChanged();
+        IsLastTreeLeafChanged.clear();
+    }
+    TVector<ui8> isLeafChanged(treeValues[0].size(), 0);
+    for (const auto& dimTreeValues : treeValues) {
+        for (int leafIdx = 0; leafIdx < dimTreeValues.ysize(); ++leafIdx) {
+            isLeafChanged[leafIdx] |= dimTreeValues[leafIdx] != 0;
+        }
+    }
+    if (AllOf(isLeafChanged, [](ui8 isChanged) { return isChanged != 0; })) {
+        LearnMetricsCache.MarkAllChanged();
+        return;
+    }
+    IsLastTreeLeafChanged = std::move(isLeafChanged);
+    LastTreeLearnIndices = std::move(averagingFoldIndices);
+}
+
+void TLearnContext::MarkLearnApproxChanges() {
+    if (IsLastTreeLeafChanged.empty()) {
+        return;
+    }
+    const TVector<size_t>& learnPermutation = LearnProgress.AveragingFold.LearnPermutation;
+    LearnMetricsCache.MarkChangedPermuted(
+        learnPermutation,
+        [&](size_t position) {
+            return IsLastTreeLeafChanged[LastTreeLearnIndices[position]] != 0;
+        },
+        &LocalExecutor
+    );
+    IsLastTreeLeafChanged.clear();
+    LastTreeLearnIndices.clear();
+}
+
 void TLearnContext::SaveProgress() {
     if (!OutputOptions.SaveSnapshot()) {
         return;
     }
+    const bool storeExpApprox = IsStoreExpApprox(Params.LossFunctionDescription->GetLossFunction());
+    for (auto& fold : LearnProgress.Folds) {
+        fold.ApplyPendingApproxDeltas(storeExpApprox, &LocalExecutor);
+    }
     TProgressHelper(ToString(ETaskType::CPU)).Write(Files.SnapshotFile, [&](IOutputStream* out) {
         ::SaveMany(out, Rand, LearnProgress, Profile.DumpProfileInfo());
     });
@@ -182,6 +276,7 @@ bool TLearnContext::TryLoadProgress() {
             const bool poolCompatible = (LearnProgressRestored.PoolCheckSum == LearnProgress.PoolCheckSum);
             CB_ENSURE(poolCompatible, "Current pool differs from the original pool");
             LearnProgress = std::move(LearnProgressRestored);
+            LearnMetricsCache.MarkAllChanged();
             Profile.InitProfileInfo(std::move(ProfileRestored));
             LearnProgress.SerializedTrainParams = ToString(Params); // substitute real
             MATRIXNET_INFO_LOG << "Loaded progress file containing " <<  LearnProgress.TreeStruct.size() << " trees" << Endl;
@@ -8,6 +8,7 @@
 #include "calc_score_cache.h"
 
 #include <catboost/libs/metrics/metric.h>
+#include <catboost/libs/metrics/metric_cache.h>
 #include <catboost/libs/logging/logging.h>
 #include <catboost/libs/logging/profile_info.h>
 #include <catboost/libs/options/catboost_options.h>
@@ -117,6 +118,11 @@ public:
     void SaveProgress();
     bool TryLoadProgress();
 
+    // Changes of AvrgApprox by the last tree are marked in LearnMetricsCache lazily,
+    // only if learn metrics are evaluated before the next tree.
+    void AddLearnApproxChanges(const TVector<TVector<double>>& treeValues, TVector<TIndexType>&& averagingFoldIndices);
+    void MarkLearnApproxChanges();
+
 public:
     TRestorableFastRng64 Rand;
     TLearnProgress LearnProgress;
@@ -126,8 +132,13 @@ public:
     TCalcScoreFold SmallestSplitSideDocs;
     TCalcScoreFold SampledDocs;
     TBucketStatsCache PrevTreeLevelStats;
+    TIncrementalMetricsCache LearnMetricsCache; // for LearnProgress.AvrgApprox
     TObj<NPar::IRootEnvironment> RootEnvironment;
     TObj<NPar::IEnvironment> SharedTrainData;
     TProfileInfo Profile;
+
+private:
+    TVector<TIndexType> LastTreeLearnIndices; // [doc in AveragingFold order]
+    TVector<ui8> IsLastTreeLeafChanged; // empty if there are no unmarked changes
 };
 
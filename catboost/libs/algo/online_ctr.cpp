@@ -341,10 +341,16 @@ void ComputeOnlineCTRs(const TDataset& learnData,
         // Shortcut for simple ctrs
         Clear(&hashArr, totalSampleCount);
         if (learnSampleCount > 0) {
-            const int* featureValues = learnData.AllFeatures.CatFeaturesRemapped[proj.CatFeatures[0]].data();
-            const auto* permutation = fold.LearnPermutation.data();
-            for (size_t i = 0; i < learnSampleCount; ++i) {
-                hashArr[i] = ((ui64)featureValues[permutation[i]]) + 1;
+            const int* featureValues = fold.GetLearnFeatures(learnData.AllFeatures).CatFeaturesRemapped[proj.CatFeatures[0]].data();
+            if (fold.GetLearnFeaturesPermutation() == nullptr) {
+                for (size_t i = 0; i < learnSampleCount; ++i) {
+                    hashArr[i] = ((ui64)featureValues[i]) + 1;
+                }
+            } else {
+                const auto* permutation = fold.LearnPermutation.data();
+                for (size_t i = 0; i < learnSampleCount; ++i) {
+                    hashArr[i] = ((ui64)featureValues[permutation[i]]) + 1;
+                }
             }
         }
         for (size_t docOffset = learnSampleCount, testIdx = 0; docOffset < totalSampleCount && testIdx < testDataPtrs.size(); ++testIdx) {
@@ -358,7 +364,7 @@ void ComputeOnlineCTRs(const TDataset& learnData,
         rehashHashTlsVal.Get().MakeEmpty(learnData.AllFeatures.OneHotValues[proj.CatFeatures[0]].size());
     } else {
         Clear(&hashArr, totalSampleCount);
-        CalcHashes(proj, learnData.AllFeatures, 0, &fold.LearnPermutation, false, hashArr.begin(), hashArr.begin() + learnSampleCount);
+        CalcHashes(proj, fold.GetLearnFeatures(learnData.AllFeatures), 0, fold.GetLearnFeaturesPermutation(), false, hashArr.begin(), hashArr.begin() + learnSampleCount);
         for (size_t docOffset = learnSampleCount, testIdx = 0; docOffset < totalSampleCount && testIdx < testDataPtrs.size(); ++testIdx) {
             const size_t testSampleCount = testDataPtrs[testIdx]->GetSampleCount();
             CalcHashes(proj, testDataPtrs[testIdx]->AllFeatures, 0, nullptr, false, hashArr.begin() + docOffset, hashArr.begin() + docOffset + testSampleCount);
@@ -65,6 +65,11 @@ struct TSumMulti {
 
     void AddDerWeight(const TVector<double>& delta, double weight, int gradientIteration) {
         Y_ASSERT(delta.ysize() == SumDerHistory[gradientIteration].ysize());
+        AddDerWeight(delta.data(), weight, gradientIteration);
+    }
+
+    // delta has approxDimension elements
+    void AddDerWeight(const double* delta, double weight, int gradientIteration) {
         for (int dim = 0; dim < SumDerHistory[gradientIteration].ysize(); ++dim) {
             SumDerHistory[gradientIteration][dim] += delta[dim];
         }
@@ -80,6 +85,17 @@ struct TSumMulti {
         }
         SumDer2History[gradientIteration].AddDer2(der2);
     }
+
+    // delta has approxDimension elements, der2Data has the layout of THessianInfo::Data
+    void AddDerDer2(const double* delta, const double* der2Data, int gradientIteration) {
+        for (int dim = 0; dim < SumDerHistory[gradientIteration].ysize(); ++dim) {
+            SumDerHistory[gradientIteration][dim] += delta[dim];
+        }
+        auto& sumDer2 = SumDer2History[gradientIteration].Data;
+        for (int idx = 0; idx < sumDer2.ysize(); ++idx) {
+            sumDer2[idx] += der2Data[idx];
+        }
+    }
     SAVELOAD(SumDerHistory, SumDer2History, SumWeights);
 };
 
@@ -47,11 +47,12 @@ TVector<double> CalculatePairwiseLeafValues(
     return res;
 }
 
+template <typename TLeafIndex>
 TArray2D<double> ComputePairwiseWeightSums(
     const TVector<TQueryInfo>& queriesInfo,
     int leafCount,
     int querycount,
-    const TVector<TIndexType>& indices
+    const TVector<TLeafIndex>& indices
 ) {
     TArray2D<double> pairwiseWeightSums;
     pairwiseWeightSums.SetSizes(leafCount, leafCount);
@@ -76,3 +77,6 @@ TArray2D<double> ComputePairwiseWeightSums(
     }
     return pairwiseWeightSums;
 }
+
+template TArray2D<double> ComputePairwiseWeightSums<ui8>(const TVector<TQueryInfo>&, int, int, const TVector<ui8>&);
+template TArray2D<double> ComputePairwiseWeightSums<TIndexType>(const TVector<TQueryInfo>&, int, int, const TVector<TIndexType>&);
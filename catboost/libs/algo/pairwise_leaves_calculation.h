@@ -14,10 +14,12 @@ TVector<double> CalculatePairwiseLeafValues(
     float pairwiseBucketWeightPriorReg
 );
 
+// instantiated for ui8 and TIndexType leaf indices
+template <typename TLeafIndex>
 TArray2D<double> ComputePairwiseWeightSums(
     const TVector<TQueryInfo>& queriesInfo,
     int leafCount,
     int querycount,
-    const TVector<TIndexType>& indices
+    const TVector<TLeafIndex>& indices
 );
 
@@ -1,6 +1,7 @@
 #include "pairwise_scoring.h"
 #include "pairwise_leaves_calculation.h"
 
+#include <util/generic/utility.h>
 #include <util/generic/xrange.h>
 #include <util/system/yassert.h>
 
@@ -40,6 +41,36 @@ void TPairwiseStats::Add(const TPairwiseStats& rhs) {
     }
 }
 
+void TPairwiseStats::Add(const TVector<TPairwiseStats>& rhs, NPar::TLocalExecutor* localExecutor) {
+    if (rhs.empty()) {
+        return;
+    }
+    const int leafCount = DerSums.ysize();
+    Y_ASSERT(PairWeightStatistics.GetYSize() == static_cast<size_t>(leafCount));
+    // rows are independent, and the summation order of each element is the same as in sequential Add
+    localExecutor->ExecRange([&] (int leafIdx1) {
+        auto& dstDerSums = DerSums[leafIdx1];
+        auto dst1 = PairWeightStatistics[leafIdx1];
+        for (const auto& addItem : rhs) {
+            const auto& addDerSums = addItem.DerSums[leafIdx1];
+            Y_ASSERT(dstDerSums.size() == addDerSums.size());
+            for (auto bucketIdx : xrange(dstDerSums.size())) {
+                dstDerSums[bucketIdx] += addDerSums[bucketIdx];
+            }
+
+            const auto add1 = addItem.PairWeightStatistics[leafIdx1];
+            for (auto leafIdx2 : xrange(PairWeightStatistics.GetXSize())) {
+                auto& dst2 = dst1[leafIdx2];
+                const auto& add2 = add1[leafIdx2];
+                Y_ASSERT(dst2.size() == add2.size());
+                for (auto bucketIdx : xrange(dst2.size())) {
+                    dst2[bucketIdx].Add(add2[bucketIdx]);
+                }
+            }
+        }
+    }, 0, leafCount, NPar::TLocalExecutor::WAIT_COMPLETE);
+}
+
 
 template<typename TFullIndexType>
 inline static ui32 GetLeafIndex(TFullIndexType index, int bucketCount) {
@@ -193,12 +224,33 @@ static double CalculateScore(const TVector<double>& avrg, const TVector<double>&
     return score;
 }
 
+// packed rows of the lower triangle with the diagonal, element [y][x] is at y * (y + 1) / 2 + x
+static void PackLowerTriangle(const TArray2D<double>& lowerTriangle, double* packed) {
+    const int size = lowerTriangle.GetYSize();
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x <= y; ++x) {
+            *packed++ = lowerTriangle[y][x];
+        }
+    }
+}
+
+static void CopySymmetricFromPackedLowerTriangle(const double* packed, TArray2D<double>* matrix) {
+    const int size = matrix->GetYSize();
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x <= y; ++x, ++packed) {
+            (*matrix)[y][x] = *packed;
+            (*matrix)[x][y] = *packed;
+        }
+    }
+}
+
 void CalculatePairwiseScore(
     const TPairwiseStats& pairwiseStats,
     int bucketCount,
     ESplitType splitType,
     float l2DiagReg,
     float pairwiseBucketWeightPriorReg,
+    NPar::TLocalExecutor* localExecutor,
     TVector<TScoreBin>* scoreBins
 ) {
     scoreBins->yresize(bucketCount);
@@ -208,8 +260,10 @@ void CalculatePairwiseScore(
     const auto& pairWeightStatistics = pairwiseStats.PairWeightStatistics;
 
     const int leafCount = derSums.ysize();
-    TVector<double> derSum(2 * leafCount, 0.0);
-    TArray2D<double> weightSum(2 * leafCount, 2 * leafCount);
+    const int matrixSize = 2 * leafCount;
+    TVector<double> derSum(matrixSize, 0.0);
+    // weightSum is symmetric, so only its lower triangle (with the diagonal) is accumulated
+    TArray2D<double> weightSum(matrixSize, matrixSize);
     weightSum.FillZero();
     Y_ASSERT(splitType == ESplitType::OnlineCtr || splitType == ESplitType::FloatFeature);
 
@@ -237,53 +291,103 @@ void CalculatePairwiseScore(
             for (int bucketId = bucketCount & ~3u; bucketId < bucketCount; ++bucketId) {
                 total += xyData[bucketId].SmallerBorderWeightSum + yxData[bucketId].SmallerBorderWeightSum;
             }
-            weightSum[2 * y + 1][2 * x + 1] += total;
             weightSum[2 * x + 1][2 * y + 1] += total;
             weightSum[2 * x + 1][2 * x + 1] -= total;
             weightSum[2 * y + 1][2 * y + 1] -= total;
         }
     }
 
-    for (int splitId = 0; splitId < bucketCount - 1; ++splitId) {
-        for (int y = 0; y < leafCount; ++y) {
-            const double derDelta = derSums[y][splitId];
-            derSum[2 * y] += derDelta;
-            derSum[2 * y + 1] -= derDelta;
-
-            const double weightDelta = (pairWeightStatistics[y][y][splitId].SmallerBorderWeightSum -
-                pairWeightStatistics[y][y][splitId].GreaterBorderRightWeightSum);
-            weightSum[2 * y][2 * y + 1] += weightDelta;
-            weightSum[2 * y + 1][2 * y] += weightDelta;
-            weightSum[2 * y][2 * y] -= weightDelta;
-            weightSum[2 * y + 1][2 * y + 1] -= weightDelta;
-            for (int x = y + 1; x < leafCount; ++x) {
-                const TBucketPairWeightStatistics& xy = pairWeightStatistics[x][y][splitId];
-                const TBucketPairWeightStatistics& yx = pairWeightStatistics[y][x][splitId];
-
-                const double w00Delta = xy.GreaterBorderRightWeightSum + yx.GreaterBorderRightWeightSum;
-                const double w01Delta = xy.SmallerBorderWeightSum - xy.GreaterBorderRightWeightSum;
-                const double w10Delta = yx.SmallerBorderWeightSum - yx.GreaterBorderRightWeightSum;
-                const double w11Delta = -(xy.SmallerBorderWeightSum + yx.SmallerBorderWeightSum);
-
-                weightSum[2 * x][2 * y] += w00Delta;
-                weightSum[2 * y][2 * x] += w00Delta;
-                weightSum[2 * x][2 * y + 1] += w01Delta;
-                weightSum[2 * y + 1][2 * x] += w01Delta;
-                weightSum[2 * x + 1][2 * y] += w10Delta;
-                weightSum[2 * y][2 * x + 1] += w10Delta;
-                weightSum[2 * x + 1][2 * y + 1] += w11Delta;
-                weightSum[2 * y + 1][2 * x + 1] += w11Delta;
-
-                weightSum[2 * y][2 * y] -= w00Delta + w10Delta;
-                weightSum[2 * x][2 * x] -= w00Delta + w01Delta;
-                weightSum[2 * x + 1][2 * x + 1] -= w10Delta + w11Delta;
-                weightSum[2 * y + 1][2 * y + 1] -= w01Delta + w11Delta;
+    /* Splits are processed by tiles: deltas of all splits of a tile are gathered from the statistics at once,
+     * then they are applied split by split and the snapshots of the systems are solved in parallel.
+     * Snapshots of weightSum are packed lower triangles, their total size is bounded by TileSnapshotsMemoryBudget.
+     */
+    constexpr int SplitTileSize = 16;
+    constexpr size_t TileSnapshotsMemoryBudget = 2 << 20;
+    const int splitCount = bucketCount - 1;
+    const size_t packedWeightSumSize = matrixSize * (matrixSize + 1) / 2;
+    const int tileSize = Min<int>(
+        Max<size_t>(1, TileSnapshotsMemoryBudget / (packedWeightSumSize * sizeof(double))),
+        SplitTileSize,
+        splitCount
+    );
+    const int leafPairCount = leafCount * (leafCount - 1) / 2;
+    TVector<double> leafDeltas(tileSize * leafCount * 2); // [splitInTile][leaf][derDelta, weightDelta]
+    TVector<double> leafPairDeltas(tileSize * leafPairCount * 4); // [splitInTile][leafPair][w00, w01, w10, w11]
+    TVector<TVector<double>> tileDerSums(tileSize);
+    TVector<double> tileWeightSums(tileSize * packedWeightSumSize); // [splitInTile][packed lower triangle]
+    const int threadCount = localExecutor->GetThreadCount() + 1;
+
+    for (int tileStart = 0; tileStart < splitCount; tileStart += tileSize) {
+        const int tileEnd = Min(tileStart + tileSize, splitCount);
+
+        for (int y = 0, leafPairIdx = 0; y < leafCount; ++y) {
+            const TBucketPairWeightStatistics* yyData = pairWeightStatistics[y][y].data();
+            for (int splitId = tileStart; splitId < tileEnd; ++splitId) {
+                double* deltas = &leafDeltas[((splitId - tileStart) * leafCount + y) * 2];
+                deltas[0] = derSums[y][splitId];
+                deltas[1] = yyData[splitId].SmallerBorderWeightSum - yyData[splitId].GreaterBorderRightWeightSum;
+            }
+            for (int x = y + 1; x < leafCount; ++x, ++leafPairIdx) {
+                const TBucketPairWeightStatistics* xyData = pairWeightStatistics[x][y].data();
+                const TBucketPairWeightStatistics* yxData = pairWeightStatistics[y][x].data();
+                for (int splitId = tileStart; splitId < tileEnd; ++splitId) {
+                    const TBucketPairWeightStatistics& xy = xyData[splitId];
+                    const TBucketPairWeightStatistics& yx = yxData[splitId];
+                    double* deltas = &leafPairDeltas[((splitId - tileStart) * leafPairCount + leafPairIdx) * 4];
+                    deltas[0] = xy.GreaterBorderRightWeightSum + yx.GreaterBorderRightWeightSum;
+                    deltas[1] = xy.SmallerBorderWeightSum - xy.GreaterBorderRightWeightSum;
+                    deltas[2] = yx.SmallerBorderWeightSum - yx.GreaterBorderRightWeightSum;
+                    deltas[3] = -(xy.SmallerBorderWeightSum + yx.SmallerBorderWeightSum);
+                }
+            }
+        }
+
+        for (int splitId = tileStart; splitId < tileEnd; ++splitId) {
+            const double* splitLeafDeltas = &leafDeltas[(splitId - tileStart) * leafCount * 2];
+            const double* splitLeafPairDeltas = &leafPairDeltas[(splitId - tileStart) * leafPairCount * 4];
+            for (int y = 0; y < leafCount; ++y) {
+                const double derDelta = splitLeafDeltas[2 * y];
+                derSum[2 * y] += derDelta;
+                derSum[2 * y + 1] -= derDelta;
+
+                const double weightDelta = splitLeafDeltas[2 * y + 1];
+                weightSum[2 * y + 1][2 * y] += weightDelta;
+                weightSum[2 * y][2 * y] -= weightDelta;
+                weightSum[2 * y + 1][2 * y + 1] -= weightDelta;
+                for (int x = y + 1; x < leafCount; ++x, splitLeafPairDeltas += 4) {
+                    const double w00Delta = splitLeafPairDeltas[0];
+                    const double w01Delta = splitLeafPairDeltas[1];
+                    const double w10Delta = splitLeafPairDeltas[2];
+                    const double w11Delta = splitLeafPairDeltas[3];
+
+                    weightSum[2 * x][2 * y] += w00Delta;
+                    weightSum[2 * x][2 * y + 1] += w01Delta;
+                    weightSum[2 * x + 1][2 * y] += w10Delta;
+                    weightSum[2 * x + 1][2 * y + 1] += w11Delta;
+
+                    weightSum[2 * y][2 * y] -= w00Delta + w10Delta;
+                    weightSum[2 * x][2 * x] -= w00Delta + w01Delta;
+                    weightSum[2 * x + 1][2 * x + 1] -= w10Delta + w11Delta;
+                    weightSum[2 * y + 1][2 * y + 1] -= w01Delta + w11Delta;
+                }
             }
+            tileDerSums[splitId - tileStart] = derSum;
+            PackLowerTriangle(weightSum, &tileWeightSums[(splitId - tileStart) * packedWeightSumSize]);
         }
 
-        const TVector<double> leafValues = CalculatePairwiseLeafValues(weightSum, derSum, l2DiagReg, pairwiseBucketWeightPriorReg);
-        (*scoreBins)[splitId].D2 = 1.0;
-        (*scoreBins)[splitId].DP = CalculateScore(leafValues, derSum, weightSum);
+        NPar::TLocalExecutor::TExecRangeParams blockParams(tileStart, tileEnd);
+        blockParams.SetBlockCount(Min(threadCount, tileEnd - tileStart));
+        localExecutor->ExecRange([&] (int blockId) {
+            TArray2D<double> splitWeightSum(matrixSize, matrixSize); // block scratch space
+            const int blockStart = tileStart + blockId * blockParams.GetBlockSize();
+            const int blockEnd = Min(blockStart + blockParams.GetBlockSize(), tileEnd);
+            for (int splitId = blockStart; splitId < blockEnd; ++splitId) {
+                const auto& splitDerSum = tileDerSums[splitId - tileStart];
+                CopySymmetricFromPackedLowerTriangle(&tileWeightSums[(splitId - tileStart) * packedWeightSumSize], &splitWeightSum);
+                const TVector<double> leafValues = CalculatePairwiseLeafValues(splitWeightSum, splitDerSum, l2DiagReg, pairwiseBucketWeightPriorReg);
+                (*scoreBins)[splitId].D2 = 1.0;
+                (*scoreBins)[splitId].DP = CalculateScore(leafValues, splitDerSum, splitWeightSum);
+            }
+        }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
     }
 }
-
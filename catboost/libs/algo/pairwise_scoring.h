@@ -8,6 +8,7 @@
 #include <catboost/libs/helpers/index_range.h>
 
 #include <library/binsaver/bin_saver.h>
+#include <library/threading/local_executor/local_executor.h>
 
 struct TBucketPairWeightStatistics {
     double SmallerBorderWeightSum = 0.0; // The weight sum of pair elements with smaller border.
@@ -26,6 +27,8 @@ struct TPairwiseStats {
     TArray2D<TVector<TBucketPairWeightStatistics>> PairWeightStatistics; // [leafCount][leafCount][bucketCount]
 
     void Add(const TPairwiseStats& rhs);
+    // Same as calling Add for each element of rhs in order, but rows of leaves are summed in parallel
+    void Add(const TVector<TPairwiseStats>& rhs, NPar::TLocalExecutor* localExecutor);
     SAVELOAD(DerSums, PairWeightStatistics);
 };
 
@@ -54,6 +57,7 @@ void CalculatePairwiseScore(
     ESplitType splitType,
     float l2DiagReg,
     float pairwiseBucketWeightPriorReg,
+    NPar::TLocalExecutor* localExecutor,
     TVector<TScoreBin>* scoreBins
 );
 
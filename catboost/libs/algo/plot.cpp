@@ -140,11 +140,21 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::FinishProceedDataSetForAdditiveMetrics()
     if (LastGroupPool.Docs.GetDocCount() != 0) {
         ProceedDataSet(LastGroupPool, 0, Iterations.ysize(), /*isProcessBoundaryGroups=*/false, /*isAdditiveMetrics=*/true);
     }
+    if (UseMetricSketches && HasNonAdditiveMetric()) {
+        FinishMetricSketches();
+    }
     return *this;
 }
 
 TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSetForNonAdditiveMetrics(const TPool& pool) {
     CheckModelAndPoolCompatibility(Model, pool);
+    if (UseMetricSketches) {
+        // otherwise sketches are filled in the pass for additive metrics
+        if (!HasAdditiveMetric()) {
+            ProceedDataSet(pool, 0, Iterations.size(), /*isProcessBoundaryGroups=*/false, /*isAdditiveMetrics=*/false);
+        }
+        return *this;
+    }
     if (ProcessedIterationsCount == 0) {
         const ui32 newPoolSize = NonAdditiveMetricsData.Target.size() + pool.Docs.Target.size();
         NonAdditiveMetricsData.Target.reserve(newPoolSize);
@@ -159,6 +169,12 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSetForNonAdditiveMetrics(cons
 }
 
 TMetricsPlotCalcer& TMetricsPlotCalcer::FinishProceedDataSetForNonAdditiveMetrics() {
+    if (UseMetricSketches) {
+        if (!AreAllIterationsProcessed()) {
+            FinishMetricSketches();
+        }
+        return *this;
+    }
     ui32 begin = ProcessedIterationsCount;
     ui32 end = Min<ui32>(ProcessedIterationsCount + ProcessedIterationsStep, Iterations.size());
     ComputeNonAdditiveMetrics(begin, end);
@@ -212,6 +228,7 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSet(
     UpdateQueriesInfo(pool.Docs.QueryId, groupWeight, pool.Docs.SubgroupId, 0, pool.Docs.GetDocCount(), &queriesInfo);
     UpdateQueriesPairs(pool.Pairs, 0, pool.Pairs.ysize(), /*invertedPermutation=*/{}, &queriesInfo);
     const ui32 docCount = pool.Docs.GetDocCount();
+    const bool isSketchPass = UseMetricSketches && HasNonAdditiveMetric() && (isAdditiveMetrics || !HasAdditiveMetric());
     ResizeApproxBuffer(Model.ObliviousTrees.ApproxDimension, docCount, &CurApproxBuffer);
 
     ui32 begin, end;
@@ -228,9 +245,12 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSet(
         Append(NextApproxBuffer, &CurApproxBuffer);
         if (isAdditiveMetrics) {
             ComputeAdditiveMetric(CurApproxBuffer, pool.Docs.Target, pool.Docs.Weight, queriesInfo, iterationIndex);
-        } else {
+        } else if (!UseMetricSketches) {
             SaveApproxToFile(iterationIndex, CurApproxBuffer);
         }
+        if (isSketchPass) {
+            AddToMetricSketches(CurApproxBuffer, pool, iterationIndex);
+        }
         begin = end;
     }
     ClearApproxBuffer(&CurApproxBuffer);
@@ -253,46 +273,97 @@ void TMetricsPlotCalcer::ComputeNonAdditiveMetrics(ui32 begin, ui32 end) {
     }
 }
 
-static int GetDocCount(const TVector<TPool>& poolParts) {
+bool TMetricsPlotCalcer::SetUseMetricSketches(bool flag) {
+    CB_ENSURE(ProcessedIterationsCount == 0, "Metric sketches should be set up before processing of the data");
+    UseMetricSketches = false;
+    NonAdditiveMetricSketches.clear();
+    if (!flag) {
+        return true;
+    }
+    TVector<TVector<THolder<IMetricSketch>>> sketches(NonAdditiveMetrics.size());
+    for (ui32 metricId = 0; metricId < NonAdditiveMetrics.size(); ++metricId) {
+        for (ui32 idx = 0; idx < Iterations.size(); ++idx) {
+            sketches[metricId].push_back(NonAdditiveMetrics[metricId]->CreateSketch());
+            if (!sketches[metricId].back()) {
+                return false;
+            }
+        }
+    }
+    NonAdditiveMetricSketches = std::move(sketches);
+    UseMetricSketches = true;
+    return true;
+}
+
+void TMetricsPlotCalcer::AddToMetricSketches(const TVector<TVector<double>>& approx, const TPool& pool, ui32 plotLineIndex) {
+    const int docCount = pool.Docs.GetDocCount();
+    for (ui32 metricId = 0; metricId < NonAdditiveMetrics.size(); ++metricId) {
+        NonAdditiveMetricSketches[metricId][plotLineIndex]->Add(approx, pool.Docs.Target, pool.Docs.Weight, 0, docCount);
+    }
+}
+
+void TMetricsPlotCalcer::FinishMetricSketches() {
+    for (ui32 metricId = 0; metricId < NonAdditiveMetrics.size(); ++metricId) {
+        for (ui32 idx = 0; idx < Iterations.size(); ++idx) {
+            NonAdditiveMetricPlots[metricId][idx] = NonAdditiveMetricSketches[metricId][idx]->GetResult();
+        }
+    }
+    NonAdditiveMetricSketches.clear();
+    ProcessedIterationsCount = Iterations.size();
+}
+
+static int GetDocCount(TConstArrayRef<const TPool*> poolParts) {
     int answer = 0;
-    for (const auto& pool : poolParts) {
-        answer += pool.Docs.GetDocCount();
+    for (const TPool* pool : poolParts) {
+        answer += pool->Docs.GetDocCount();
     }
     return answer;
 }
 
-static TVector<float> BuildTargets(const TVector<TPool>& poolParts) {
+static TVector<float> BuildTargets(TConstArrayRef<const TPool*> poolParts) {
     TVector<float> result;
     result.reserve(GetDocCount(poolParts));
-    for (const auto& pool : poolParts) {
-        result.insert(result.end(), pool.Docs.Target.begin(), pool.Docs.Target.end());
+    for (const TPool* pool : poolParts) {
+        result.insert(result.end(), pool->Docs.Target.begin(), pool->Docs.Target.end());
     }
     return result;
 }
 
-static TVector<float> BuildWeights(const TVector<TPool>& poolParts) {
+static TVector<float> BuildWeights(TConstArrayRef<const TPool*> poolParts) {
     TVector<float> result;
     result.reserve(GetDocCount(poolParts));
-    for (const auto& pool : poolParts) {
-        result.insert(result.end(), pool.Docs.Weight.begin(), pool.Docs.Weight.end());
+    for (const TPool* pool : poolParts) {
+        result.insert(result.end(), pool->Docs.Weight.begin(), pool->Docs.Weight.end());
     }
     return result;
 }
 
-static TVector<int> GetStartDocIdx(const TVector<TPool>& poolParts) {
+static TVector<int> GetStartDocIdx(TConstArrayRef<const TPool*> poolParts) {
     TVector<int> result;
     result.reserve(poolParts.size());
     int start = 0;
-    for (const auto& pool : poolParts) {
+    for (const TPool* pool : poolParts) {
         result.push_back(start);
-        start += pool.Docs.GetDocCount();
+        start += pool->Docs.GetDocCount();
     }
     return result;
 }
 
 void TMetricsPlotCalcer::ComputeNonAdditiveMetrics(const TVector<TPool>& datasetParts) {
+    TVector<const TPool*> poolParts;
     for (const auto& pool : datasetParts) {
-        CheckModelAndPoolCompatibility(Model, pool);
+        poolParts.push_back(&pool);
+    }
+    ComputeNonAdditiveMetrics(poolParts);
+}
+
+void TMetricsPlotCalcer::ComputeNonAdditiveMetrics(const TPool& pool) {
+    const TPool* poolPtr = &pool;
+    ComputeNonAdditiveMetrics(MakeArrayRef(&poolPtr, 1));
+}
+
+void TMetricsPlotCalcer::ComputeNonAdditiveMetrics(TConstArrayRef<const TPool*> datasetParts) {
+    for (const TPool* pool : datasetParts) {
+        CheckModelAndPoolCompatibility(Model, *pool);
     }
     TVector<float> allTargets = BuildTargets(datasetParts);
     TVector<float> allWeights = BuildWeights(datasetParts);
@@ -302,8 +373,8 @@ void TMetricsPlotCalcer::ComputeNonAdditiveMetrics(const TVector<TPool>& dataset
 
     int begin = 0;
     TVector<TModelCalcerOnPool> modelCalcers;
-    for (const auto& pool : datasetParts) {
-        modelCalcers.emplace_back(Model, pool, Executor);
+    for (const TPool* pool : datasetParts) {
+        modelCalcers.emplace_back(Model, *pool, Executor);
     }
 
     auto startDocIdx = GetStartDocIdx(datasetParts);
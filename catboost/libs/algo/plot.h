@@ -8,6 +8,7 @@
 #include <catboost/libs/model/model.h>
 #include <catboost/libs/loggers/logger.h>
 
+#include <util/generic/array_ref.h>
 #include <util/string/builder.h>
 #include <util/generic/guid.h>
 #include <util/system/fs.h>
@@ -28,6 +29,12 @@ public:
         DeleteTmpDirOnExitFlag = flag;
     }
 
+    /* Non-additive metrics are evaluated approximately by sketches in the same pass over the data
+     * as additive metrics (or in a single pass if there're no additive metrics) instead of saving
+     * approxes of each plot point to TmpDir. Returns false if some of the metrics don't support sketches.
+     */
+    bool SetUseMetricSketches(bool flag);
+
     bool HasAdditiveMetric() const {
         return !AdditiveMetrics.empty();
     }
@@ -46,6 +53,7 @@ public:
     TMetricsPlotCalcer& FinishProceedDataSetForNonAdditiveMetrics();
 
     void ComputeNonAdditiveMetrics(const TVector<TPool>& datasetParts);
+    void ComputeNonAdditiveMetrics(const TPool& pool);
 
     TMetricsPlotCalcer& SaveResult(const TString& resultDir, const TString& metricsFile, bool saveMetrics, bool saveStats);
     TVector<TVector<double>> GetMetricsScore();
@@ -98,6 +106,10 @@ private:
     }
 
     void ComputeNonAdditiveMetrics(ui32 begin, ui32 end);
+    void ComputeNonAdditiveMetrics(TConstArrayRef<const TPool*> datasetParts);
+
+    void AddToMetricSketches(const TVector<TVector<double>>& approx, const TPool& pool, ui32 plotLineIndex);
+    void FinishMetricSketches();
 
     void ComputeAdditiveMetric(
         const TVector<TVector<double>>& approx,
@@ -180,6 +192,8 @@ private:
     THolder<IInputStream> LastApproxes;
 
     TNonAdditiveMetricData NonAdditiveMetricsData;
+    bool UseMetricSketches = false;
+    TVector<TVector<THolder<IMetricSketch>>> NonAdditiveMetricSketches; // [metricId][plotLineIndex]
 
     TPool LastGroupPool;
 
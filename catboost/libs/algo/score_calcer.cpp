@@ -146,7 +146,7 @@ inline static void BuildSingleIndex(
 ) {
     if (split.Type == ESplitType::OnlineCtr) {
         const TCtr& ctr = split.Ctr;
-        const size_t* docSubset = GetDataPtr(fold.IndexInFold);
+        const size_t* docSubset = fold.GetIndexInFoldDocSubset();
         SetSingleIndex(
             fold,
             indexer,
@@ -156,23 +156,23 @@ inline static void BuildSingleIndex(
             singleIdx
         );
     } else if (split.Type == ESplitType::FloatFeature) {
-        const size_t* learnPermutation = GetDataPtr(fold.LearnPermutation);
+        const size_t* docSubset = fold.GetLearnFeaturesDocSubset();
         SetSingleIndex(
             fold,
             indexer,
-            af.FloatHistograms[split.FeatureIdx],
-            learnPermutation,
+            fold.GetLearnFeatures(af).FloatHistograms[split.FeatureIdx],
+            docSubset,
             docIndexRange,
             singleIdx
         );
     } else {
         Y_ASSERT(split.Type == ESplitType::OneHotFeature);
-        const size_t* learnPermutation = GetDataPtr(fold.LearnPermutation);
+        const size_t* docSubset = fold.GetLearnFeaturesDocSubset();
         SetSingleIndex(
             fold,
             indexer,
-            af.CatFeaturesRemapped[split.FeatureIdx],
-            learnPermutation,
+            fold.GetLearnFeatures(af).CatFeaturesRemapped[split.FeatureIdx],
+            docSubset,
             docIndexRange,
             singleIdx
         );
@@ -367,9 +367,7 @@ static void CalcStatsImpl(
             output->PairWeightStatistics.Swap(pairWeightStatistics);
         },
         /*mergeFunc*/[&](TPairwiseStats* output, TVector<TPairwiseStats>&& addVector) {
-            for (const auto& addItem : addVector) {
-                output->Add(addItem);
-            }
+            output->Add(addVector, localExecutor);
         },
         stats
     );
@@ -753,6 +751,7 @@ void CalcStatsAndScores(
                 split.Type,
                 l2Regularizer,
                 pairwiseBucketWeightPriorReg,
+                localExecutor,
                 scoreBins
             );
         }
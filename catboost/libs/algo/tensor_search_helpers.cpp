@@ -2,6 +2,8 @@
 
 #include <catboost/libs/helpers/restorable_rng.h>
 
+#include <util/generic/algorithm.h>
+
 static void GenerateRandomWeights(
     int learnSampleCount,
     float baggingTemperature,
@@ -28,6 +30,71 @@ static void GenerateRandomWeights(
     }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
+void GenerateGossWeights(
+    const TVector<TVector<double>>& weightedDerivatives,
+    float largeGradientFraction,
+    float takenFraction,
+    NPar::TLocalExecutor* localExecutor,
+    TRestorableFastRng64* rand,
+    TArrayRef<float> sampleWeights
+) {
+    const int learnSampleCount = sampleWeights.size();
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, learnSampleCount);
+    blockParams.SetBlockSize(1000);
+
+    TVector<float> gradientNorms;
+    gradientNorms.yresize(learnSampleCount);
+    float* gradientNormsData = gradientNorms.data();
+    localExecutor->ExecRange([&](int blockIdx) {
+        NPar::TLocalExecutor::BlockedLoopBody(blockParams, [&](int i) {
+            double norm = 0;
+            for (const auto& derivatives : weightedDerivatives) {
+                norm += Sqr(derivatives[i]);
+            }
+            gradientNormsData[i] = norm;
+        })(blockIdx);
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    const int largeGradientCount = Min(learnSampleCount, Max(1, static_cast<int>(largeGradientFraction * learnSampleCount)));
+    TVector<float> sortedNorms(gradientNorms);
+    const auto thresholdIt = sortedNorms.begin() + (learnSampleCount - largeGradientCount);
+    NthElement(sortedNorms.begin(), thresholdIt, sortedNorms.end());
+    const float threshold = *thresholdIt;
+    // all objects above the threshold are large, the rest of large ones are chosen among the tied with it
+    const int greaterCount = CountIf(thresholdIt, sortedNorms.end(), [=](float norm) { return norm > threshold; });
+    const int tiedCount = Count(sortedNorms.begin(), sortedNorms.end(), threshold);
+    sortedNorms = TVector<float>();
+
+    const ui64 randSeed = rand->GenRand();
+    const float smallGradientWeight = 1.0f / takenFraction;
+    localExecutor->ExecRange([&](int blockIdx) {
+        TRestorableFastRng64 rand(randSeed + blockIdx);
+        rand.Advance(10); // reduce correlation between RNGs in different threads
+        float* sampleWeightsData = sampleWeights.data();
+        NPar::TLocalExecutor::BlockedLoopBody(blockParams, [=,&rand](int i) {
+            if (gradientNormsData[i] > threshold) {
+                sampleWeightsData[i] = 1.0f;
+            } else {
+                sampleWeightsData[i] = rand.GenRandReal1() < takenFraction ? smallGradientWeight : 0.0f;
+            }
+        })(blockIdx);
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    // uniform choice of exactly largeGradientCount - greaterCount tied objects by selection sampling,
+    // otherwise all objects of losses with constant gradient norms (e.g. MAE) would be large
+    int tiedToTake = largeGradientCount - greaterCount;
+    int tiedLeft = tiedCount;
+    for (int i = 0; i < learnSampleCount && tiedToTake > 0; ++i) {
+        if (gradientNormsData[i] == threshold) {
+            if (rand->GenRandReal2() * tiedLeft < tiedToTake) {
+                sampleWeights[i] = 1.0f;
+                --tiedToTake;
+            }
+            --tiedLeft;
+        }
+    }
+}
+
 static void GenerateBayesianWeightsForPairs(
     float baggingTemperature,
     NPar::TLocalExecutor* localExecutor,
@@ -153,6 +220,18 @@ void Bootstrap(
                 GenerateRandomWeights(learnSampleCount, baggingTemperature, localExecutor, rand, fold);
             }
             break;
+        case EBootstrapType::GOSS:
+            CB_ENSURE(!isPairwiseScoring, "GOSS bootstrap is not supported for pairwise scoring");
+            Y_ASSERT(fold->BodyTailArr.ysize() == 1 && fold->BodyTailArr[0].BodyFinish == learnSampleCount);
+            GenerateGossWeights(
+                fold->BodyTailArr[0].WeightedDerivatives,
+                params.ObliviousTreeOptions->BootstrapConfig->GetLargeGradientFraction(),
+                takenFraction,
+                localExecutor,
+                rand,
+                fold->SampleWeights
+            );
+            break;
         case EBootstrapType::No:
             if (!isPairwiseScoring) {
                 Fill(fold->SampleWeights.begin(), fold->SampleWeights.end(), 1);
@@ -164,7 +243,17 @@ void Bootstrap(
     if (!isPairwiseScoring) {
         CalcWeightedData(learnSampleCount, params.BoostingOptions->BoostingType.Get(), localExecutor, fold);
     }
-    sampledDocs->Sample(*fold, indices, rand, localExecutor);
+    // the scan for zero sample weights is skipped if only user weights could make them zero and there are none
+    const bool hasZeroSampleWeights = !IsIn({EBootstrapType::Bernoulli, EBootstrapType::Bayesian, EBootstrapType::No}, bootstrapType)
+        || !fold->GetLearnWeights().empty();
+    sampledDocs->Sample(
+        *fold,
+        indices,
+        IsPlainMode(params.BoostingOptions->BoostingType.Get()),
+        hasZeroSampleWeights,
+        rand,
+        localExecutor
+    );
 }
 
 void SetBestScore(
@@ -10,6 +10,7 @@
 
 #include <catboost/libs/options/enums.h>
 
+#include <util/generic/array_ref.h>
 #include <util/generic/vector.h>
 
 #include <library/binsaver/bin_saver.h>
@@ -64,6 +65,19 @@ void Bootstrap(const NCatboostOptions::TCatBoostOptions& params,
                NPar::TLocalExecutor* localExecutor,
                TRestorableFastRng64* rand);
 
+/* Gradient-based one-side sampling: objects with the largest squared norms of weightedDerivatives ([dim][objectIdx])
+ * are kept with unit weight, the rest are taken with probability takenFraction and weight 1 / takenFraction.
+ * Exactly max(1, largeGradientFraction * objectCount) objects are large, ties with the smallest large norm are broken randomly.
+ */
+void GenerateGossWeights(
+    const TVector<TVector<double>>& weightedDerivatives,
+    float largeGradientFraction,
+    float takenFraction,
+    NPar::TLocalExecutor* localExecutor,
+    TRestorableFastRng64* rand,
+    TArrayRef<float> sampleWeights
+);
+
 template <typename TError>
 TError BuildError(const NCatboostOptions::TCatBoostOptions& params, const TMaybe<TCustomObjectiveDescriptor>&) {
     return TError(IsStoreExpApprox(params.LossFunctionDescription->GetLossFunction()));
@@ -92,6 +106,11 @@ inline void CalcWeightedDerivatives(
 ) {
     TFold::TBodyTail& bt = takenFold->BodyTailArr[bodyTailIdx];
     const TVector<TVector<double>>& approx = bt.Approx;
+    // pending approx deltas are applied by blocks right before derivatives of the block are calculated
+    const bool applyPendingApproxDelta = bt.HasPendingApproxDelta && error.GetErrorType() == EErrorType::PerObjectError;
+    if (!applyPendingApproxDelta) {
+        bt.ApplyPendingApproxDelta(TError::StoreExpApprox, localExecutor);
+    }
     const TVector<float>& target = takenFold->LearnTarget;
     const TVector<float>& weight = takenFold->GetLearnWeights();
     TVector<TVector<double>>* weightedDerivatives = &bt.WeightedDerivatives;
@@ -119,11 +138,14 @@ inline void CalcWeightedDerivatives(
         const int tailFinish = bt.TailFinish;
         const int approxDimension = approx.ysize();
         NPar::TLocalExecutor::TExecRangeParams blockParams(0, tailFinish);
-        blockParams.SetBlockSize(1000);
+        blockParams.SetBlockSize(TFold::TBodyTail::PendingApproxDeltaBlockSize);
 
         Y_ASSERT(error.GetErrorType() == EErrorType::PerObjectError);
         if (approxDimension == 1) {
             localExecutor->ExecRange([&](int blockId) {
+                if (applyPendingApproxDelta) {
+                    bt.ApplyPendingApproxDeltaBlock<TError::StoreExpApprox>(blockId);
+                }
                 const int blockOffset = blockId * blockParams.GetBlockSize();
                 error.CalcFirstDerRange(blockOffset, Min<int>(blockParams.GetBlockSize(), tailFinish - blockOffset),
                     approx[0].data(),
@@ -134,19 +156,18 @@ inline void CalcWeightedDerivatives(
             }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
         } else {
             localExecutor->ExecRange([&](int blockId) {
-                TVector<double> curApprox(approxDimension);
-                TVector<double> curDelta(approxDimension);
-                NPar::TLocalExecutor::BlockedLoopBody(blockParams, [&](int z) {
-                    for (int dim = 0; dim < approxDimension; ++dim) {
-                        curApprox[dim] = approx[dim][z];
-                    }
-                    error.CalcDersMulti(curApprox, target[z], weight.empty() ? 1 : weight[z], &curDelta, nullptr);
-                    for (int dim = 0; dim < approxDimension; ++dim) {
-                        (*weightedDerivatives)[dim][z] = curDelta[dim];
-                    }
-                })(blockId);
+                if (applyPendingApproxDelta) {
+                    bt.ApplyPendingApproxDeltaBlock<TError::StoreExpApprox>(blockId);
+                }
+                const int blockOffset = blockId * blockParams.GetBlockSize();
+                error.CalcFirstDerMultiRange(blockOffset, Min<int>(blockParams.GetBlockSize(), tailFinish - blockOffset),
+                    approx,
+                    target.data(),
+                    weight.data(),
+                    weightedDerivatives);
             }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
         }
+        bt.HasPendingApproxDelta = false;
     }
 }
 
@@ -162,14 +183,21 @@ inline void UpdateBodyTailApprox(const TVector<TVector<TVector<double>>>& approx
         for (int dim = 0; dim < approxDimension; ++dim) {
             const double* approxDeltaData = approxDelta[bodyTailId][dim].data();
             double* approxData = bt.Approx[dim].data();
+            const int tailFinish = bt.TailFinish;
+            NPar::TLocalExecutor::TExecRangeParams blockParams(0, tailFinish);
+            blockParams.SetBlockSize(1000);
             localExecutor->ExecRange(
-                [=](int z) {
-                    approxData[z] = UpdateApprox<StoreExpApprox>(
-                        approxData[z],
-                        ApplyLearningRate<StoreExpApprox>(approxDeltaData[z], learningRate)
+                [=](int blockId) {
+                    const int blockOffset = blockId * blockParams.GetBlockSize();
+                    UpdateApproxRange<StoreExpApprox>(
+                        approxDeltaData + blockOffset,
+                        learningRate,
+                        Min(blockParams.GetBlockSize(), tailFinish - blockOffset),
+                        approxData + blockOffset
                     );
                 },
-                NPar::TLocalExecutor::TExecRangeParams(0, bt.TailFinish).SetBlockSize(1000),
+                0,
+                blockParams.GetBlockCount(),
                 NPar::TLocalExecutor::WAIT_COMPLETE
             );
         }
@@ -45,7 +45,12 @@ void UpdateLearningFold(
     TFold* fold,
     TLearnContext* ctx
 ) {
-    TVector<TVector<TVector<double>>> approxDelta;
+    TVector<TVector<TVector<double>>> approxDelta(fold->BodyTailArr.ysize());
+    for (int bodyTailId = 0; bodyTailId < fold->BodyTailArr.ysize(); ++bodyTailId) {
+        TFold::TBodyTail& bt = fold->BodyTailArr[bodyTailId];
+        bt.ApplyPendingApproxDelta(TError::StoreExpApprox, &ctx->LocalExecutor);
+        approxDelta[bodyTailId].swap(bt.PendingApproxDelta); // reuse buffers of the previous tree
+    }
 
     CalcApproxForLeafStruct(
         learnData,
@@ -58,7 +63,13 @@ void UpdateLearningFold(
         &approxDelta
     );
 
-    UpdateBodyTailApprox<TError::StoreExpApprox>(approxDelta, ctx->Params.BoostingOptions->LearningRate, &ctx->LocalExecutor, fold);
+    // approx is updated lazily, derivatives calculation of the next iteration applies deltas in the same pass
+    for (int bodyTailId = 0; bodyTailId < fold->BodyTailArr.ysize(); ++bodyTailId) {
+        TFold::TBodyTail& bt = fold->BodyTailArr[bodyTailId];
+        bt.PendingApproxDelta.swap(approxDelta[bodyTailId]);
+        bt.PendingLearningRate = ctx->Params.BoostingOptions->LearningRate;
+        bt.HasPendingApproxDelta = true;
+    }
 }
 
 template <typename TError>
@@ -150,6 +161,8 @@ void UpdateAveragingFold(
             }
         }, 0, 1 + testDataPtrs.ysize(), NPar::TLocalExecutor::WAIT_COMPLETE);
     }
+    indices.resize(learnSampleCount);
+    ctx->AddLearnApproxChanges(*treeValues, std::move(indices));
 }
 
 template <typename TError>
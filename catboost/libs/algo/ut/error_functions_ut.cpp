@@ -0,0 +1,218 @@
+#include <library/unittest/registar.h>
+#include <catboost/libs/algo/approx_util.h>
+#include <catboost/libs/algo/error_functions.h>
+
+#include <util/random/fast.h>
+
+static constexpr int DOC_COUNT = 37;
+
+namespace {
+    struct TCustomObjectiveCalls {
+        int DersMultiCalls = 0;
+        int DersMultiRangeCalls = 0;
+    };
+}
+
+// derivatives of the MultiClass loss, so that results can be compared with TMultiClassError
+static void CalcMultiClassDersMulti(
+    const TVector<double>& approx,
+    float target,
+    float weight,
+    TVector<double>* der,
+    THessianInfo* der2,
+    void* customData
+) {
+    ++static_cast<TCustomObjectiveCalls*>(customData)->DersMultiCalls;
+    TMultiClassError(/*storeExpApprox*/ false).CalcDersMulti(approx, target, weight, der, der2);
+}
+
+static void CalcMultiClassDersMultiRange(
+    int count,
+    int approxDimension,
+    const double* approxes,
+    const float* targets,
+    const float* weights,
+    double* ders,
+    double* der2,
+    void* customData
+) {
+    ++static_cast<TCustomObjectiveCalls*>(customData)->DersMultiRangeCalls;
+    UNIT_ASSERT(der2 == nullptr);
+    TMultiClassError(/*storeExpApprox*/ false).CalcDersMultiRange(count, approxDimension, approxes, targets, weights, ders, der2);
+}
+
+template <typename TError>
+static void CheckDersArraysMatchDers(const TError& error, bool useWeights, bool useDeltas) {
+    TFastRng64 rand(0);
+    TVector<double> approxes(DOC_COUNT);
+    TVector<double> approxDeltas(DOC_COUNT);
+    TVector<float> targets(DOC_COUNT);
+    TVector<float> weights(DOC_COUNT);
+    for (int i = 0; i < DOC_COUNT; ++i) {
+        approxes[i] = TError::StoreExpApprox ? 0.1 + rand.GenRandReal1() : rand.GenRandReal1() - 0.5;
+        approxDeltas[i] = TError::StoreExpApprox ? 0.5 + rand.GenRandReal1() : rand.GenRandReal1() - 0.5;
+        targets[i] = rand.GenRandReal1() > 0.5;
+        weights[i] = rand.GenRandReal1();
+    }
+
+    TVector<TDers> ders(DOC_COUNT);
+    TVector<double> der1(DOC_COUNT), der2(DOC_COUNT), der3(DOC_COUNT);
+    const double* approxDeltasData = useDeltas ? approxDeltas.data() : nullptr;
+    const float* weightsData = useWeights ? weights.data() : nullptr;
+    error.CalcDersRange(0, DOC_COUNT, /*calcThirdDer*/ true, approxes.data(), approxDeltasData, targets.data(), weightsData, ders.data());
+    error.CalcDersRange(0, DOC_COUNT, /*calcThirdDer*/ true, approxes.data(), approxDeltasData, targets.data(), weightsData, TDersArrays{der1.data(), der2.data(), der3.data()});
+    for (int i = 0; i < DOC_COUNT; ++i) {
+        UNIT_ASSERT_DOUBLES_EQUAL(ders[i].Der1, der1[i], 1e-12);
+        UNIT_ASSERT_DOUBLES_EQUAL(ders[i].Der2, der2[i], 1e-12);
+        UNIT_ASSERT_DOUBLES_EQUAL(ders[i].Der3, der3[i], 1e-12);
+    }
+}
+
+template <typename TError>
+static void CheckDersArraysMatchDers(const TError& error) {
+    for (bool useWeights : {false, true}) {
+        for (bool useDeltas : {false, true}) {
+            CheckDersArraysMatchDers(error, useWeights, useDeltas);
+        }
+    }
+}
+
+Y_UNIT_TEST_SUITE(ErrorFunctionsTest) {
+    Y_UNIT_TEST(DersArraysMatchDers) {
+        CheckDersArraysMatchDers(TRMSEError(/*storeExpApprox*/ false));
+        CheckDersArraysMatchDers(TQuantileError(/*alpha*/ 0.3, /*storeExpApprox*/ false));
+        CheckDersArraysMatchDers(TCrossEntropyError(/*storeExpApprox*/ true));
+        CheckDersArraysMatchDers(TPoissonError(/*storeExpApprox*/ true));
+    }
+
+    Y_UNIT_TEST(UpdateApproxRangeMatchesUpdateApprox) {
+        TFastRng64 rand(0);
+        TVector<double> approxDeltas(DOC_COUNT);
+        TVector<double> initialApproxes(DOC_COUNT);
+        for (int i = 0; i < DOC_COUNT; ++i) {
+            approxDeltas[i] = 0.5 + rand.GenRandReal1();
+            initialApproxes[i] = 0.1 + rand.GenRandReal1();
+        }
+        const double learningRate = 0.03;
+        TVector<double> approxes = initialApproxes;
+        TVector<double> expApproxes = initialApproxes;
+        UpdateApproxRange</*StoreExpApprox*/ false>(approxDeltas.data(), learningRate, DOC_COUNT, approxes.data());
+        UpdateApproxRange</*StoreExpApprox*/ true>(approxDeltas.data(), learningRate, DOC_COUNT, expApproxes.data());
+        for (int i = 0; i < DOC_COUNT; ++i) {
+            UNIT_ASSERT_VALUES_EQUAL(
+                approxes[i],
+                UpdateApprox</*StoreExpApprox*/ false>(initialApproxes[i], ApplyLearningRate</*StoreExpApprox*/ false>(approxDeltas[i], learningRate))
+            );
+            UNIT_ASSERT_VALUES_EQUAL(
+                expApproxes[i],
+                UpdateApprox</*StoreExpApprox*/ true>(initialApproxes[i], ApplyLearningRate</*StoreExpApprox*/ true>(approxDeltas[i], learningRate))
+            );
+        }
+    }
+
+    Y_UNIT_TEST(MultiClassFirstDerRangeMatchesDersMulti) {
+        constexpr int approxDimension = 3;
+        TFastRng64 rand(0);
+        TVector<TVector<double>> approx(approxDimension, TVector<double>(DOC_COUNT));
+        TVector<float> targets(DOC_COUNT);
+        TVector<float> weights(DOC_COUNT);
+        for (int i = 0; i < DOC_COUNT; ++i) {
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                approx[dim][i] = 4 * rand.GenRandReal1() - 2;
+            }
+            targets[i] = rand.GenRand() % approxDimension;
+            weights[i] = rand.GenRandReal1();
+        }
+
+        const TMultiClassError error(/*storeExpApprox*/ false);
+        TVector<TVector<double>> ders(approxDimension, TVector<double>(DOC_COUNT));
+        error.CalcFirstDerMultiRange(/*start*/ 1, DOC_COUNT - 1, approx, targets.data(), weights.data(), &ders);
+
+        TVector<double> curApprox(approxDimension);
+        TVector<double> curDer(approxDimension);
+        for (int i = 1; i < DOC_COUNT; ++i) {
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                curApprox[dim] = approx[dim][i];
+            }
+            error.CalcDersMulti(curApprox, targets[i], weights[i], &curDer, nullptr);
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                UNIT_ASSERT_VALUES_EQUAL(ders[dim][i], curDer[dim]);
+            }
+        }
+    }
+
+    Y_UNIT_TEST(MultiClassDersMultiRangeMatchesDersMulti) {
+        constexpr int approxDimension = 3;
+        TFastRng64 rand(0);
+        TVector<double> approxes(DOC_COUNT * approxDimension);
+        TVector<float> targets(DOC_COUNT);
+        for (int i = 0; i < DOC_COUNT; ++i) {
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                approxes[i * approxDimension + dim] = 4 * rand.GenRandReal1() - 2;
+            }
+            targets[i] = rand.GenRand() % approxDimension;
+        }
+
+        const TMultiClassError error(/*storeExpApprox*/ false);
+        const int der2Size = THessianInfo(approxDimension, TMultiClassError::GetHessianType()).Data.ysize();
+        TVector<double> ders(DOC_COUNT * approxDimension);
+        TVector<double> der2(DOC_COUNT * der2Size);
+        error.CalcDersMultiRange(DOC_COUNT, approxDimension, approxes.data(), targets.data(), /*weights*/ nullptr, ders.data(), der2.data());
+
+        TVector<double> curApprox(approxDimension);
+        TVector<double> curDer(approxDimension);
+        THessianInfo curDer2(approxDimension, TMultiClassError::GetHessianType());
+        for (int i = 0; i < DOC_COUNT; ++i) {
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                curApprox[dim] = approxes[i * approxDimension + dim];
+            }
+            error.CalcDersMulti(curApprox, targets[i], /*weight*/ 1, &curDer, &curDer2);
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                UNIT_ASSERT_DOUBLES_EQUAL(ders[i * approxDimension + dim], curDer[dim], 1e-12);
+            }
+            for (int idx = 0; idx < der2Size; ++idx) {
+                UNIT_ASSERT_DOUBLES_EQUAL(der2[i * der2Size + idx], curDer2.Data[idx], 1e-12);
+            }
+        }
+    }
+
+    Y_UNIT_TEST(CustomFirstDerMultiRangeCallsRangeCallbackOnce) {
+        constexpr int approxDimension = 3;
+        TFastRng64 rand(0);
+        TVector<TVector<double>> approx(approxDimension, TVector<double>(DOC_COUNT));
+        TVector<float> targets(DOC_COUNT);
+        TVector<float> weights(DOC_COUNT);
+        for (int i = 0; i < DOC_COUNT; ++i) {
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                approx[dim][i] = 4 * rand.GenRandReal1() - 2;
+            }
+            targets[i] = rand.GenRand() % approxDimension;
+            weights[i] = rand.GenRandReal1();
+        }
+
+        TCustomObjectiveCalls calls;
+        TCustomObjectiveDescriptor descriptor;
+        descriptor.CustomData = &calls;
+        descriptor.CalcDersMulti = &CalcMultiClassDersMulti;
+        const NCatboostOptions::TCatBoostOptions params(ETaskType::CPU);
+        const TMultiClassError multiClassError(/*storeExpApprox*/ false);
+
+        for (bool hasRangeCallback : {true, false}) {
+            calls = TCustomObjectiveCalls();
+            descriptor.CalcDersMultiRange = hasRangeCallback ? &CalcMultiClassDersMultiRange : nullptr;
+            const TCustomError error(params, descriptor);
+            TVector<TVector<double>> ders(approxDimension, TVector<double>(DOC_COUNT));
+            error.CalcFirstDerMultiRange(/*start*/ 1, DOC_COUNT - 1, approx, targets.data(), weights.data(), &ders);
+            UNIT_ASSERT_VALUES_EQUAL(calls.DersMultiRangeCalls, hasRangeCallback ? 1 : 0);
+            UNIT_ASSERT_VALUES_EQUAL(calls.DersMultiCalls, hasRangeCallback ? 0 : DOC_COUNT - 1);
+
+            TVector<TVector<double>> expectedDers(approxDimension, TVector<double>(DOC_COUNT));
+            multiClassError.CalcFirstDerMultiRange(/*start*/ 1, DOC_COUNT - 1, approx, targets.data(), weights.data(), &expectedDers);
+            for (int i = 1; i < DOC_COUNT; ++i) {
+                for (int dim = 0; dim < approxDimension; ++dim) {
+                    UNIT_ASSERT_DOUBLES_EQUAL(ders[dim][i], expectedDers[dim][i], 1e-12);
+                }
+            }
+        }
+    }
+}
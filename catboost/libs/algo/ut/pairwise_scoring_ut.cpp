@@ -2,6 +2,8 @@
 #include <catboost/libs/algo/pairwise_scoring.h>
 #include <catboost/libs/algo/pairwise_leaves_calculation.h>
 
+#include <util/random/fast.h>
+
 static double CalculateScore(const TVector<double>& avrg, const TVector<double>& sumDer, const TArray2D<double>& sumWeights) {
     double score = 0;
     for (int x = 0; x < sumDer.ysize(); ++x) {
@@ -119,7 +121,7 @@ Y_UNIT_TEST_SUITE(PairwiseScoringTest) {
         TVector<TScoreBin> scoreBins1(bucketCount - 1), scoreBins2(bucketCount - 1);
         {
             TPairwiseStats pairwiseStats = CalcPairwiseStats(singleIdx, MakeArrayRef(ders.data(), ders.size()), queriesInfo, leafCount, bucketCount);
-            CalculatePairwiseScore(pairwiseStats, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &scoreBins1);
+            CalculatePairwiseScore(pairwiseStats, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &NPar::LocalExecutor(), &scoreBins1);
         }
         CalculatePairwiseScoreSimple(singleIdx, MakeArrayRef(ders.data(), ders.size()), queriesInfo, leafCount, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &scoreBins2);
 
@@ -156,7 +158,7 @@ Y_UNIT_TEST_SUITE(PairwiseScoringTest) {
         TVector<TScoreBin> scoreBins1(bucketCount - 1), scoreBins2(bucketCount - 1);
         {
             TPairwiseStats pairwiseStats = CalcPairwiseStats(singleIdx, MakeArrayRef(ders.data(), ders.size()), queriesInfo, leafCount, bucketCount);
-            CalculatePairwiseScore(pairwiseStats, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &scoreBins1);
+            CalculatePairwiseScore(pairwiseStats, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &NPar::LocalExecutor(), &scoreBins1);
         }
         CalculatePairwiseScoreSimple(singleIdx, MakeArrayRef(ders.data(), ders.size()), queriesInfo, leafCount, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &scoreBins2);
 
@@ -164,4 +166,51 @@ Y_UNIT_TEST_SUITE(PairwiseScoringTest) {
         UNIT_ASSERT_DOUBLES_EQUAL(scoreBins1[1].DP, scoreBins2[1].DP, 1e-6);
         UNIT_ASSERT_DOUBLES_EQUAL(scoreBins1[2].DP, scoreBins2[2].DP, 1e-6);
     }
+
+    Y_UNIT_TEST(PairwiseScoringTestManySplits) {
+        const int leafCount = 4;
+        const int bucketCount = 37;
+        const int docCount = 200;
+        TFastRng64 rand(0);
+        TVector<TIndexType> singleIdx(docCount);
+        TVector<double> ders(docCount);
+        for (int docId = 0; docId < docCount; ++docId) {
+            singleIdx[docId] = rand.GenRand() % (leafCount * bucketCount);
+            ders[docId] = rand.GenRandReal1() - 0.5;
+        }
+        TVector<TQueryInfo> queriesInfo = {{0, docCount}};
+        TVector<TVector<TCompetitor>>& comps = queriesInfo[0].Competitors;
+        comps.resize(docCount);
+        for (int pairIdx = 0; pairIdx < 3 * docCount; ++pairIdx) {
+            comps[rand.GenRand() % docCount].push_back({static_cast<int>(rand.GenRand() % docCount), 1});
+        }
+        const ESplitType splitType = ESplitType::FloatFeature;
+        const float l2DiagReg = 0.3;
+        const float pairwiseNonDiagReg = 0.1;
+
+        // stats of two halves merged in parallel should be the same as stats of the whole pool
+        TPairwiseStats pairwiseStats = CalcPairwiseStats(singleIdx, MakeArrayRef(ders.data(), ders.size()), queriesInfo, leafCount, bucketCount);
+        TPairwiseStats mergedStats;
+        mergedStats.DerSums = ComputeDerSums(MakeArrayRef(ders.data(), ders.size()), leafCount, bucketCount, singleIdx, NCB::TIndexRange<int>(0));
+        mergedStats.PairWeightStatistics = ComputePairWeightStatistics(queriesInfo, leafCount, bucketCount, singleIdx, NCB::TIndexRange<int>(0));
+        TVector<TPairwiseStats> parts(2);
+        parts[0].DerSums = ComputeDerSums(MakeArrayRef(ders.data(), ders.size()), leafCount, bucketCount, singleIdx, NCB::TIndexRange<int>(0, docCount / 2));
+        parts[1].DerSums = ComputeDerSums(MakeArrayRef(ders.data(), ders.size()), leafCount, bucketCount, singleIdx, NCB::TIndexRange<int>(docCount / 2, docCount));
+        parts[0].PairWeightStatistics = ComputePairWeightStatistics(queriesInfo, leafCount, bucketCount, singleIdx, NCB::TIndexRange<int>(1));
+        parts[1].PairWeightStatistics = ComputePairWeightStatistics(queriesInfo, leafCount, bucketCount, singleIdx, NCB::TIndexRange<int>(0));
+        mergedStats.Add(parts, &NPar::LocalExecutor());
+        for (int leafId = 0; leafId < leafCount; ++leafId) {
+            for (int bucketId = 0; bucketId < bucketCount; ++bucketId) {
+                UNIT_ASSERT_DOUBLES_EQUAL(mergedStats.DerSums[leafId][bucketId], pairwiseStats.DerSums[leafId][bucketId], 1e-9);
+            }
+        }
+
+        TVector<TScoreBin> scoreBins1(bucketCount - 1), scoreBins2(bucketCount - 1);
+        CalculatePairwiseScore(mergedStats, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &NPar::LocalExecutor(), &scoreBins1);
+        CalculatePairwiseScoreSimple(singleIdx, MakeArrayRef(ders.data(), ders.size()), queriesInfo, leafCount, bucketCount, splitType, l2DiagReg, pairwiseNonDiagReg, &scoreBins2);
+
+        for (int splitId = 0; splitId < bucketCount - 1; ++splitId) {
+            UNIT_ASSERT_DOUBLES_EQUAL(scoreBins1[splitId].DP, scoreBins2[splitId].DP, 1e-6);
+        }
+    }
 }
@@ -0,0 +1,55 @@
+#include <library/unittest/registar.h>
+#include <catboost/libs/algo/tensor_search_helpers.h>
+#include <catboost/libs/algo/error_functions.h>
+#include <catboost/libs/helpers/restorable_rng.h>
+
+#include <util/generic/algorithm.h>
+#include <util/random/fast.h>
+
+static int CountLarge(const TVector<float>& sampleWeights) {
+    return Count(sampleWeights.begin(), sampleWeights.end(), 1.0f);
+}
+
+Y_UNIT_TEST_SUITE(GossWeightsTest) {
+    // all derivatives of MAE have the same norm, GOSS should still keep only largeGradientFraction of them
+    Y_UNIT_TEST(GossWeightsConstantGradientNormsTest) {
+        const int docCount = 10000;
+        TReallyFastRng32 dataRng(0);
+        const TQuantileError error(/*storeExpApprox*/ false);
+        TVector<TVector<double>> weightedDerivatives(1);
+        for (int i = 0; i < docCount; ++i) {
+            weightedDerivatives[0].push_back(error.CalcDer(dataRng.GenRandReal1(), dataRng.GenRandReal1()));
+        }
+
+        NPar::TLocalExecutor executor;
+        executor.RunAdditionalThreads(3);
+        TRestorableFastRng64 rand(0);
+        TVector<float> sampleWeights(docCount);
+        GenerateGossWeights(weightedDerivatives, /*largeGradientFraction*/ 0.2f, /*takenFraction*/ 0.5f, &executor, &rand, sampleWeights);
+
+        UNIT_ASSERT_VALUES_EQUAL(CountLarge(sampleWeights), 2000);
+        for (float weight : sampleWeights) {
+            UNIT_ASSERT(weight == 0.0f || weight == 1.0f || weight == 2.0f);
+        }
+    }
+
+    // most of the derivatives are zero, so the threshold is zero too
+    Y_UNIT_TEST(GossWeightsZeroThresholdTest) {
+        const int docCount = 10000;
+        TVector<TVector<double>> weightedDerivatives(1, TVector<double>(docCount, 0.0));
+        for (int i = 0; i < docCount; i += 10) {
+            weightedDerivatives[0][i] = i % 20 ? 0.5 : -1.0;
+        }
+
+        NPar::TLocalExecutor executor;
+        executor.RunAdditionalThreads(3);
+        TRestorableFastRng64 rand(0);
+        TVector<float> sampleWeights(docCount);
+        GenerateGossWeights(weightedDerivatives, /*largeGradientFraction*/ 0.2f, /*takenFraction*/ 0.5f, &executor, &rand, sampleWeights);
+
+        UNIT_ASSERT_VALUES_EQUAL(CountLarge(sampleWeights), 2000);
+        for (int i = 0; i < docCount; i += 10) {
+            UNIT_ASSERT_VALUES_EQUAL(sampleWeights[i], 1.0f);
+        }
+    }
+}
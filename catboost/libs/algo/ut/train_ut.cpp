@@ -67,4 +67,63 @@ Y_UNIT_TEST_SUITE(TTrainTest) {
             }
         }
     }
+
+    // objects with zero weights are dropped from the score calculation, this must not change the model
+    Y_UNIT_TEST(TestZeroWeightObjectsDontChangeModel) {
+        const int docCount = 500;
+        const int factorCount = 5;
+        TReallyFastRng32 rng(0);
+        TPool pool;
+        pool.Docs.Resize(docCount, factorCount, /*baseline dimension*/ 0, /*has queryId*/ false, /*has subgroupId*/ false);
+        pool.MetaInfo.HasWeights = true;
+        for (int i = 0; i < docCount; ++i) {
+            for (int j = 0; j < factorCount; ++j) {
+                // few distinct values, so that borders don't depend on the added objects
+                pool.Docs.Factors[j][i] = rng.Uniform(8);
+            }
+            pool.Docs.Target[i] = pool.Docs.Factors[0][i] + rng.GenRandReal2();
+            pool.Docs.Weight[i] = 0.5 + rng.GenRandReal2();
+        }
+
+        // the same objects followed by as many objects with zero weights
+        TPool poolWithZeroWeights;
+        poolWithZeroWeights.Docs.Resize(2 * docCount, factorCount, /*baseline dimension*/ 0, /*has queryId*/ false, /*has subgroupId*/ false);
+        poolWithZeroWeights.MetaInfo.HasWeights = true;
+        for (int i = 0; i < docCount; ++i) {
+            poolWithZeroWeights.Docs.AssignDoc(i, pool.Docs, i);
+            poolWithZeroWeights.Docs.AssignDoc(docCount + i, pool.Docs, rng.Uniform(docCount));
+            poolWithZeroWeights.Docs.Target[docCount + i] = 10 * rng.GenRandReal2();
+            poolWithZeroWeights.Docs.Weight[docCount + i] = 0;
+        }
+
+        // l2 regularizer is scaled by sum of weights / object count, so it is doubled for twice as many objects
+        auto trainModel = [](TPool pool, double l2Regularizer) {
+            NJson::TJsonValue plainFitParams;
+            plainFitParams.InsertValue("iterations", 20);
+            plainFitParams.InsertValue("depth", 4);
+            plainFitParams.InsertValue("learning_rate", 0.1);
+            plainFitParams.InsertValue("l2_leaf_reg", l2Regularizer);
+            plainFitParams.InsertValue("has_time", true);
+            plainFitParams.InsertValue("boosting_type", "Plain");
+            plainFitParams.InsertValue("bootstrap_type", "No");
+            plainFitParams.InsertValue("random_strength", 0);
+            plainFitParams.InsertValue("thread_count", 1);
+            TFullModel model;
+            TEvalResult evalResult;
+            TPool testPool;
+            TrainModel(plainFitParams, Nothing(), Nothing(), TClearablePoolPtrs(pool, {&testPool}), "", &model, {&evalResult});
+            return model;
+        };
+        const TFullModel model = trainModel(pool, /*l2Regularizer*/ 2);
+        const TFullModel modelWithZeroWeights = trainModel(poolWithZeroWeights, /*l2Regularizer*/ 4);
+
+        const auto& trees = model.ObliviousTrees;
+        const auto& treesWithZeroWeights = modelWithZeroWeights.ObliviousTrees;
+        UNIT_ASSERT_EQUAL(trees.FloatFeatures, treesWithZeroWeights.FloatFeatures);
+        UNIT_ASSERT_EQUAL(trees.TreeSplits, treesWithZeroWeights.TreeSplits);
+        UNIT_ASSERT_VALUES_EQUAL(trees.LeafValues.size(), treesWithZeroWeights.LeafValues.size());
+        for (size_t i = 0; i < trees.LeafValues.size(); ++i) {
+            UNIT_ASSERT_DOUBLES_EQUAL(trees.LeafValues[i], treesWithZeroWeights.LeafValues[i], 1e-9);
+        }
+    }
 }
@@ -2,8 +2,23 @@
 
 #include <catboost/libs/data_types/pair.h>
 
+#include <util/generic/algorithm.h>
 #include <util/generic/vector.h>
 
+namespace {
+    struct TYetiRankPair {
+        ui64 WinnerLoser; // winner index in the high half, loser index in the low half
+        float Weight;
+    };
+
+    // reused for all queries of a block
+    struct TYetiRankPairsBuffers {
+        TVector<int> Indices;
+        TVector<double> BootstrappedApprox;
+        TVector<TYetiRankPair> Pairs;
+    };
+}
+
 static void GenerateYetiRankPairsForQuery(
     const float* relevs,
     const double* expApproxes,
@@ -12,22 +27,29 @@ static void GenerateYetiRankPairsForQuery(
     int permutationCount,
     double decaySpeed,
     ui64 randomSeed,
+    TYetiRankPairsBuffers* buffers,
     TVector<TVector<TCompetitor>>* competitors
 ) {
     TFastRng64 rand(randomSeed);
     TVector<TVector<TCompetitor>>& competitorsRef = *competitors;
-    competitorsRef.clear();
     competitorsRef.resize(querySize);
+    for (auto& docCompetitors : competitorsRef) {
+        docCompetitors.clear();
+    }
 
-    TVector<int> indices(querySize);
-    TVector<TVector<float>> competitorsWeights(querySize, TVector<float>(querySize));
+    TVector<int>& indices = buffers->Indices;
+    TVector<double>& bootstrappedApprox = buffers->BootstrappedApprox;
+    // only adjacent documents of each permutation make pairs, so there're at most querySize - 1 pairs per permutation
+    TVector<TYetiRankPair>& pairs = buffers->Pairs;
+    indices.yresize(querySize);
+    bootstrappedApprox.yresize(querySize);
+    pairs.clear();
     for (int permutationIndex = 0; permutationIndex < permutationCount; ++permutationIndex) {
         std::iota(indices.begin(), indices.end(), 0);
-        TVector<double> bootstrappedApprox(expApproxes, expApproxes + querySize);
         for (int docId = 0; docId < querySize; ++docId) {
             const float uniformValue = rand.GenRandReal1();
             // TODO(nikitxskv): try to experiment with different bootstraps.
-            bootstrappedApprox[docId] *= uniformValue / (1.000001f - uniformValue);
+            bootstrappedApprox[docId] = expApproxes[docId] * (uniformValue / (1.000001f - uniformValue));
         }
 
         Sort(indices, [&](int i, int j) {
@@ -42,37 +64,43 @@ static void GenerateYetiRankPairsForQuery(
 
             const float pairWeight = magicConst * decayCoefficient * Abs(relevs[firstCandidate] - relevs[secondCandidate]);
             if (relevs[firstCandidate] > relevs[secondCandidate]) {
-                competitorsWeights[firstCandidate][secondCandidate] += pairWeight;
+                pairs.push_back({(ui64(firstCandidate) << 32) | ui64(secondCandidate), pairWeight});
             } else if (relevs[firstCandidate] < relevs[secondCandidate]) {
-                competitorsWeights[secondCandidate][firstCandidate] += pairWeight;
+                pairs.push_back({(ui64(secondCandidate) << 32) | ui64(firstCandidate), pairWeight});
             }
             decayCoefficient *= decaySpeed;
         }
     }
 
-    // TODO(nikitxskv): Can be optimized
-    for (int winnerIndex = 0; winnerIndex < querySize; ++winnerIndex) {
-        for (int loserIndex = 0; loserIndex < querySize; ++loserIndex) {
-            const float competitorsWeight = queryWeight * competitorsWeights[winnerIndex][loserIndex] / permutationCount;
-            if (competitorsWeight != 0) {
-                competitorsRef[winnerIndex].push_back({loserIndex, competitorsWeight});
-            }
+    // stable sort keeps the order of permutations, so weights of a pair are summed in the same order as before
+    StableSort(pairs.begin(), pairs.end(), [](const TYetiRankPair& lhs, const TYetiRankPair& rhs) {
+        return lhs.WinnerLoser < rhs.WinnerLoser;
+    });
+    for (size_t pairIdx = 0; pairIdx < pairs.size();) {
+        const ui64 winnerLoser = pairs[pairIdx].WinnerLoser;
+        float pairWeight = 0;
+        for (; pairIdx < pairs.size() && pairs[pairIdx].WinnerLoser == winnerLoser; ++pairIdx) {
+            pairWeight += pairs[pairIdx].Weight;
+        }
+        const float competitorsWeight = queryWeight * pairWeight / permutationCount;
+        if (competitorsWeight != 0) {
+            const int winnerIndex = winnerLoser >> 32;
+            const int loserIndex = winnerLoser & 0xffffffffu;
+            competitorsRef[winnerIndex].push_back({loserIndex, competitorsWeight});
         }
     }
 }
 
-static void UpdatePairsForYetiRank(
+void UpdatePairsForYetiRank(
     const TVector<double>& approxes,
     const TVector<float>& relevances,
     int queryInfoSize,
-    const NCatboostOptions::TCatBoostOptions& params,
+    int permutationCount,
+    double decaySpeed,
     ui64 randomSeed,
     TVector<TQueryInfo>* queriesInfo,
     NPar::TLocalExecutor* localExecutor
 ) {
-    const int permutationCount = NCatboostOptions::GetYetiRankPermutations(params.LossFunctionDescription);
-    const double decaySpeed = NCatboostOptions::GetYetiRankDecay(params.LossFunctionDescription);
-
     NPar::TLocalExecutor::TExecRangeParams blockParams(0, queryInfoSize);
     blockParams.SetBlockCount(CB_THREAD_LIMIT);
     const int blockSize = blockParams.GetBlockSize();
@@ -80,6 +108,7 @@ static void UpdatePairsForYetiRank(
     const TVector<ui64> randomSeeds = GenRandUI64Vector(blockCount, randomSeed);
     NPar::ParallelFor(*localExecutor, 0, blockCount, [&](int blockId) {
         TFastRng64 rand(randomSeeds[blockId]);
+        TYetiRankPairsBuffers buffers;
         const int from = blockId * blockSize;
         const int to = Min<int>((blockId + 1) * blockSize, queryInfoSize);
         for (int queryIndex = from; queryIndex < to; ++queryIndex) {
@@ -92,6 +121,7 @@ static void UpdatePairsForYetiRank(
                 permutationCount,
                 decaySpeed,
                 rand.GenRand(),
+                &buffers,
                 &queryInfoRef.Competitors
             );
         }
@@ -112,7 +142,8 @@ void YetiRankRecalculation(
         bt.Approx[0],
         ff.LearnTarget,
         bt.TailQueryFinish,
-        params,
+        NCatboostOptions::GetYetiRankPermutations(params.LossFunctionDescription),
+        NCatboostOptions::GetYetiRankDecay(params.LossFunctionDescription),
         randomSeed,
         recalculatedQueriesInfo,
         localExecutor
@@ -2,6 +2,18 @@
 
 #include "learn_context.h"
 
+// generates YetiRank pairs (Competitors) for the first queryInfoSize queries
+void UpdatePairsForYetiRank(
+    const TVector<double>& approxes,
+    const TVector<float>& relevances,
+    int queryInfoSize,
+    int permutationCount,
+    double decaySpeed,
+    ui64 randomSeed,
+    TVector<TQueryInfo>* queriesInfo,
+    NPar::TLocalExecutor* localExecutor
+);
+
 void YetiRankRecalculation(
     const TFold& ff,
     const TFold::TBodyTail& bt,
@@ -0,0 +1,80 @@
+#include "columnar_pool.h"
+
+#include <catboost/libs/helpers/exception.h>
+
+#include <util/generic/cast.h>
+#include <util/generic/string.h>
+#include <util/generic/vector.h>
+#include <util/stream/output.h>
+#include <util/system/align.h>
+
+
+namespace NCB {
+
+    static ui64 GetColumnStride(ui64 docCount) {
+        return AlignUp<ui64>(docCount * sizeof(float), COLUMNAR_POOL_ALIGNMENT);
+    }
+
+    ui64 TColumnarPoolHeader::GetColumnOffset(ui32 columnIdx) const {
+        return DataOffset + GetColumnStride(DocCount) * columnIdx;
+    }
+
+
+    TColumnarPoolView::TColumnarPoolView(const TBlob& blob)
+        : Blob(blob)
+    {
+        CB_ENSURE(Blob.Size() >= sizeof(TColumnarPoolHeader), "Columnar pool: file is too small");
+        memcpy(&Header, Blob.AsCharPtr(), sizeof(TColumnarPoolHeader));
+        CB_ENSURE(Header.Magic == COLUMNAR_POOL_MAGIC, "Columnar pool: wrong magic");
+        CB_ENSURE(
+            Header.Version == COLUMNAR_POOL_VERSION,
+            "Columnar pool: unsupported version " << Header.Version
+        );
+        CB_ENSURE(Header.ColumnCount > 0, "Columnar pool: no columns");
+        CB_ENSURE(Header.DocCount > 0, "Columnar pool: no documents");
+        CB_ENSURE(
+            Header.DataOffset % COLUMNAR_POOL_ALIGNMENT == 0 && Header.DataOffset >= sizeof(TColumnarPoolHeader),
+            "Columnar pool: wrong data offset " << Header.DataOffset
+        );
+        CB_ENSURE(
+            Blob.Size() >= Header.GetColumnOffset(Header.ColumnCount - 1) + Header.DocCount * sizeof(float),
+            "Columnar pool: file is truncated"
+        );
+    }
+
+    TConstArrayRef<float> TColumnarPoolView::GetColumn(ui32 columnIdx) const {
+        CB_ENSURE(columnIdx < Header.ColumnCount, "Columnar pool: wrong column index " << columnIdx);
+        return MakeArrayRef(
+            reinterpret_cast<const float*>(Blob.AsCharPtr() + Header.GetColumnOffset(columnIdx)),
+            Header.DocCount
+        );
+    }
+
+    TColumnarPoolView LoadColumnarPool(const TString& path) {
+        return TColumnarPoolView(TBlob::FromFile(path));
+    }
+
+
+    void SaveColumnarPool(TConstArrayRef<TConstArrayRef<float>> columns, IOutputStream* output) {
+        CB_ENSURE(!columns.empty(), "Columnar pool: no columns");
+
+        TColumnarPoolHeader header;
+        header.ColumnCount = SafeIntegerCast<ui32>(columns.size());
+        header.DocCount = columns[0].size();
+        header.DataOffset = AlignUp<ui64>(sizeof(TColumnarPoolHeader), COLUMNAR_POOL_ALIGNMENT);
+
+        const TVector<char> padding(COLUMNAR_POOL_ALIGNMENT, 0);
+
+        output->Write(&header, sizeof(header));
+        output->Write(padding.data(), header.DataOffset - sizeof(header));
+
+        const ui64 columnSize = header.DocCount * sizeof(float);
+        const ui64 columnStride = GetColumnStride(header.DocCount);
+        for (auto column : columns) {
+            CB_ENSURE(column.size() == header.DocCount, "Columnar pool: all columns must have the same size");
+            output->Write(column.data(), columnSize);
+            output->Write(padding.data(), columnStride - columnSize);
+        }
+    }
+
+}
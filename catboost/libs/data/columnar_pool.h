@@ -0,0 +1,63 @@
+#pragma once
+
+#include <util/generic/array_ref.h>
+#include <util/memory/blob.h>
+#include <util/stream/fwd.h>
+#include <util/system/types.h>
+
+
+namespace NCB {
+
+    /*
+     * Columnar binary pool format ("columnar://" scheme).
+     *
+     * Layout (little-endian):
+     *   TColumnarPoolHeader
+     *   ColumnCount columns, each is DocCount float32 values, columns are aligned to
+     *     COLUMNAR_POOL_ALIGNMENT bytes from the beginning of the file.
+     *
+     * Column types are specified by the usual column description file, so the whole pool can be
+     * memory-mapped and each column is copied to the pool storage by a single memcpy.
+     * Only numeric columns (Num, Label, Weight, GroupWeight, Baseline, Auxiliary) are supported.
+     */
+
+    constexpr ui64 COLUMNAR_POOL_MAGIC = 0x6C6F4374736F6F42ull; // "BoostCol"
+    constexpr ui32 COLUMNAR_POOL_VERSION = 1;
+    constexpr ui64 COLUMNAR_POOL_ALIGNMENT = 64;
+
+    struct TColumnarPoolHeader {
+        ui64 Magic = COLUMNAR_POOL_MAGIC;
+        ui32 Version = COLUMNAR_POOL_VERSION;
+        ui32 ColumnCount = 0;
+        ui64 DocCount = 0;
+        ui64 DataOffset = 0; // offset of the first column from the beginning of the file
+
+        // offset of the column data from the beginning of the file
+        ui64 GetColumnOffset(ui32 columnIdx) const;
+    };
+
+    static_assert(sizeof(TColumnarPoolHeader) == 32, "TColumnarPoolHeader size is a part of file format");
+
+
+    // read-only view of the columnar pool data, does not copy column data
+    class TColumnarPoolView {
+    public:
+        explicit TColumnarPoolView(const TBlob& blob);
+
+        const TColumnarPoolHeader& GetHeader() const {
+            return Header;
+        }
+
+        TConstArrayRef<float> GetColumn(ui32 columnIdx) const;
+
+    private:
+        TBlob Blob;
+        TColumnarPoolHeader Header;
+    };
+
+    TColumnarPoolView LoadColumnarPool(const TString& path);
+
+    // columns: [columnIdx][docIdx], all columns must have equal size
+    void SaveColumnarPool(TConstArrayRef<TConstArrayRef<float>> columns, IOutputStream* output);
+
+}
@@ -1,6 +1,9 @@
 #include "doc_pool_data_provider.h"
+#include "columnar_pool.h"
+#include "load_pairs.h"
 
 #include <catboost/libs/column_description/cd_parser.h>
+#include <catboost/libs/data_util/block_codecs_input.h>
 #include <catboost/libs/data_util/exists_checker.h>
 #include <catboost/libs/helpers/mem_usage.h>
 #include <catboost/libs/quantization_schema/schema.h>
@@ -11,9 +14,14 @@
 
 #include <library/object_factory/object_factory.h>
 
+#include <util/generic/cast.h>
+#include <util/generic/is_in.h>
 #include <util/generic/maybe.h>
+#include <util/generic/xrange.h>
+#include <util/generic/ymath.h>
 #include <util/generic/strbuf.h>
 #include <util/generic/vector.h>
+#include <util/memory/blob.h>
 #include <util/stream/file.h>
 #include <util/string/iterator.h>
 #include <util/string/split.h>
@@ -22,75 +30,23 @@
 
 namespace NCB {
 
-    static TVector<TPair> ReadPairs(const TPathWithScheme& filePath, ui64 docCount) {
-        THolder<ILineDataReader> reader = GetLineDataReader(filePath);
-
-        TVector<TPair> pairs;
-        TString line;
-        while (reader->ReadLine(&line)) {
-            TVector<TString> tokens = StringSplitter(line).Split('\t').ToList<TString>();
-            if (tokens.empty()) {
-                continue;
-            }
-            CB_ENSURE(tokens.ysize() == 2 || tokens.ysize() == 3,
-                "Each line should have two or three columns. Invalid line number " << line);
-            ui64 winnerId = FromString<int>(tokens[0]);
-            ui64 loserId = FromString<int>(tokens[1]);
-            float weight = 1;
-            if (tokens.ysize() == 3) {
-                weight = FromString<float>(tokens[2]);
-            }
-            CB_ENSURE(winnerId >= 0 && winnerId < docCount, "Invalid winner index " << winnerId);
-            CB_ENSURE(loserId >= 0 && loserId < docCount, "Invalid loser index " << loserId);
-            pairs.emplace_back(winnerId, loserId, weight);
-        }
-
-        return pairs;
-    }
-
-    static TVector<float> ReadGroupWeights(
-        const TPathWithScheme& filePath,
-        TConstArrayRef<TGroupId> groupIds,
-        ui64 docCount
-    ) {
-        CB_ENSURE(groupIds.size() == docCount, "GroupId count should correspond with object count.");
-        TVector<float> groupWeights;
-        groupWeights.reserve(docCount);
-        ui64 groupIdCursor = 0;
-        THolder<ILineDataReader> reader = GetLineDataReader(filePath);
-        TString line;
-        while (reader->ReadLine(&line)) {
-            TVector<TString> tokens = StringSplitter(line).Split('\t').ToList<TString>();
-            CB_ENSURE(tokens.ysize() == 2,
-                "Each line in group weights file should have two columns. Invalid line number " << line);
-
-            const TGroupId groupId = CalcGroupIdFor(tokens[0]);
-            const float groupWeight = FromString<float>(tokens[1]);
-            ui64 groupSize = 0;
-            CB_ENSURE(groupId == groupIds[groupIdCursor],
-                "GroupId from the file with group weights do not match GroupId from the dataset.");
-            while (groupIdCursor < docCount && groupId == groupIds[groupIdCursor]) {
-                ++groupSize;
-                ++groupIdCursor;
-            }
-            groupWeights.insert(groupWeights.end(), groupSize, groupWeight);
-        }
-        CB_ENSURE(groupWeights.size() == docCount,
-            "Group weights file should have as many weights as the objects in the dataset.");
-
-        return groupWeights;
-    }
-
     void WeightPairs(TConstArrayRef<float> groupWeight, TVector<TPair>* pairs) {
         for (auto& pair: *pairs) {
             pair.Weight *= groupWeight[pair.WinnerId];
         }
     }
 
-    void SetPairs(const TPathWithScheme& pairsPath, bool haveGroupWeights, IPoolBuilder* poolBuilder) {
+    void SetPairs(
+        const TPathWithScheme& pairsPath,
+        bool haveGroupWeights,
+        NPar::TLocalExecutor* localExecutor,
+        IPoolBuilder* poolBuilder
+    ) {
         DumpMemUsage("After data read");
         if (pairsPath.Inited()) {
-            TVector<TPair> pairs = ReadPairs(pairsPath, poolBuilder->GetDocCount());
+            TVector<TPair> pairs = ReadPairs(
+                pairsPath, poolBuilder->GetDocCount(), poolBuilder->GetGroupIds(), localExecutor
+            );
             if (haveGroupWeights) {
                 WeightPairs(poolBuilder->GetWeight(), &pairs);
             }
@@ -98,11 +54,15 @@ namespace NCB {
         }
     }
 
-    void SetGroupWeights(const TPathWithScheme& groupWeightsPath, IPoolBuilder* poolBuilder) {
+    void SetGroupWeights(
+        const TPathWithScheme& groupWeightsPath,
+        NPar::TLocalExecutor* localExecutor,
+        IPoolBuilder* poolBuilder
+    ) {
         DumpMemUsage("After data read");
         if (groupWeightsPath.Inited()) {
             TVector<float> groupWeights = ReadGroupWeights(
-                groupWeightsPath, poolBuilder->GetGroupIds(), poolBuilder->GetDocCount()
+                groupWeightsPath, poolBuilder->GetGroupIds(), poolBuilder->GetDocCount(), localExecutor
             );
             poolBuilder->SetGroupWeights(groupWeights);
         }
@@ -312,6 +272,18 @@ namespace NCB {
 
     // Quantized data provider
 
+    TQuantizedPool LoadQuantizedPool(
+        const TPathWithScheme& poolPath,
+        const TLoadQuantizedPoolParameters& params
+    ) {
+        if (poolPath.Scheme == "bc-quantized") {
+            TIFStream input(poolPath.Path);
+            TBuffer decoded = DecodeAllInParallel(&input, GetDefaultDecodeThreadCount());
+            return LoadQuantizedPool(TBlob::FromBuffer(decoded));
+        }
+        return LoadQuantizedPool(poolPath.Path, params);
+    }
+
     namespace {
         TVector<TFloatFeature> GetFloatFeatureInfo(int allFeaturesCount, const TQuantizedPool& pool) {
             const auto& quantizationSchema = QuantizationSchemaFromProto(pool.QuantizationSchema);
@@ -378,8 +350,8 @@ namespace NCB {
 
             poolBuilder->SetFloatFeatures(GetFloatFeatureInfo(PoolMetaInfo.FeatureCount, QuantizedPool));
             QuantizedPool = TQuantizedPool(); // release memory
-            SetGroupWeights(GroupWeightsPath, poolBuilder);
-            SetPairs(PairsPath, PoolMetaInfo.HasGroupWeight, poolBuilder);
+            SetGroupWeights(GroupWeightsPath, LocalExecutor, poolBuilder);
+            SetPairs(PairsPath, PoolMetaInfo.HasGroupWeight, LocalExecutor, poolBuilder);
             poolBuilder->Finish();
         }
 
@@ -398,13 +370,15 @@ namespace NCB {
         TQuantizedPool QuantizedPool;
         TPathWithScheme PairsPath;
         TPathWithScheme GroupWeightsPath;
+        NPar::TLocalExecutor* LocalExecutor;
         TPoolMetaInfo PoolMetaInfo;
     };
 
     TCBQuantizedDataProvider::TCBQuantizedDataProvider(TDocPoolPullDataProviderArgs&& args)
-        : QuantizedPool(std::forward<TQuantizedPool>(LoadQuantizedPool(args.PoolPath.Path, GetLoadParameters())))
+        : QuantizedPool(LoadQuantizedPool(args.PoolPath, GetLoadParameters()))
         , PairsPath(args.CommonArgs.PairsFilePath)
         , GroupWeightsPath(args.CommonArgs.GroupWeightsFilePath)
+        , LocalExecutor(args.CommonArgs.LocalExecutor)
     {
         CB_ENSURE(!PairsPath.Inited() || CheckExists(PairsPath),
             "TCBQuantizedDataProvider:PairsFilePath does not exist");
@@ -435,11 +409,199 @@ namespace NCB {
         CatFeatures = GetCategoricalFeatureIndices(QuantizedPool);
     }
 
+
+    // Columnar binary data provider, see columnar_pool.h for format description
+
+    class TCBColumnarDataProvider final : public IDocPoolDataProvider
+    {
+    public:
+        explicit TCBColumnarDataProvider(TDocPoolPullDataProviderArgs&& args);
+
+        void Do(IPoolBuilder* poolBuilder) override {
+            const ui32 docCount = SafeIntegerCast<ui32>(ColumnarPool.GetHeader().DocCount);
+            poolBuilder->Start(PoolMetaInfo, docCount, /*catFeatureIds*/ {});
+            ProcessDocs(0, docCount, poolBuilder);
+            SetGroupWeights(Args.GroupWeightsFilePath, Args.LocalExecutor, poolBuilder);
+            SetPairs(Args.PairsFilePath, PoolMetaInfo.HasGroupWeight, Args.LocalExecutor, poolBuilder);
+            FinalizeTarget(poolBuilder);
+            poolBuilder->Finish();
+        }
+
+        bool DoBlock(IPoolBuilder* poolBuilder) override {
+            CB_ENSURE(!Args.PairsFilePath.Inited(),
+                      "TCBColumnarDataProvider::DoBlock does not support pairs data");
+            CB_ENSURE(!Args.GroupWeightsFilePath.Inited(),
+                      "TCBColumnarDataProvider::DoBlock does not support group weights data");
+
+            const ui64 docCount = ColumnarPool.GetHeader().DocCount;
+            if (DocsProcessed == docCount) {
+                return false;
+            }
+            const ui32 blockSize = SafeIntegerCast<ui32>(Min<ui64>(Args.BlockSize, docCount - DocsProcessed));
+            poolBuilder->Start(PoolMetaInfo, blockSize, /*catFeatureIds*/ {});
+            ProcessDocs(DocsProcessed, blockSize, poolBuilder);
+            FinalizeTarget(poolBuilder);
+            poolBuilder->Finish();
+            return true;
+        }
+
+    private:
+        void ProcessDocs(ui64 docOffset, ui32 docCount, IPoolBuilder* poolBuilder);
+        void FinalizeTarget(IPoolBuilder* poolBuilder);
+
+    private:
+        TDocPoolCommonDataProviderArgs Args;
+        TColumnarPoolView ColumnarPool;
+        TPoolMetaInfo PoolMetaInfo;
+        TVector<bool> FeatureIgnored;
+        ui64 DocsProcessed = 0;
+        bool IsOfflineTargetProcessing = false;
+    };
+
+    TCBColumnarDataProvider::TCBColumnarDataProvider(TDocPoolPullDataProviderArgs&& args)
+        : Args(std::move(args.CommonArgs))
+        , ColumnarPool(LoadColumnarPool(args.PoolPath.Path))
+    {
+        CB_ENSURE(Args.TargetConverter != nullptr,
+                  "TCBColumnarDataProvider can not work with null target converter pointer");
+        CB_ENSURE(!Args.PairsFilePath.Inited() || CheckExists(Args.PairsFilePath),
+                  "TCBColumnarDataProvider:PairsFilePath does not exist");
+        CB_ENSURE(!Args.GroupWeightsFilePath.Inited() || CheckExists(Args.GroupWeightsFilePath),
+                  "TCBColumnarDataProvider:GroupWeightsFilePath does not exist");
+
+        PoolMetaInfo = TPoolMetaInfo(
+            Args.CdProvider->GetColumnsDescription(ColumnarPool.GetHeader().ColumnCount),
+            Args.GroupWeightsFilePath.Inited()
+        );
+        for (const auto& column : PoolMetaInfo.ColumnsInfo->Columns) {
+            CB_ENSURE(
+                IsIn({EColumn::Num, EColumn::Label, EColumn::Weight, EColumn::GroupWeight,
+                      EColumn::Baseline, EColumn::Auxiliary}, column.Type),
+                "Columnar pools support only Num, Label, Weight, GroupWeight, Baseline and Auxiliary columns, got "
+                << column.Type
+            );
+        }
+
+        const int featureCount = static_cast<int>(PoolMetaInfo.FeatureCount);
+        CB_ENSURE(featureCount > 0, "Pool should have at least one factor");
+        int ignoredFeatureCount = 0;
+        FeatureIgnored.resize(featureCount, false);
+        for (int featureId : Args.IgnoredFeatures) {
+            CB_ENSURE(0 <= featureId, "Invalid ignored feature id: " << featureId);
+            if (featureId >= featureCount) {
+                continue;
+            }
+            ignoredFeatureCount += FeatureIgnored[featureId] == false;
+            FeatureIgnored[featureId] = true;
+        }
+        CB_ENSURE(featureCount - ignoredFeatureCount > 0, "All features are requested to be ignored");
+    }
+
+    void TCBColumnarDataProvider::ProcessDocs(ui64 docOffset, ui32 docCount, IPoolBuilder* poolBuilder) {
+        poolBuilder->StartNextBlock(docCount);
+        if (!PoolMetaInfo.HasDocIds) {
+            poolBuilder->GenerateDocIds(SafeIntegerCast<int>(docOffset));
+        }
+
+        const auto& columns = PoolMetaInfo.ColumnsInfo->Columns;
+
+        // feature and baseline indices for each column
+        TVector<ui32> columnToSubIdx(columns.size(), 0);
+        {
+            ui32 featureId = 0;
+            ui32 baselineIdx = 0;
+            for (auto columnIdx : xrange(columns.size())) {
+                if (columns[columnIdx].Type == EColumn::Num) {
+                    columnToSubIdx[columnIdx] = featureId++;
+                } else if (columns[columnIdx].Type == EColumn::Baseline) {
+                    columnToSubIdx[columnIdx] = baselineIdx++;
+                }
+            }
+        }
+
+        const EConvertTargetPolicy targetPolicy = Args.TargetConverter->GetTargetPolicy();
+        IsOfflineTargetProcessing = (targetPolicy == EConvertTargetPolicy::MakeClassNames);
+
+        // columns are independent, so process them in parallel
+        Args.LocalExecutor->ExecRangeWithThrow([&] (int columnIdx) {
+            const TConstArrayRef<float> values
+                = ColumnarPool.GetColumn(columnIdx).Slice(docOffset, docCount);
+            const ui32 subIdx = columnToSubIdx[columnIdx];
+
+            switch (columns[columnIdx].Type) {
+                case EColumn::Num: {
+                    if (!FeatureIgnored[subIdx]) {
+                        poolBuilder->AddFloatFeaturePack(0, subIdx, values);
+                    }
+                    break;
+                }
+                case EColumn::Label: {
+                    for (auto docIdx : xrange(docCount)) {
+                        CB_ENSURE(!IsNan(values[docIdx]), "NaN not supported for target");
+                        switch (targetPolicy) {
+                            case EConvertTargetPolicy::CastFloat:
+                                poolBuilder->AddTarget(docIdx, values[docIdx]);
+                                break;
+                            case EConvertTargetPolicy::UseClassNames:
+                                poolBuilder->AddTarget(
+                                    docIdx,
+                                    Args.TargetConverter->ConvertLabel(ToString(values[docIdx]))
+                                );
+                                break;
+                            case EConvertTargetPolicy::MakeClassNames:
+                                poolBuilder->AddLabel(docIdx, ToString(values[docIdx]));
+                                break;
+                            default:
+                                CB_ENSURE(false, "Unsupported convert target policy "
+                                                 << ToString<EConvertTargetPolicy>(targetPolicy));
+                        }
+                    }
+                    break;
+                }
+                case EColumn::Baseline: {
+                    for (auto docIdx : xrange(docCount)) {
+                        poolBuilder->AddBaseline(docIdx, subIdx, values[docIdx]);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }, 0, columns.ysize(), NPar::TLocalExecutor::WAIT_COMPLETE);
+
+        // Weight and GroupWeight columns both set the document weight, so they are applied serially
+        // in the column order, as for dsv pools
+        for (auto columnIdx : xrange(columns.size())) {
+            if (!IsIn({EColumn::Weight, EColumn::GroupWeight}, columns[columnIdx].Type)) {
+                continue;
+            }
+            const TConstArrayRef<float> values
+                = ColumnarPool.GetColumn(columnIdx).Slice(docOffset, docCount);
+            for (auto docIdx : xrange(docCount)) {
+                poolBuilder->AddWeight(docIdx, values[docIdx]);
+            }
+        }
+
+        DocsProcessed = docOffset + docCount;
+    }
+
+    void TCBColumnarDataProvider::FinalizeTarget(IPoolBuilder* poolBuilder) {
+        if (IsOfflineTargetProcessing) {
+            poolBuilder->SetTarget(Args.TargetConverter->PostprocessLabels(poolBuilder->GetLabels()));
+            Args.TargetConverter->SetOutputClassNames();
+        }
+    }
+
+
     namespace {
         TDocDataProviderObjectFactory::TRegistrator<TCBDsvDataProvider> DefDataProviderReg("");
         TDocDataProviderObjectFactory::TRegistrator<TCBDsvDataProvider> CBDsvDataProviderReg("dsv");
+        TDocDataProviderObjectFactory::TRegistrator<TCBDsvDataProvider> CBBlockCodecsDsvDataProviderReg("bc-dsv");
 
         TDocDataProviderObjectFactory::TRegistrator<TCBQuantizedDataProvider> CBQuantizedDataProviderReg("quantized");
+        TDocDataProviderObjectFactory::TRegistrator<TCBQuantizedDataProvider> CBBlockCodecsQuantizedDataProviderReg("bc-quantized");
+
+        TDocDataProviderObjectFactory::TRegistrator<TCBColumnarDataProvider> CBColumnarDataProviderReg("columnar");
     }
 }
 
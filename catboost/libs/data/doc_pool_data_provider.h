@@ -10,6 +10,8 @@
 #include <catboost/libs/options/load_options.h>
 #include <catboost/libs/column_description/cd_parser.h>
 #include <catboost/libs/pool_builder/pool_builder.h>
+#include <catboost/libs/quantized_pool/pool.h>
+#include <catboost/libs/quantized_pool/serialization.h>
 
 #include <library/object_factory/object_factory.h>
 #include <library/threading/local_executor/local_executor.h>
@@ -65,8 +67,17 @@ namespace NCB {
     // Implementations
 
     void WeightPairs(TConstArrayRef<float> groupWeight, TVector<TPair>* pairs);
-    void SetPairs(const TPathWithScheme& pairsPath, bool haveGroupWeights, IPoolBuilder* poolBuilder);
-    void SetGroupWeights(const TPathWithScheme& groupWeightsPath, IPoolBuilder* poolBuilder);
+    void SetPairs(
+        const TPathWithScheme& pairsPath,
+        bool haveGroupWeights,
+        NPar::TLocalExecutor* localExecutor,
+        IPoolBuilder* poolBuilder
+    );
+    void SetGroupWeights(
+        const TPathWithScheme& groupWeightsPath,
+        NPar::TLocalExecutor* localExecutor,
+        IPoolBuilder* poolBuilder
+    );
 
     /*
      * Some common functionality for DocPoolDataProvider classes than utilize async row processing.
@@ -140,8 +151,8 @@ namespace NCB {
 
         virtual void FinalizeBuilder(bool inBlock, IPoolBuilder* poolBuilder) {
             if (!inBlock) {
-                SetGroupWeights(Args.GroupWeightsFilePath, poolBuilder);
-                SetPairs(Args.PairsFilePath, PoolMetaInfo.HasGroupWeight, poolBuilder);
+                SetGroupWeights(Args.GroupWeightsFilePath, Args.LocalExecutor, poolBuilder);
+                SetPairs(Args.PairsFilePath, PoolMetaInfo.HasGroupWeight, Args.LocalExecutor, poolBuilder);
                 if (IsOfflineTargetProcessing) {
                     poolBuilder->SetTarget(TargetConverter->PostprocessLabels(poolBuilder->GetLabels()));  // postprocessing is used in order to save class-names reproducibility for multithreading
                     TargetConverter->SetOutputClassNames();
@@ -216,4 +227,10 @@ namespace NCB {
 
 
     bool IsNanValue(const TStringBuf& s);
+
+    // supports "quantized" and "bc-quantized" (compressed by library/blockcodecs) schemes
+    TQuantizedPool LoadQuantizedPool(
+        const TPathWithScheme& poolPath,
+        const TLoadQuantizedPoolParameters& params
+    );
 }
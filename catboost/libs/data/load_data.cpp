@@ -8,9 +8,13 @@
 
 #include <library/threading/local_executor/local_executor.h>
 
+#include <util/generic/hash_set.h>
 #include <util/generic/string.h>
 #include <util/generic/vector.h>
 #include <util/stream/output.h>
+#include <util/system/atomic.h>
+#include <util/system/guard.h>
+#include <util/system/spinlock.h>
 
 namespace NCB {
 
@@ -35,7 +39,16 @@ namespace NCB {
                               FeatureCount,
                               BaselineCount,
                               poolMetaInfo.HasGroupId,
-                              poolMetaInfo.HasSubgroupIds);
+                              poolMetaInfo.HasSubgroupIds,
+                              poolMetaInfo.HasTimestamp);
+            if (poolMetaInfo.HasDocIds) {
+                Pool->Docs.Id.resize(docCount);
+            } else {
+                Pool->Docs.GenerateDocIds(0);
+            }
+            // labels buffer is allocated only if labels are really added
+            Pool->Docs.Label.clear();
+            AtomicSet(LabelsAllocated, 0);
             Pool->CatFeatures = catFeatureIds;
             Pool->FeatureId.assign(FeatureCount, TString());
             Pool->MetaInfo = poolMetaInfo;
@@ -79,6 +92,10 @@ namespace NCB {
             CB_ENSURE(false, "Not supported for regular pools");
         }
 
+        void AddFloatFeaturePack(ui32 localIdx, ui32 featureId, TConstArrayRef<float> featurePack) override {
+            Copy(featurePack.begin(), featurePack.end(), Pool->Docs.Factors[featureId].begin() + Cursor + localIdx);
+        }
+
         void AddAllFloatFeatures(ui32 localIdx, TConstArrayRef<float> features) override {
             CB_ENSURE(features.size() == FeatureCount, "Error: number of features should be equal to factor count");
             TVector<float>* factors = Pool->Docs.Factors.data();
@@ -88,7 +105,25 @@ namespace NCB {
         }
 
         void AddLabel(ui32 localIdx, const TStringBuf& label) override {
-            Pool->Docs.Label[Cursor + localIdx] = label;
+            if (Y_UNLIKELY(!AtomicGet(LabelsAllocated))) {
+                with_lock (LabelsAllocationLock) {
+                    if (!AtomicGet(LabelsAllocated)) {
+                        Pool->Docs.Label.resize(Pool->Docs.GetDocCount());
+                        AtomicSet(LabelsAllocated, 1);
+                    }
+                }
+            }
+
+            // labels usually have few unique values, share their data (TString is copy-on-write)
+            const int hashPartIdx = LocalExecutor.GetWorkerThreadId();
+            CB_ENSURE(hashPartIdx < CB_THREAD_LIMIT, "Internal error: thread ID exceeds CB_THREAD_LIMIT");
+            auto& labels = HashMapParts[hashPartIdx].Labels;
+            THashSet<TString>::insert_ctx insertCtx = nullptr;
+            auto it = labels.find(label, insertCtx);
+            if (it == labels.end()) {
+                it = labels.emplace_direct(insertCtx, label);
+            }
+            Pool->Docs.Label[Cursor + localIdx] = *it;
         }
 
         void AddTarget(ui32 localIdx, float value) override {
@@ -136,6 +171,10 @@ namespace NCB {
 
         void SetTarget(const TVector<float>& target) override {
             Pool->Docs.Target = target;
+
+            // labels are needed only to calculate target
+            Pool->Docs.Label.clear();
+            Pool->Docs.Label.shrink_to_fit();
         }
 
         void SetFloatFeatures(const TVector<TFloatFeature>& floatFeatures) override {
@@ -160,9 +199,7 @@ namespace NCB {
         }
 
         void GenerateDocIds(int offset) override {
-            for (int ind = 0; ind < Pool->Docs.Id.ysize(); ++ind) {
-                Pool->Docs.Id[ind] = ToString(offset + ind);
-            }
+            Pool->Docs.GenerateDocIds(offset);
         }
 
         void Finish() override {
@@ -179,6 +216,7 @@ namespace NCB {
     private:
         struct THashPart {
             THashMap<int, TString> CatFeatureHashes;
+            THashSet<TString> Labels;
         };
         TPool* Pool;
         static constexpr const int NotSet = -1;
@@ -187,6 +225,8 @@ namespace NCB {
         ui32 FeatureCount = 0;
         ui32 BaselineCount = 0;
         std::array<THashPart, CB_THREAD_LIMIT> HashMapParts;
+        TAtomic LabelsAllocated = 0;
+        TAdaptiveLock LabelsAllocationLock;
         const NPar::TLocalExecutor& LocalExecutor;
     };
 
@@ -326,9 +366,7 @@ namespace NCB {
         }
 
         void GenerateDocIds(int offset) override {
-            for (int ind = 0; ind < Pool->Docs.Id.ysize(); ++ind) {
-                Pool->Docs.Id[ind] = ToString(offset + ind);
-            }
+            Pool->Docs.GenerateDocIds(offset);
         }
 
         void Finish() override {
@@ -363,8 +401,10 @@ namespace NCB {
             if (metaInfo.HasSubgroupIds) {
                 Pool->Docs.SubgroupId.resize(docCount);
             }
-            Pool->Docs.Timestamp.resize(docCount);
-            Pool->Docs.Id.resize(docCount);
+            if (metaInfo.HasTimestamp) {
+                Pool->Docs.Timestamp.resize(docCount);
+            }
+            Pool->Docs.GenerateDocIds(0);
         }
 
         TPool* Pool;
@@ -482,7 +522,7 @@ namespace NCB {
         const NCB::TPathWithScheme& poolPath,
         const NPar::TLocalExecutor& localExecutor,
         TPool* pool) {
-        if (poolPath.Scheme == "quantized") {
+        if (poolPath.Scheme == "quantized" || poolPath.Scheme == "bc-quantized") {
             return new TQuantizedBuilder(pool);
         } else {
             return new TPoolBuilder(localExecutor, pool);
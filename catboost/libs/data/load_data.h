@@ -18,7 +18,7 @@
 namespace NCB {
 
     THolder<IPoolBuilder> InitBuilder(
-        const NCB::TPathWithScheme& poolPath, // quantize, if scheme == "quantized"
+        const NCB::TPathWithScheme& poolPath, // quantize, if scheme == "quantized" or "bc-quantized"
         const NPar::TLocalExecutor& localExecutor,
         TPool* pool);
 
@@ -0,0 +1,229 @@
+#include "load_pairs.h"
+#include "async_row_processor.h"
+
+#include <catboost/libs/data_util/line_data_reader.h>
+#include <catboost/libs/helpers/exception.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/cast.h>
+#include <util/generic/strbuf.h>
+#include <util/generic/xrange.h>
+#include <util/memory/blob.h>
+#include <util/stream/output.h>
+#include <util/string/cast.h>
+#include <util/string/iterator.h>
+#include <util/system/atomic.h>
+
+
+namespace NCB {
+
+    // lines are read asynchronously by blocks of this size and parsed in parallel
+    static constexpr size_t TEXT_BLOCK_SIZE = 1 << 16;
+
+    // parse up to maxTokenCount tab-separated tokens, returns number of tokens
+    static size_t SplitLine(TStringBuf line, size_t maxTokenCount, TStringBuf* tokens) {
+        size_t tokenCount = 0;
+        for (const auto& token : StringSplitter(line).Split('\t')) {
+            if (tokenCount == maxTokenCount) {
+                return maxTokenCount + 1;
+            }
+            tokens[tokenCount++] = token.Token();
+        }
+        return tokenCount;
+    }
+
+    static TVector<TPair> ReadBinaryPairs(const TPathWithScheme& filePath) {
+        const TBlob blob = TBlob::FromFile(filePath.Path);
+        CB_ENSURE(blob.Size() >= sizeof(TBinaryPairsHeader), "Binary pairs: file is too small");
+
+        TBinaryPairsHeader header;
+        memcpy(&header, blob.AsCharPtr(), sizeof(TBinaryPairsHeader));
+        CB_ENSURE(header.Magic == BINARY_PAIRS_MAGIC, "Binary pairs: wrong magic");
+        CB_ENSURE(header.Version == BINARY_PAIRS_VERSION, "Binary pairs: unsupported version " << header.Version);
+        CB_ENSURE(header.PairSize == sizeof(TPair), "Binary pairs: wrong pair size " << header.PairSize);
+        CB_ENSURE(
+            blob.Size() == sizeof(TBinaryPairsHeader) + header.PairCount * sizeof(TPair),
+            "Binary pairs: file size does not match pair count " << header.PairCount
+        );
+
+        TVector<TPair> pairs;
+        pairs.yresize(header.PairCount);
+        memcpy(pairs.data(), blob.AsCharPtr() + sizeof(TBinaryPairsHeader), header.PairCount * sizeof(TPair));
+        return pairs;
+    }
+
+    static TVector<TPair> ReadTextPairs(const TPathWithScheme& filePath, NPar::TLocalExecutor* localExecutor) {
+        THolder<ILineDataReader> reader = GetLineDataReader(filePath);
+        auto readFunc = [&reader] (TString* line) -> bool {
+            return reader->ReadLine(line);
+        };
+
+        TAsyncRowProcessor<TString> rowProcessor(localExecutor, TEXT_BLOCK_SIZE);
+        rowProcessor.ReadBlockAsync(readFunc);
+
+        TVector<TPair> pairs;
+        TAtomic hasEmptyLines = 0;
+        while (rowProcessor.ReadBlock(readFunc)) {
+            const size_t blockOffset = pairs.size();
+            pairs.yresize(blockOffset + rowProcessor.GetParseBufferSize());
+            rowProcessor.ProcessBlock(
+                [&] (const TString& line, int lineIdx) {
+                    TPair& pair = pairs[blockOffset + lineIdx];
+                    if (line.empty()) {
+                        pair = TPair(-1, -1, 0.0f); // will be removed
+                        AtomicSet(hasEmptyLines, 1);
+                        return;
+                    }
+
+                    TStringBuf tokens[3];
+                    const size_t tokenCount = SplitLine(line, 3, tokens);
+                    CB_ENSURE(tokenCount == 2 || tokenCount == 3,
+                        "Each line should have two or three columns. Invalid line number "
+                        << blockOffset + lineIdx + 1);
+                    pair.WinnerId = FromString<int>(tokens[0]);
+                    pair.LoserId = FromString<int>(tokens[1]);
+                    pair.Weight = (tokenCount == 3) ? FromString<float>(tokens[2]) : 1.0f;
+                    // negative ids are reserved for empty lines
+                    CB_ENSURE(pair.WinnerId >= 0, "Invalid winner index " << pair.WinnerId);
+                    CB_ENSURE(pair.LoserId >= 0, "Invalid loser index " << pair.LoserId);
+                }
+            );
+        }
+        rowProcessor.FinishAsyncProcessing();
+
+        if (AtomicGet(hasEmptyLines)) {
+            EraseIf(pairs, [] (const TPair& pair) { return pair.WinnerId == -1; });
+        }
+        return pairs;
+    }
+
+    TVector<TPair> ReadPairs(
+        const TPathWithScheme& filePath,
+        ui64 docCount,
+        TConstArrayRef<TGroupId> groupIds,
+        NPar::TLocalExecutor* localExecutor
+    ) {
+        TVector<TPair> pairs = (filePath.Scheme == "bin-pairs") ?
+            ReadBinaryPairs(filePath)
+            : ReadTextPairs(filePath, localExecutor);
+        CheckPairs(pairs, docCount, groupIds, localExecutor);
+        return pairs;
+    }
+
+    void SaveBinaryPairs(TConstArrayRef<TPair> pairs, IOutputStream* output) {
+        TBinaryPairsHeader header;
+        header.PairCount = pairs.size();
+        output->Write(&header, sizeof(header));
+        output->Write(pairs.data(), pairs.size() * sizeof(TPair));
+    }
+
+    void CheckPairs(
+        TConstArrayRef<TPair> pairs,
+        ui64 docCount,
+        TConstArrayRef<TGroupId> groupIds,
+        NPar::TLocalExecutor* localExecutor
+    ) {
+        CB_ENSURE(groupIds.empty() || groupIds.size() == docCount, "GroupId count should correspond with object count.");
+        if (pairs.empty()) {
+            return;
+        }
+
+        NPar::TLocalExecutor::TExecRangeParams blockParams(0, SafeIntegerCast<int>(pairs.size()));
+        blockParams.SetBlockCount(localExecutor->GetThreadCount() + 1);
+        localExecutor->ExecRangeWithThrow(
+            [&] (int blockIdx) {
+                const int blockBegin = blockIdx * blockParams.GetBlockSize();
+                const int blockEnd = Min(blockBegin + blockParams.GetBlockSize(), blockParams.LastId);
+
+                // check the whole block branchlessly, search for the exact error only if it has been found
+                bool isBlockValid = true;
+                for (int pairIdx = blockBegin; pairIdx < blockEnd; ++pairIdx) {
+                    const TPair& pair = pairs[pairIdx];
+                    isBlockValid &= (ui64)(ui32)pair.WinnerId < docCount;
+                    isBlockValid &= (ui64)(ui32)pair.LoserId < docCount;
+                }
+                if (isBlockValid && !groupIds.empty()) {
+                    for (int pairIdx = blockBegin; pairIdx < blockEnd; ++pairIdx) {
+                        const TPair& pair = pairs[pairIdx];
+                        isBlockValid &= groupIds[pair.WinnerId] == groupIds[pair.LoserId];
+                    }
+                }
+                if (isBlockValid) {
+                    return;
+                }
+
+                for (int pairIdx = blockBegin; pairIdx < blockEnd; ++pairIdx) {
+                    const TPair& pair = pairs[pairIdx];
+                    CB_ENSURE(pair.WinnerId >= 0 && (ui64)pair.WinnerId < docCount, "Invalid winner index " << pair.WinnerId);
+                    CB_ENSURE(pair.LoserId >= 0 && (ui64)pair.LoserId < docCount, "Invalid loser index " << pair.LoserId);
+                    CB_ENSURE(
+                        groupIds.empty() || groupIds[pair.WinnerId] == groupIds[pair.LoserId],
+                        "Both documents in pair should have the same queryId. Invalid pair ("
+                        << pair.WinnerId << ", " << pair.LoserId << ")"
+                    );
+                }
+            },
+            0,
+            blockParams.GetBlockCount(),
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+    }
+
+    TVector<float> ReadGroupWeights(
+        const TPathWithScheme& filePath,
+        TConstArrayRef<TGroupId> groupIds,
+        ui64 docCount,
+        NPar::TLocalExecutor* localExecutor
+    ) {
+        CB_ENSURE(groupIds.size() == docCount, "GroupId count should correspond with object count.");
+
+        THolder<ILineDataReader> reader = GetLineDataReader(filePath);
+        auto readFunc = [&reader] (TString* line) -> bool {
+            return reader->ReadLine(line);
+        };
+
+        TAsyncRowProcessor<TString> rowProcessor(localExecutor, TEXT_BLOCK_SIZE);
+        rowProcessor.ReadBlockAsync(readFunc);
+
+        TVector<float> groupWeights;
+        groupWeights.yresize(docCount);
+        ui64 groupIdCursor = 0;
+
+        TVector<TGroupId> blockGroupIds;
+        TVector<float> blockGroupWeights;
+        while (rowProcessor.ReadBlock(readFunc)) {
+            const size_t linesProcessed = rowProcessor.GetLinesProcessed();
+            blockGroupIds.yresize(rowProcessor.GetParseBufferSize());
+            blockGroupWeights.yresize(rowProcessor.GetParseBufferSize());
+            rowProcessor.ProcessBlock(
+                [&] (const TString& line, int lineIdx) {
+                    TStringBuf tokens[2];
+                    CB_ENSURE(SplitLine(line, 2, tokens) == 2,
+                        "Each line in group weights file should have two columns. Invalid line number "
+                        << linesProcessed + lineIdx + 1);
+                    blockGroupIds[lineIdx] = CalcGroupIdFor(tokens[0]);
+                    blockGroupWeights[lineIdx] = FromString<float>(tokens[1]);
+                }
+            );
+
+            // groups are consecutive in the dataset, so assignment to documents is a simple merge
+            for (auto lineIdx : xrange(blockGroupIds.size())) {
+                const TGroupId groupId = blockGroupIds[lineIdx];
+                CB_ENSURE(groupIdCursor < docCount && groupId == groupIds[groupIdCursor],
+                    "GroupId from the file with group weights do not match GroupId from the dataset.");
+                const ui64 groupBegin = groupIdCursor;
+                while (groupIdCursor < docCount && groupId == groupIds[groupIdCursor]) {
+                    ++groupIdCursor;
+                }
+                Fill(groupWeights.begin() + groupBegin, groupWeights.begin() + groupIdCursor, blockGroupWeights[lineIdx]);
+            }
+        }
+        rowProcessor.FinishAsyncProcessing();
+
+        CB_ENSURE(groupIdCursor == docCount,
+            "Group weights file should have as many weights as the objects in the dataset.");
+
+        return groupWeights;
+    }
+
+}
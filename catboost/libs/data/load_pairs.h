@@ -0,0 +1,69 @@
+#pragma once
+
+#include <catboost/libs/data_types/groupid.h>
+#include <catboost/libs/data_types/pair.h>
+#include <catboost/libs/data_util/path_with_scheme.h>
+
+#include <library/threading/local_executor/local_executor.h>
+
+#include <util/generic/array_ref.h>
+#include <util/generic/vector.h>
+#include <util/stream/fwd.h>
+#include <util/system/types.h>
+
+
+namespace NCB {
+
+    /*
+     * Binary pairs format ("bin-pairs" scheme).
+     *
+     * Layout (little-endian):
+     *   TBinaryPairsHeader
+     *   PairCount records of (i32 WinnerId, i32 LoserId, float32 Weight), the same as TPair memory layout
+     *
+     * Text format (default or "dsv" scheme): tab-separated WinnerId, LoserId and optional Weight per line.
+     */
+
+    constexpr ui64 BINARY_PAIRS_MAGIC = 0x73725074736F6F42ull; // "BoostPrs"
+    constexpr ui32 BINARY_PAIRS_VERSION = 1;
+
+    struct TBinaryPairsHeader {
+        ui64 Magic = BINARY_PAIRS_MAGIC;
+        ui32 Version = BINARY_PAIRS_VERSION;
+        ui32 PairSize = sizeof(TPair);
+        ui64 PairCount = 0;
+    };
+
+    static_assert(sizeof(TBinaryPairsHeader) == 24, "TBinaryPairsHeader size is a part of file format");
+    static_assert(sizeof(TPair) == 12, "TPair layout is a part of binary pairs file format");
+
+
+    /* groupIds can be empty if there're no groups in the pool,
+     * otherwise winner and loser of each pair must belong to the same group
+     */
+    TVector<TPair> ReadPairs(
+        const TPathWithScheme& filePath,
+        ui64 docCount,
+        TConstArrayRef<TGroupId> groupIds,
+        NPar::TLocalExecutor* localExecutor
+    );
+
+    void SaveBinaryPairs(TConstArrayRef<TPair> pairs, IOutputStream* output);
+
+    // checks ids range and groups (if groupIds is not empty)
+    void CheckPairs(
+        TConstArrayRef<TPair> pairs,
+        ui64 docCount,
+        TConstArrayRef<TGroupId> groupIds,
+        NPar::TLocalExecutor* localExecutor
+    );
+
+    // returns weights per document
+    TVector<float> ReadGroupWeights(
+        const TPathWithScheme& filePath,
+        TConstArrayRef<TGroupId> groupIds,
+        ui64 docCount,
+        NPar::TLocalExecutor* localExecutor
+    );
+
+}
@@ -11,7 +11,15 @@ static TDocumentStorage SliceDocumentStorage(
     }
 
     TDocumentStorage slicedDocs;
-    slicedDocs.Resize(rowIndices.size(), docs.GetEffectiveFactorCount());
+    slicedDocs.Resize(
+        rowIndices.size(),
+        docs.GetEffectiveFactorCount(),
+        docs.GetBaselineDimension(),
+        !docs.QueryId.empty(),
+        !docs.SubgroupId.empty(),
+        !docs.Timestamp.empty()
+    );
+    slicedDocs.GeneratedIdsOffset = docs.GeneratedIdsOffset;
 
     for (size_t newDocIdx = 0; newDocIdx < rowIndices.size(); ++newDocIdx) {
         size_t oldDocIdx = rowIndices[newDocIdx];
@@ -105,6 +113,7 @@ void ApplyPermutation(const TVector<ui64>& permutation, TPool* pool, NPar::TLoca
         }
         ApplyPermutation(permutation, &pool->Docs.Target);
         ApplyPermutation(permutation, &pool->Docs.Weight);
+        // generated ids are not permuted, callers either restore the order or make ids explicit
         ApplyPermutation(permutation, &pool->Docs.Id);
         ApplyPermutation(permutation, &pool->Docs.SubgroupId);
         ApplyPermutation(permutation, &pool->Docs.QueryId);
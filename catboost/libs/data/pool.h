@@ -23,10 +23,11 @@
 struct TDocumentStorage {
     TVector<TVector<float>> Factors; // [factorIdx][docIdx]
     TVector<TVector<double>> Baseline; // [dim][docIdx]
-    TVector<TString> Label; // [docIdx] used only as buffer for processing labels at the end of pool reading with converting target policy MakeClassNames
+    TVector<TString> Label; // [docIdx] used only as buffer for processing labels at the end of pool reading with converting target policy MakeClassNames, empty otherwise
     TVector<float> Target; // [docIdx] stores processed numeric target
     TVector<float> Weight; // [docIdx]
-    TVector<TString> Id; // [docIdx]
+    TVector<TString> Id; // [docIdx] empty if ids are generated, see GetDocId
+    ui64 GeneratedIdsOffset = 0; // generated id of doc with index docIdx is GeneratedIdsOffset + docIdx
     TVector<TGroupId> QueryId; // [docIdx]
     TVector<TSubgroupId> SubgroupId; // [docIdx]
     TVector<ui64> Timestamp; // [docIdx]
@@ -44,6 +45,31 @@ struct TDocumentStorage {
         return Target.size();
     }
 
+    inline bool HasExplicitDocIds() const {
+        return !Id.empty();
+    }
+
+    inline TString GetDocId(size_t docIdx) const {
+        return HasExplicitDocIds() ? Id[docIdx] : ToString(GeneratedIdsOffset + docIdx);
+    }
+
+    // replace explicit ids (if any) with generated ones, they are not stored
+    inline void GenerateDocIds(ui64 offset) {
+        Id.clear();
+        Id.shrink_to_fit();
+        GeneratedIdsOffset = offset;
+    }
+
+    // materialize generated ids, needed if docs with explicit ids are assigned to this storage
+    inline void MakeDocIdsExplicit() {
+        if (!HasExplicitDocIds()) {
+            Id.yresize(GetDocCount());
+            for (size_t docIdx = 0; docIdx < Id.size(); ++docIdx) {
+                Id[docIdx] = ToString(GeneratedIdsOffset + docIdx);
+            }
+        }
+    }
+
     bool operator==(const TDocumentStorage& other) const {
         if (Factors.ysize() != other.Factors.ysize()) {
             return false;
@@ -58,8 +84,8 @@ struct TDocumentStorage {
             }
         }
         return areFactorsEqual && (
-            std::tie(Baseline, Target, Weight, Id, QueryId, SubgroupId, Timestamp) ==
-            std::tie(other.Baseline, other.Target, other.Weight, other.Id, other.QueryId, other.SubgroupId, other.Timestamp)
+            std::tie(Baseline, Target, Weight, Id, GeneratedIdsOffset, QueryId, SubgroupId, Timestamp) ==
+            std::tie(other.Baseline, other.Target, other.Weight, other.Id, other.GeneratedIdsOffset, other.QueryId, other.SubgroupId, other.Timestamp)
         );
     }
 
@@ -70,9 +96,11 @@ struct TDocumentStorage {
     inline void Swap(TDocumentStorage& other) {
         Factors.swap(other.Factors);
         Baseline.swap(other.Baseline);
+        Label.swap(other.Label);
         Target.swap(other.Target);
         Weight.swap(other.Weight);
         Id.swap(other.Id);
+        DoSwap(GeneratedIdsOffset, other.GeneratedIdsOffset);
         QueryId.swap(other.QueryId);
         SubgroupId.swap(other.SubgroupId);
         Timestamp.swap(other.Timestamp);
@@ -89,17 +117,27 @@ struct TDocumentStorage {
         }
         Target[destinationIdx] = sourceDocs.Target[sourceIdx];
         Weight[destinationIdx] = sourceDocs.Weight[sourceIdx];
-        Id[destinationIdx] = sourceDocs.Id[sourceIdx];
+        // generated ids are position-based, so they are kept only if the doc keeps its generated id
+        if (sourceDocs.HasExplicitDocIds()
+            || sourceDocs.GeneratedIdsOffset + sourceIdx != GeneratedIdsOffset + destinationIdx)
+        {
+            MakeDocIdsExplicit();
+        }
+        if (HasExplicitDocIds()) {
+            Id[destinationIdx] = sourceDocs.GetDocId(sourceIdx);
+        }
         if (!sourceDocs.QueryId.empty()) {
             QueryId[destinationIdx] = sourceDocs.QueryId[sourceIdx];
         }
         if (!sourceDocs.SubgroupId.empty()) {
             SubgroupId[destinationIdx] = sourceDocs.SubgroupId[sourceIdx];
         }
-        Timestamp[destinationIdx] = sourceDocs.Timestamp[sourceIdx];
+        if (!sourceDocs.Timestamp.empty()) {
+            Timestamp[destinationIdx] = sourceDocs.Timestamp[sourceIdx];
+        }
     }
 
-    inline void Resize(int docCount, int featureCount, int approxDim = 0, bool hasQueryId = false, bool hasSubgroupId = false) {
+    inline void Resize(int docCount, int featureCount, int approxDim = 0, bool hasQueryId = false, bool hasSubgroupId = false, bool hasTimestamp = true) {
         Factors.resize(featureCount);
         for (auto& factor : Factors) {
             factor.resize(docCount);
@@ -109,11 +147,12 @@ struct TDocumentStorage {
             dim.resize(docCount);
         }
         Target.resize(docCount);
-        Label.resize(docCount);
+        if (!Label.empty()) {
+            Label.resize(docCount);
+        }
         Weight.resize(docCount, 1.0f);
-        Id.resize(docCount);
-        for (int ind = 0; ind < docCount; ++ ind) {
-            Id[ind] = ToString(ind);
+        if (HasExplicitDocIds()) {
+            Id.resize(docCount);
         }
         if (hasQueryId) {
             QueryId.resize(docCount);
@@ -121,7 +160,9 @@ struct TDocumentStorage {
         if (hasSubgroupId) {
             SubgroupId.resize(docCount);
         }
-        Timestamp.resize(docCount);
+        if (hasTimestamp) {
+            Timestamp.resize(docCount);
+        }
     }
 
     inline void Clear() {
@@ -133,12 +174,15 @@ struct TDocumentStorage {
             dim.clear();
             dim.shrink_to_fit();
         }
+        Label.clear();
+        Label.shrink_to_fit();
         Target.clear();
         Target.shrink_to_fit();
         Weight.clear();
         Weight.shrink_to_fit();
         Id.clear();
         Id.shrink_to_fit();
+        GeneratedIdsOffset = 0;
         QueryId.clear();
         QueryId.shrink_to_fit();
         SubgroupId.clear();
@@ -1,4 +1,7 @@
+#include <catboost/libs/data/columnar_pool.h>
 #include <catboost/libs/data/load_data.h>
+#include <catboost/libs/data/load_pairs.h>
+#include <catboost/libs/data/pool.h>
 
 #include <library/threading/local_executor/local_executor.h>
 
@@ -57,5 +60,122 @@ Y_UNIT_TEST_SUITE(TDataLoadTest) {
                 UNIT_ASSERT_DOUBLES_EQUAL(factors[i], redFactors[i], 1e-5);
             }
         }
+
+        // doc ids are not specified, so they are generated and not stored, raw labels are not kept
+        UNIT_ASSERT(!pool.Docs.HasExplicitDocIds());
+        UNIT_ASSERT_VALUES_EQUAL(pool.Docs.GetDocId(TestDocCount - 1), ToString(TestDocCount - 1));
+        UNIT_ASSERT(pool.Docs.Label.empty());
+        UNIT_ASSERT(pool.Docs.Timestamp.empty());
+    }
+
+    Y_UNIT_TEST(TestColumnarRead) {
+        TReallyFastRng32 rng(1);
+        const size_t TestDocCount = 20001;
+        const size_t FactorCount = 25;
+        TVector<TVector<float>> columns(FactorCount + 1); // label + factors
+        for (auto& column : columns) {
+            column.yresize(TestDocCount);
+            for (auto& value : column) {
+                value = rng.GenRandReal2();
+            }
+        }
+        TString TestFileName = "sample_pool.columnar";
+        {
+            TVector<TConstArrayRef<float>> columnRefs(columns.begin(), columns.end());
+            TOFStream writer(TestFileName);
+            SaveColumnarPool(columnRefs, &writer);
+        }
+        for (int threadCount : {1, 3}) {
+            TPool pool;
+            ReadPool(TPathWithScheme(TestFileName, "columnar"),
+                     TPathWithScheme(),
+                     TPathWithScheme(),
+                     NCatboostOptions::TDsvPoolFormatParams(),
+                     /*ignoredFeatures*/ {},
+                     threadCount,
+                     /*verbose*/ false,
+                     &pool);
+
+            UNIT_ASSERT_EQUAL(pool.Docs.GetDocCount(), TestDocCount);
+            UNIT_ASSERT_EQUAL(pool.Docs.GetEffectiveFactorCount(), (int)FactorCount);
+            UNIT_ASSERT_EQUAL(pool.Docs.Target, columns[0]);
+            for (size_t j = 0; j < FactorCount; ++j) {
+                UNIT_ASSERT_EQUAL(pool.Docs.Factors[j], columns[j + 1]);
+            }
+        }
+    }
+
+    Y_UNIT_TEST(TestPairsRead) {
+        TReallyFastRng32 rng(1);
+        const size_t DocCount = 1000;
+        const size_t GroupSize = 10;
+        const size_t PairCount = 200000;
+
+        TVector<TGroupId> groupIds(DocCount);
+        for (size_t i = 0; i < DocCount; ++i) {
+            groupIds[i] = CalcGroupIdFor(ToString(i / GroupSize));
+        }
+        TVector<TPair> pairs;
+        for (size_t i = 0; i < PairCount; ++i) {
+            const int groupBegin = rng.Uniform(DocCount / GroupSize) * GroupSize;
+            pairs.emplace_back(groupBegin + rng.Uniform(GroupSize), groupBegin + rng.Uniform(GroupSize), rng.Uniform(4));
+        }
+
+        const TString textPairsFileName = "pairs.tsv";
+        {
+            TOFStream writer(textPairsFileName);
+            for (const auto& pair : pairs) {
+                writer << pair.WinnerId << "\t" << pair.LoserId << "\t" << pair.Weight << Endl;
+            }
+        }
+        const TString binaryPairsFileName = "pairs.bin";
+        {
+            TOFStream writer(binaryPairsFileName);
+            SaveBinaryPairs(pairs, &writer);
+        }
+
+        NPar::TLocalExecutor localExecutor;
+        localExecutor.RunAdditionalThreads(3);
+
+        UNIT_ASSERT_EQUAL(ReadPairs(TPathWithScheme(textPairsFileName), DocCount, groupIds, &localExecutor), pairs);
+        UNIT_ASSERT_EQUAL(ReadPairs(TPathWithScheme("bin-pairs://" + binaryPairsFileName), DocCount, groupIds, &localExecutor), pairs);
+
+        pairs.emplace_back(0, GroupSize, 1.0f); // different groups
+        UNIT_ASSERT_EXCEPTION(CheckPairs(pairs, DocCount, groupIds, &localExecutor), TCatboostException);
+        CheckPairs(pairs, DocCount, /*groupIds*/ {}, &localExecutor);
+        pairs.emplace_back(0, DocCount, 1.0f);
+        UNIT_ASSERT_EXCEPTION(CheckPairs(pairs, DocCount, /*groupIds*/ {}, &localExecutor), TCatboostException);
+    }
+
+    Y_UNIT_TEST(TestSliceKeepsDocIds) {
+        const size_t DocCount = 10;
+        const ui64 IdsOffset = 100;
+        TPool pool;
+        pool.Docs.Resize(DocCount, /*featureCount*/ 1, /*baseline dimension*/ 0, /*hasQueryId*/ false, /*hasSubgroupId*/ false);
+        pool.Docs.GenerateDocIds(IdsOffset);
+        for (size_t i = 0; i < DocCount; ++i) {
+            pool.Docs.Target[i] = i;
+        }
+
+        // prefix keeps generated ids
+        THolder<TPool> prefix = SlicePool(pool, {0, 1, 2});
+        UNIT_ASSERT(!prefix->Docs.HasExplicitDocIds());
+        for (size_t i = 0; i < 3; ++i) {
+            UNIT_ASSERT_VALUES_EQUAL(prefix->Docs.GetDocId(i), pool.Docs.GetDocId(i));
+        }
+
+        const TVector<size_t> rowIndices = {7, 3, 3, 9};
+        THolder<TPool> sliced = SlicePool(pool, rowIndices);
+        UNIT_ASSERT_VALUES_EQUAL(sliced->Docs.GetDocCount(), rowIndices.size());
+        for (size_t i = 0; i < rowIndices.size(); ++i) {
+            UNIT_ASSERT_VALUES_EQUAL(sliced->Docs.GetDocId(i), ToString(IdsOffset + rowIndices[i]));
+            UNIT_ASSERT_VALUES_EQUAL(sliced->Docs.Target[i], pool.Docs.Target[rowIndices[i]]);
+        }
+
+        pool.Docs.MakeDocIdsExplicit();
+        pool.Docs.Id[3] = "explicit";
+        sliced = SlicePool(pool, rowIndices);
+        UNIT_ASSERT_VALUES_EQUAL(sliced->Docs.GetDocId(1), "explicit");
+        UNIT_ASSERT_VALUES_EQUAL(sliced->Docs.GetDocId(3), ToString(IdsOffset + 9));
     }
 }
@@ -0,0 +1,191 @@
+#include "block_codecs_input.h"
+
+#include <catboost/libs/helpers/exception.h>
+
+#include <util/digest/murmur.h>
+#include <util/generic/cast.h>
+#include <util/generic/hash.h>
+#include <util/generic/singleton.h>
+#include <util/generic/ymath.h>
+#include <util/stream/buffer.h>
+#include <util/stream/mem.h>
+#include <util/system/info.h>
+#include <util/ysaveload.h>
+
+
+namespace NCB {
+
+    namespace {
+
+    // keep in sync with the block header format in library/blockcodecs/stream.cpp
+    using TCodecID = ui16;
+    using TBlockLen = ui64;
+
+    constexpr size_t MAX_BLOCK_LEN = 1024 * 1024 * 1024;
+    constexpr size_t MAX_DECODED_BLOCK_LEN = 128 * 1024 * 1024;
+
+    struct TCodecsById {
+        TCodecsById() {
+            for (const auto& name : NBlockCodecs::ListAllCodecs()) {
+                const NBlockCodecs::ICodec* codec = NBlockCodecs::Codec(name);
+                ById[CalcCodecId(codec)] = codec;
+            }
+        }
+
+        static TCodecID CalcCodecId(const NBlockCodecs::ICodec* codec) {
+            const TStringBuf name = codec->Name();
+            const ui32 hash = MurmurHash<ui32>(~name, +name);
+            return static_cast<TCodecID>((hash >> 16) ^ (hash & 0xFFFF));
+        }
+
+        const NBlockCodecs::ICodec* Find(TCodecID id) const {
+            const auto it = ById.find(id);
+            CB_ENSURE(it != ById.end(), "Block codecs stream: can not find codec by id " << id);
+            return it->second;
+        }
+
+        THashMap<TCodecID, const NBlockCodecs::ICodec*> ById;
+    };
+
+    }
+
+
+    TParallelDecodedInput::TParallelDecodedInput(IInputStream* in, int threadCount, size_t blocksPerBatch)
+        : Input(in)
+        , InputFinished(false)
+        , BlocksPerBatch(blocksPerBatch ? blocksPerBatch : 2 * (size_t)Max(threadCount, 1))
+        , CurrentBlockIdx(0)
+    {
+        // at least one thread is needed for asynchronous reading of the next batch
+        LocalExecutor.RunAdditionalThreads(Max(threadCount, 1));
+        StartNextBatchAsync();
+    }
+
+    TParallelDecodedInput::~TParallelDecodedInput() {
+        if (NextBatchFuture.Initialized()) {
+            NextBatchFuture.Wait();
+        }
+    }
+
+    bool TParallelDecodedInput::ReadEncodedBlock(const NBlockCodecs::ICodec** codec, TBuffer* encoded) {
+        if (InputFinished) {
+            return false;
+        }
+
+        TCodecID codecId;
+        TBlockLen blockLen;
+        {
+            const size_t headerSize = sizeof(TCodecID) + sizeof(TBlockLen);
+            char header[headerSize];
+            const size_t headerBytesRead = Input->Load(header, headerSize);
+            if (headerBytesRead == 0) { // stream without eos marker
+                InputFinished = true;
+                return false;
+            }
+            CB_ENSURE(headerBytesRead == headerSize, "Block codecs stream: truncated block header");
+
+            TMemoryInput headerInput(header, headerSize);
+            ::Load(&headerInput, codecId);
+            ::Load(&headerInput, blockLen);
+        }
+
+        if (!blockLen) { // eos marker
+            InputFinished = true;
+            return false;
+        }
+        CB_ENSURE(blockLen <= MAX_BLOCK_LEN, "Block codecs stream: block size exceeds 1 GiB");
+
+        *codec = Singleton<TCodecsById>()->Find(codecId);
+        encoded->Resize(blockLen);
+        Input->LoadOrFail(encoded->Data(), blockLen);
+        return true;
+    }
+
+    void TParallelDecodedInput::ReadAndDecodeBatch(TBatch* batch) {
+        batch->Codecs.resize(BlocksPerBatch);
+        batch->Encoded.resize(BlocksPerBatch);
+
+        size_t blockCount = 0;
+        while ((blockCount < BlocksPerBatch)
+               && ReadEncodedBlock(&(batch->Codecs[blockCount]), &(batch->Encoded[blockCount])))
+        {
+            ++blockCount;
+        }
+        batch->Codecs.resize(blockCount);
+        batch->Encoded.resize(blockCount);
+        batch->Decoded.resize(blockCount);
+
+        LocalExecutor.ExecRangeWithThrow(
+            [batch] (int blockIdx) {
+                const NBlockCodecs::ICodec* codec = batch->Codecs[blockIdx];
+                const TBuffer& encoded = batch->Encoded[blockIdx];
+                CB_ENSURE(
+                    codec->DecompressedLength(encoded) <= MAX_DECODED_BLOCK_LEN,
+                    "Block codecs stream: broken stream"
+                );
+                codec->Decode(encoded, batch->Decoded[blockIdx]);
+            },
+            0,
+            SafeIntegerCast<int>(blockCount),
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+
+        // release memory for encoded data early
+        batch->Encoded.clear();
+    }
+
+    void TParallelDecodedInput::StartNextBatchAsync() {
+        auto futures = LocalExecutor.ExecRangeWithFutures(
+            [this] (int) {
+                ReadAndDecodeBatch(&NextBatch);
+            },
+            0,
+            1,
+            NPar::TLocalExecutor::HIGH_PRIORITY
+        );
+        Y_VERIFY(futures.size() == 1);
+        NextBatchFuture = std::move(futures[0]);
+    }
+
+    size_t TParallelDecodedInput::DoUnboundedNext(const void** ptr) {
+        while (true) {
+            while (CurrentBlockIdx < CurrentBatch.Decoded.size()) {
+                const TBuffer& block = CurrentBatch.Decoded[CurrentBlockIdx++];
+                if (!block.Empty()) {
+                    *ptr = block.Data();
+                    return block.Size();
+                }
+            }
+            if (!NextBatchFuture.Initialized()) {
+                return 0;
+            }
+            NextBatchFuture.GetValueSync(); // will rethrow if there was an exception during decoding
+            NextBatchFuture = NThreading::TFuture<void>();
+
+            CurrentBatch.Decoded.swap(NextBatch.Decoded);
+            CurrentBlockIdx = 0;
+            if (CurrentBatch.Decoded.empty()) {
+                return 0;
+            }
+            if (!InputFinished) {
+                StartNextBatchAsync();
+            }
+        }
+    }
+
+
+    TBuffer DecodeAllInParallel(IInputStream* in, int threadCount) {
+        TBuffer result;
+        TBufferOutput output(result);
+        TParallelDecodedInput decodedInput(in, threadCount);
+        TransferData(&decodedInput, &output);
+        output.Finish();
+        return result;
+    }
+
+    int GetDefaultDecodeThreadCount() {
+        // decoding is usually much faster than parsing, so don't take all the cores
+        return Max<int>(1, Min<int>(NSystemInfo::CachedNumberOfCpus() / 2, 8));
+    }
+
+}
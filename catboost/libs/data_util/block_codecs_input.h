@@ -0,0 +1,65 @@
+#pragma once
+
+#include <library/blockcodecs/codecs.h>
+#include <library/threading/future/future.h>
+#include <library/threading/local_executor/local_executor.h>
+
+#include <util/generic/buffer.h>
+#include <util/generic/vector.h>
+#include <util/stream/input.h>
+#include <util/stream/walk.h>
+
+
+namespace NCB {
+
+    /*
+     * Reads stream produced by NBlockCodecs::TCodedOutput (any codec from library/blockcodecs)
+     *  and decodes it in batches of blocks.
+     *  Blocks inside a batch are decoded in parallel and the next batch is read and decoded
+     *  asynchronously while the data from the current batch is consumed.
+     *
+     *  Not thread-safe (as any other IInputStream)
+     */
+    class TParallelDecodedInput : public IWalkInput {
+    public:
+        // blocksPerBatch == 0 means 'choose automatically based on threadCount'
+        TParallelDecodedInput(IInputStream* in, int threadCount, size_t blocksPerBatch = 0);
+        ~TParallelDecodedInput() override;
+
+    private:
+        struct TBatch {
+            TVector<const NBlockCodecs::ICodec*> Codecs;
+            TVector<TBuffer> Encoded;
+            TVector<TBuffer> Decoded;
+        };
+
+    private:
+        size_t DoUnboundedNext(const void** ptr) override;
+
+        // returns false if end of stream has been reached
+        bool ReadEncodedBlock(const NBlockCodecs::ICodec** codec, TBuffer* encoded);
+
+        void ReadAndDecodeBatch(TBatch* batch);
+        void StartNextBatchAsync();
+
+    private:
+        IInputStream* Input;
+        bool InputFinished;
+        size_t BlocksPerBatch;
+
+        NPar::TLocalExecutor LocalExecutor;
+
+        TBatch CurrentBatch;
+        size_t CurrentBlockIdx;
+
+        TBatch NextBatch;
+        NThreading::TFuture<void> NextBatchFuture;
+    };
+
+    // decode the whole stream produced by NBlockCodecs::TCodedOutput
+    TBuffer DecodeAllInParallel(IInputStream* in, int threadCount);
+
+    // number of threads used by default for decoding in line data readers and data providers
+    int GetDefaultDecodeThreadCount();
+
+}
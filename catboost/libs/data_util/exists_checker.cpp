@@ -24,6 +24,10 @@ namespace NCB {
     TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSFileExistsCheckerReg("file");
     TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSDsvExistsCheckerReg("dsv");
     TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSQuantizedExistsCheckerReg("quantized");
+    TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSColumnarExistsCheckerReg("columnar");
+    TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSBinaryPairsExistsCheckerReg("bin-pairs");
+    TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSBlockCodecsDsvExistsCheckerReg("bc-dsv");
+    TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSBlockCodecsQuantizedExistsCheckerReg("bc-quantized");
 
     }
 }
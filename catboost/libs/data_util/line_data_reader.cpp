@@ -1,4 +1,5 @@
 #include "line_data_reader.h"
+#include "block_codecs_input.h"
 
 #include <catboost/libs/helpers/exception.h>
 
@@ -74,9 +75,64 @@ namespace NCB {
     };
 
 
+    /* Reads dsv data from file compressed by library/blockcodecs (NBlockCodecs::TCodedOutput),
+     *  blocks are decoded in parallel and ahead of the consumer
+     */
+    class TBlockCodecsLineDataReader : public ILineDataReader {
+    public:
+        TBlockCodecsLineDataReader(const TLineDataReaderArgs& args)
+            : Args(args)
+            , IFStream(args.PathWithScheme.Path)
+            , DecodedInput(&IFStream, GetDefaultDecodeThreadCount())
+            , HeaderProcessed(!Args.Format.HasHeader)
+        {}
+
+        ui64 GetDataLineCount() override {
+            TIFStream countIFStream(Args.PathWithScheme.Path);
+            TParallelDecodedInput countDecodedInput(&countIFStream, GetDefaultDecodeThreadCount());
+            ui64 nLines = 0;
+            TString buffer;
+            while (countDecodedInput.ReadLine(buffer)) {
+                ++nLines;
+            }
+            if (Args.Format.HasHeader) {
+                --nLines;
+            }
+            return nLines;
+        }
+
+        TMaybe<TString> GetHeader() override {
+            if (Args.Format.HasHeader) {
+                CB_ENSURE(!HeaderProcessed, "TBlockCodecsLineDataReader: multiple calls to GetHeader");
+                TString header;
+                CB_ENSURE(DecodedInput.ReadLine(header), "TBlockCodecsLineDataReader: no header in file");
+                HeaderProcessed = true;
+                return header;
+            }
+
+            return {};
+        }
+
+        bool ReadLine(TString* line) override {
+            // skip header if it hasn't been read
+            if (!HeaderProcessed) {
+                GetHeader();
+            }
+            return DecodedInput.ReadLine(*line) != 0;
+        }
+
+    private:
+        TLineDataReaderArgs Args;
+        TIFStream IFStream;
+        TParallelDecodedInput DecodedInput;
+        bool HeaderProcessed;
+    };
+
+
     TLineDataReaderFactory::TRegistrator<TFileLineDataReader> DefLineDataReaderReg("");
     TLineDataReaderFactory::TRegistrator<TFileLineDataReader> FileLineDataReaderReg("file");
     TLineDataReaderFactory::TRegistrator<TFileLineDataReader> DsvLineDataReaderReg("dsv");
+    TLineDataReaderFactory::TRegistrator<TBlockCodecsLineDataReader> BlockCodecsDsvLineDataReaderReg("bc-dsv");
 
     }
 }
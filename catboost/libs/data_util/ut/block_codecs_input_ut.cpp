@@ -0,0 +1,78 @@
+#include <library/unittest/registar.h>
+
+#include <catboost/libs/data_util/block_codecs_input.h>
+
+#include <library/blockcodecs/codecs.h>
+#include <library/blockcodecs/stream.h>
+
+#include <util/generic/buffer.h>
+#include <util/generic/string.h>
+#include <util/generic/vector.h>
+#include <util/stream/buffer.h>
+#include <util/stream/mem.h>
+#include <util/string/cast.h>
+
+
+using namespace NCB;
+
+
+static TString GenerateLines(size_t lineCount) {
+    TString result;
+    for (size_t lineIdx = 0; lineIdx < lineCount; ++lineIdx) {
+        result += ToString(lineIdx) + "\t" + ToString(lineIdx * 7 % 13) + "\tsome_categ_value\n";
+    }
+    return result;
+}
+
+static TBuffer Encode(const TString& data, TStringBuf codecName, size_t blockSize) {
+    TBuffer result;
+    {
+        TBufferOutput output(result);
+        NBlockCodecs::TCodedOutput codedOutput(&output, NBlockCodecs::Codec(codecName), blockSize);
+        codedOutput.Write(data.data(), data.size());
+        codedOutput.Finish();
+    }
+    return result;
+}
+
+
+Y_UNIT_TEST_SUITE(TParallelDecodedInputTest) {
+    Y_UNIT_TEST(TestDecodeAll) {
+        const TString data = GenerateLines(10000);
+        for (auto codecName : {"lz4", "zstd_1", "null"}) {
+            for (size_t blockSize : {17, 1000, 1 << 20}) {
+                for (int threadCount : {1, 3}) {
+                    const TBuffer encoded = Encode(data, codecName, blockSize);
+                    TMemoryInput input(encoded.Data(), encoded.Size());
+                    const TBuffer decoded = DecodeAllInParallel(&input, threadCount);
+                    UNIT_ASSERT_VALUES_EQUAL(TString(decoded.Data(), decoded.Size()), data);
+                }
+            }
+        }
+    }
+
+    Y_UNIT_TEST(TestReadLine) {
+        const TString data = GenerateLines(1000);
+        const TBuffer encoded = Encode(data, "lz4", 100);
+
+        TMemoryInput input(encoded.Data(), encoded.Size());
+        TParallelDecodedInput decodedInput(&input, /*threadCount*/ 2, /*blocksPerBatch*/ 3);
+
+        TMemoryInput expectedInput(data.data(), data.size());
+        TString line;
+        TString expectedLine;
+        size_t lineCount = 0;
+        while (decodedInput.ReadLine(line)) {
+            UNIT_ASSERT(expectedInput.ReadLine(expectedLine));
+            UNIT_ASSERT_VALUES_EQUAL(line, expectedLine);
+            ++lineCount;
+        }
+        UNIT_ASSERT_VALUES_EQUAL(lineCount, 1000);
+    }
+
+    Y_UNIT_TEST(TestEmpty) {
+        const TBuffer encoded = Encode(TString(), "lz4", 100);
+        TMemoryInput input(encoded.Data(), encoded.Size());
+        UNIT_ASSERT(DecodeAllInParallel(&input, 2).Empty());
+    }
+}
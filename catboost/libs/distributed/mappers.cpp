@@ -218,7 +218,7 @@ void TBucketSimpleUpdater<TError>::DoMap(NPar::IUserContext* /*ctx*/, int /*host
     Y_ASSERT(approxDimension == 1);
     const auto error = BuildError<TError>(localData.Params, /*custom objective*/ Nothing());
     const auto estimationMethod = localData.Params.ObliviousTreeOptions->LeavesEstimationMethod;
-    const int scratchSize = error.GetErrorType() == EErrorType::PerObjectError ? APPROX_BLOCK_SIZE * CB_THREAD_LIMIT
+    const int scratchSize = error.GetErrorType() == EErrorType::PerObjectError ? 0
         : localData.PlainFold.BodyTailArr[0].BodyFinish; // plain boosting ==> not approx on full history
     TVector<TDers> weightedDers;
     weightedDers.yresize(scratchSize);
@@ -361,30 +361,16 @@ void TBucketMultiUpdater<TError>::DoMap(NPar::IUserContext* /*ctx*/, int /*hostI
     const auto error = BuildError<TError>(localData.Params, /*custom objective*/ Nothing());
     const auto estimationMethod = localData.Params.ObliviousTreeOptions->LeavesEstimationMethod;
 
-    if (estimationMethod == ELeavesEstimation::Newton) {
-        UpdateBucketsMulti(AddSampleToBucketNewtonMulti<TError>,
-            localData.Indices,
-            localData.PlainFold.LearnTarget,
-            localData.PlainFold.GetLearnWeights(),
-            localData.PlainFold.BodyTailArr[0].Approx,
-            localData.ApproxDeltas,
-            error,
-            localData.PlainFold.BodyTailArr[0].BodyFinish,
-            localData.GradientIteration,
-            &localData.MultiBuckets);
-    } else {
-        Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
-        UpdateBucketsMulti(AddSampleToBucketGradientMulti<TError>,
-            localData.Indices,
-            localData.PlainFold.LearnTarget,
-            localData.PlainFold.GetLearnWeights(),
-            localData.PlainFold.BodyTailArr[0].Approx,
-            localData.ApproxDeltas,
-            error,
-            localData.PlainFold.BodyTailArr[0].BodyFinish,
-            localData.GradientIteration,
-            &localData.MultiBuckets);
-    }
+    UpdateBucketsMulti(estimationMethod,
+        localData.Indices,
+        localData.PlainFold.LearnTarget,
+        localData.PlainFold.GetLearnWeights(),
+        localData.PlainFold.BodyTailArr[0].Approx,
+        localData.ApproxDeltas,
+        error,
+        localData.PlainFold.BodyTailArr[0].BodyFinish,
+        localData.GradientIteration,
+        &localData.MultiBuckets);
     sums->Data = std::make_pair(localData.MultiBuckets, TUnusedInitializedParam());
 }
 template void TBucketMultiUpdater<TCrossEntropyError>::DoMap(NPar::IUserContext* /*ctx*/, int /*hostId*/, TInput* /*unused*/, TOutput* sums) const;
@@ -166,6 +166,7 @@ void MapPairwiseCalcScore(double scoreStDev, TCandidateList* candidateList, TLea
                 splitInfo.SplitCandidate.Type,
                 l2Reg,
                 pairwiseBucketWeightPriorReg,
+                &ctx->LocalExecutor,
                 &scoreBins);
             allScores[subcandidateIdx] = GetScores(scoreBins);
         }
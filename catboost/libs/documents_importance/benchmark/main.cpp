@@ -0,0 +1,59 @@
+#include <catboost/libs/documents_importance/docs_importance_helpers.h>
+#include <catboost/libs/train_lib/train_model.h>
+
+#include <library/testing/benchmark/bench.h>
+
+#include <util/generic/singleton.h>
+#include <util/random/fast.h>
+
+// every benchmark iteration is the importance of one train object for all test objects, so iterations/sec is docs/sec
+namespace {
+    struct TLeafInfluenceData {
+        static constexpr ui32 DocCount = 2000;
+        static constexpr ui32 FeatureCount = 10;
+
+        TPool Pool;
+        TFullModel Model;
+
+        TLeafInfluenceData() {
+            TReallyFastRng32 rng(0);
+            Pool.Docs.Resize(DocCount, FeatureCount, /*baseline dimension*/ 0, /*has queryId*/ false, /*has subgroupId*/ false);
+            for (ui32 docId = 0; docId < DocCount; ++docId) {
+                float sum = 0;
+                for (ui32 featureId = 0; featureId < FeatureCount; ++featureId) {
+                    Pool.Docs.Factors[featureId][docId] = rng.GenRandReal1();
+                    sum += Pool.Docs.Factors[featureId][docId];
+                }
+                Pool.Docs.Target[docId] = sum + rng.GenRandReal1();
+            }
+
+            NJson::TJsonValue params;
+            params.InsertValue("iterations", 100);
+            params.InsertValue("thread_count", 1);
+            TEvalResult evalResult;
+            TrainModel(params, Nothing(), Nothing(), TClearablePoolPtrs(Pool, {&Pool}), "", &Model, {&evalResult});
+        }
+    };
+}
+
+static void CalcLeafInfluence(const TUpdateMethod& updateMethod, size_t docCount) {
+    const auto& data = *Singleton<TLeafInfluenceData>();
+    TDocumentImportancesEvaluator evaluator(data.Model, data.Pool, updateMethod, /*threadCount*/ 1);
+    for (size_t processedDocCount = 0; processedDocCount < docCount;) {
+        const ui32 trainDocCount = Min<size_t>(docCount - processedDocCount, TLeafInfluenceData::DocCount);
+        Y_DO_NOT_OPTIMIZE_AWAY(evaluator.GetDocumentImportances(data.Pool, 0, trainDocCount));
+        processedDocCount += trainDocCount;
+    }
+}
+
+Y_CPU_BENCHMARK(LeafInfluenceSinglePoint, iface) {
+    CalcLeafInfluence(TUpdateMethod(EUpdateType::SinglePoint), iface.Iterations());
+}
+
+Y_CPU_BENCHMARK(LeafInfluenceTopKLeaves, iface) {
+    CalcLeafInfluence(TUpdateMethod(EUpdateType::TopKLeaves, /*topSize*/ 2), iface.Iterations());
+}
+
+Y_CPU_BENCHMARK(LeafInfluenceAllPoints, iface) {
+    CalcLeafInfluence(TUpdateMethod(EUpdateType::AllPoints), iface.Iterations());
+}
@@ -3,7 +3,21 @@
 
 #include <catboost/libs/algo/index_calcer.h>
 
+#include <util/generic/algorithm.h>
+
+// jacobians of a batch of removed train objects take up to this memory
+static constexpr size_t JACOBIANS_BATCH_MEMORY = 64 << 20;
+
 TVector<TVector<double>> TDocumentImportancesEvaluator::GetDocumentImportances(const TPool& pool) {
+    return GetDocumentImportances(pool, 0, DocCount);
+}
+
+TVector<TVector<double>> TDocumentImportancesEvaluator::GetDocumentImportances(
+    const TPool& pool,
+    ui32 trainDocBegin,
+    ui32 trainDocEnd
+) {
+    CB_ENSURE(trainDocBegin <= trainDocEnd && trainDocEnd <= DocCount, "Invalid range of train objects");
     NPar::TLocalExecutor localExecutor;
     localExecutor.RunAdditionalThreads(ThreadCount - 1);
 
@@ -14,17 +28,31 @@ TVector<TVector<double>> TDocumentImportancesEvaluator::GetDocumentImportances(c
     }, NPar::TLocalExecutor::TExecRangeParams(0, TreeCount), NPar::TLocalExecutor::WAIT_COMPLETE);
 
     UpdateFinalFirstDerivatives(leafIndices, pool);
-    TVector<TVector<double>> documentImportances(DocCount, TVector<double>(pool.Docs.GetDocCount()));
-
-    localExecutor.ExecRange([&] (int docId) {
-        // The derivative of leaf values with respect to train doc weight.
-        TVector<TVector<TVector<double>>> leafDerivatives(TreeCount, TVector<TVector<double>>(LeavesEstimationIterations)); // [treeCount][LeavesEstimationIterationsCount][leafCount]
-        UpdateLeavesDerivatives(docId, &leafDerivatives);
-        GetDocumentImportancesForOneTrainDoc(leafDerivatives, leafIndices, &documentImportances[docId]);
-    }, NPar::TLocalExecutor::TExecRangeParams(0, DocCount), NPar::TLocalExecutor::WAIT_COMPLETE);
+    TVector<TVector<double>> documentImportances(trainDocEnd - trainDocBegin, TVector<double>(pool.Docs.GetDocCount()));
+
+    const ui32 batchSize = GetRemovedDocsBatchSize();
+    const ui32 batchCount = (trainDocEnd - trainDocBegin + batchSize - 1) / batchSize;
+    localExecutor.ExecRange([&] (int batchId) {
+        const ui32 removedDocBegin = trainDocBegin + batchId * batchSize;
+        const ui32 removedDocCount = Min(batchSize, trainDocEnd - removedDocBegin);
+        // The derivative of leaf values with respect to train doc weights.
+        TVector<TVector<double>> leafDerivatives(TreeCount * LeavesEstimationIterations);
+        UpdateLeavesDerivatives(removedDocBegin, removedDocCount, &leafDerivatives);
+        GetDocumentImportancesForTrainDocs(
+            leafDerivatives,
+            leafIndices,
+            removedDocCount,
+            &documentImportances[removedDocBegin - trainDocBegin]
+        );
+    }, NPar::TLocalExecutor::TExecRangeParams(0, batchCount), NPar::TLocalExecutor::WAIT_COMPLETE);
     return documentImportances;
 }
 
+ui32 TDocumentImportancesEvaluator::GetRemovedDocsBatchSize() const {
+    const size_t jacobianSize = Max<size_t>(DocCount, 1) * sizeof(double);
+    return Max<size_t>(1, Min<size_t>(MaxRemovedDocsBatchSize, JACOBIANS_BATCH_MEMORY / jacobianSize));
+}
+
 void TDocumentImportancesEvaluator::UpdateFinalFirstDerivatives(const TVector<TVector<ui32>>& leafIndices, const TPool& pool) {
     const ui32 docCount = pool.Docs.GetDocCount();
     TVector<double> finalApproxes(docCount);
@@ -43,47 +71,71 @@ void TDocumentImportancesEvaluator::UpdateFinalFirstDerivatives(const TVector<TV
     EvaluateDerivatives(LossFunction, LeafEstimationMethod, finalApproxes, pool, &FinalFirstDerivatives, nullptr, nullptr);
 }
 
-TVector<ui32> TDocumentImportancesEvaluator::GetLeafIdToUpdate(ui32 treeId, const TVector<double>& jacobian) {
-    TVector<ui32> leafIdToUpdate;
+void TDocumentImportancesEvaluator::GetLeavesToUpdate(
+    ui32 treeId,
+    const TVector<double>& jacobian,
+    ui32 batchSize,
+    TVector<ui8>* isLeafUpdated
+) {
     const ui32 leafCount = 1 << Model.ObliviousTrees.TreeSizes[treeId];
+    isLeafUpdated->assign(leafCount * batchSize, false);
 
     if (UpdateMethod.UpdateType == EUpdateType::AllPoints) {
-        leafIdToUpdate.resize(leafCount);
-        std::iota(leafIdToUpdate.begin(), leafIdToUpdate.end(), 0);
+        Fill(isLeafUpdated->begin(), isLeafUpdated->end(), true);
     } else if (UpdateMethod.UpdateType == EUpdateType::TopKLeaves) {
-        const TVector<ui32>& leafIndices = TreesStatistics[treeId].LeafIndices;
-        TVector<double> leafJacobians(leafCount);
-        for (ui32 docId = 0; docId < DocCount; ++docId) {
-            leafJacobians[leafIndices[docId]] += Abs(jacobian[docId]);
+        const ui32 topSize = Min<ui32>(UpdateMethod.TopSize, leafCount);
+        // the top doesn't depend on the jacobian in these cases
+        if (topSize == 0) {
+            return;
+        }
+        if (topSize == leafCount) {
+            Fill(isLeafUpdated->begin(), isLeafUpdated->end(), true);
+            return;
+        }
+
+        const TTreeStatistics& treeStatistics = TreesStatistics[treeId];
+        TVector<double> leafJacobians(leafCount * batchSize);
+        for (ui32 leafId = 0; leafId < leafCount; ++leafId) {
+            double* leafJacobiansRef = &leafJacobians[leafId * batchSize];
+            for (ui32 docId : treeStatistics.LeavesDocId[leafId]) {
+                const double* docJacobians = &jacobian[docId * batchSize];
+                for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+                    leafJacobiansRef[batchIdx] += Abs(docJacobians[batchIdx]);
+                }
+            }
         }
 
         TVector<ui32> orderedLeafIndices(leafCount);
-        std::iota(orderedLeafIndices.begin(), orderedLeafIndices.end(), 0);
-        Sort(orderedLeafIndices.begin(), orderedLeafIndices.end(), [&](ui32 firstDocId, ui32 secondDocId) {
-            return leafJacobians[firstDocId] > leafJacobians[secondDocId];
-        });
-
-        leafIdToUpdate = TVector<ui32>(
-            orderedLeafIndices.begin(),
-            orderedLeafIndices.begin() + Min<ui32>(UpdateMethod.TopSize, leafCount)
-        );
+        for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+            std::iota(orderedLeafIndices.begin(), orderedLeafIndices.end(), 0);
+            Sort(orderedLeafIndices.begin(), orderedLeafIndices.end(), [&](ui32 firstLeafId, ui32 secondLeafId) {
+                return leafJacobians[firstLeafId * batchSize + batchIdx] > leafJacobians[secondLeafId * batchSize + batchIdx];
+            });
+            for (ui32 i = 0; i < topSize; ++i) {
+                (*isLeafUpdated)[orderedLeafIndices[i] * batchSize + batchIdx] = true;
+            }
+        }
     }
-
-    return leafIdToUpdate;
 }
 
-void TDocumentImportancesEvaluator::UpdateLeavesDerivatives(ui32 removedDocId, TVector<TVector<TVector<double>>>* leafDerivatives) {
-    TVector<double> jacobian(DocCount);
+void TDocumentImportancesEvaluator::UpdateLeavesDerivatives(
+    ui32 removedDocBegin,
+    ui32 batchSize,
+    TVector<TVector<double>>* leafDerivatives
+) {
+    TVector<double> jacobian(DocCount * batchSize);
+    TVector<ui8> isLeafUpdated;
     for (ui32 treeId = 0; treeId < TreeCount; ++treeId) {
         auto& treeStatistics = TreesStatistics[treeId];
         for (ui32 it = 0; it < LeavesEstimationIterations; ++it) {
-            const TVector<ui32> leafIdToUpdate = GetLeafIdToUpdate(treeId, jacobian);
-            TVector<double>& leafDerivativesRef = (*leafDerivatives)[treeId][it];
+            GetLeavesToUpdate(treeId, jacobian, batchSize, &isLeafUpdated);
+            TVector<double>& leafDerivativesRef = (*leafDerivatives)[treeId * LeavesEstimationIterations + it];
 
             // Updating Leaves Derivatives
             UpdateLeavesDerivativesForTree(
-                leafIdToUpdate,
-                removedDocId,
+                isLeafUpdated,
+                removedDocBegin,
+                batchSize,
                 jacobian,
                 treeId,
                 it,
@@ -91,47 +143,65 @@ void TDocumentImportancesEvaluator::UpdateLeavesDerivatives(ui32 removedDocId, T
             );
 
             // Updating Jacobian
-            bool isRemovedDocUpdated = false;
-            for (ui32 leafId : leafIdToUpdate) {
+            for (ui32 leafId = 0; leafId < treeStatistics.LeafCount; ++leafId) {
+                const ui8* isLeafUpdatedRef = &isLeafUpdated[leafId * batchSize];
+                if (!AnyOf(isLeafUpdatedRef, isLeafUpdatedRef + batchSize, [](ui8 isUpdated) { return isUpdated; })) {
+                    continue;
+                }
+                const double* leafDerivativesForLeaf = &leafDerivativesRef[leafId * batchSize];
                 for (ui32 docId : treeStatistics.LeavesDocId[leafId]) {
-                    jacobian[docId] += leafDerivativesRef[leafId];
+                    double* docJacobians = &jacobian[docId * batchSize];
+                    for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+                        docJacobians[batchIdx] += isLeafUpdatedRef[batchIdx] ? leafDerivativesForLeaf[batchIdx] : 0.0;
+                    }
                 }
-                isRemovedDocUpdated |= (treeStatistics.LeafIndices[removedDocId] == leafId);
             }
-            if (!isRemovedDocUpdated) {
-                ui32 removedDocLeafId = treeStatistics.LeafIndices[removedDocId];
-                jacobian[removedDocId] += leafDerivativesRef[removedDocLeafId];
+            for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+                const ui32 removedDocId = removedDocBegin + batchIdx;
+                const ui32 removedDocLeafId = treeStatistics.LeafIndices[removedDocId];
+                if (!isLeafUpdated[removedDocLeafId * batchSize + batchIdx]) {
+                    jacobian[removedDocId * batchSize + batchIdx] += leafDerivativesRef[removedDocLeafId * batchSize + batchIdx];
+                }
             }
         }
     }
 }
 
-void TDocumentImportancesEvaluator::GetDocumentImportancesForOneTrainDoc(
-    const TVector<TVector<TVector<double>>>& leafDerivatives,
+void TDocumentImportancesEvaluator::GetDocumentImportancesForTrainDocs(
+    const TVector<TVector<double>>& leafDerivatives,
     const TVector<TVector<ui32>>& leafIndices,
-    TVector<double>* documentImportance
+    ui32 batchSize,
+    TVector<double>* documentImportances
 ) {
-    const ui32 docCount = documentImportance->size();
-    TVector<double> predictedDerivatives(docCount);
+    const ui32 docCount = documentImportances[0].size();
+    TVector<double> predictedDerivatives(docCount * batchSize);
 
     for (ui32 treeId = 0; treeId < TreeCount; ++treeId) {
         const TVector<ui32>& leafIndicesRef = leafIndices[treeId];
         for (ui32 it = 0; it < LeavesEstimationIterations; ++it) {
-            const TVector<double>& leafDerivativesRef = leafDerivatives[treeId][it];
+            const TVector<double>& leafDerivativesRef = leafDerivatives[treeId * LeavesEstimationIterations + it];
             for (ui32 docId = 0; docId < docCount; ++docId) {
-                predictedDerivatives[docId] += leafDerivativesRef[leafIndicesRef[docId]];
+                const double* leafDerivativesForLeaf = &leafDerivativesRef[leafIndicesRef[docId] * batchSize];
+                double* docPredictedDerivatives = &predictedDerivatives[docId * batchSize];
+                for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+                    docPredictedDerivatives[batchIdx] += leafDerivativesForLeaf[batchIdx];
+                }
             }
         }
     }
 
-    for (ui32 docId = 0; docId < docCount; ++docId) {
-        (*documentImportance)[docId] = FinalFirstDerivatives[docId] * predictedDerivatives[docId];
+    for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+        TVector<double>& documentImportance = documentImportances[batchIdx];
+        for (ui32 docId = 0; docId < docCount; ++docId) {
+            documentImportance[docId] = FinalFirstDerivatives[docId] * predictedDerivatives[docId * batchSize + batchIdx];
+        }
     }
 }
 
 void TDocumentImportancesEvaluator::UpdateLeavesDerivativesForTree(
-    const TVector<ui32>& leafIdToUpdate,
-    ui32 removedDocId,
+    const TVector<ui8>& isLeafUpdated,
+    ui32 removedDocBegin,
+    ui32 batchSize,
     const TVector<double>& jacobian,
     ui32 treeId,
     ui32 leavesEstimationIteration,
@@ -142,24 +212,44 @@ void TDocumentImportancesEvaluator::UpdateLeavesDerivativesForTree(
     const TVector<double>& formulaNumeratorMultiplier = treeStatistics.FormulaNumeratorMultiplier[leavesEstimationIteration];
     const TVector<double>& formulaNumeratorAdding = treeStatistics.FormulaNumeratorAdding[leavesEstimationIteration];
     const TVector<double>& formulaDenominators = treeStatistics.FormulaDenominators[leavesEstimationIteration];
-    const ui32 removedDocLeafId = treeStatistics.LeafIndices[removedDocId];
 
-    leafDerivativesRef.resize(treeStatistics.LeafCount);
+    leafDerivativesRef.resize(treeStatistics.LeafCount * batchSize);
     Fill(leafDerivativesRef.begin(), leafDerivativesRef.end(), 0);
-    bool isRemovedDocUpdated = false;
-    for (ui32 leafId : leafIdToUpdate) {
-        for (ui32 docId : treeStatistics.LeavesDocId[leafId]) {
-            leafDerivativesRef[leafId] += formulaNumeratorMultiplier[docId] * jacobian[docId];
+    // numerator sums are evaluated for the whole batch if the leaf is updated for some of removed objects
+    for (ui32 leafId = 0; leafId < treeStatistics.LeafCount; ++leafId) {
+        const ui8* isLeafUpdatedRef = &isLeafUpdated[leafId * batchSize];
+        if (!AnyOf(isLeafUpdatedRef, isLeafUpdatedRef + batchSize, [](ui8 isUpdated) { return isUpdated; })) {
+            continue;
         }
-        if (leafId == removedDocLeafId) {
-            leafDerivativesRef[leafId] += formulaNumeratorAdding[removedDocId];
+        double* leafDerivativesForLeaf = &leafDerivativesRef[leafId * batchSize];
+        for (ui32 docId : treeStatistics.LeavesDocId[leafId]) {
+            const double multiplier = formulaNumeratorMultiplier[docId];
+            const double* docJacobians = &jacobian[docId * batchSize];
+            for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+                leafDerivativesForLeaf[batchIdx] += multiplier * docJacobians[batchIdx];
+            }
         }
-        leafDerivativesRef[leafId] *= -LearningRate / formulaDenominators[leafId];
-        isRemovedDocUpdated |= (leafId == removedDocLeafId);
     }
-    if (!isRemovedDocUpdated) {
-        leafDerivativesRef[removedDocLeafId] += jacobian[removedDocId] * formulaNumeratorMultiplier[removedDocId];
-        leafDerivativesRef[removedDocLeafId] += formulaNumeratorAdding[removedDocId];
-        leafDerivativesRef[removedDocLeafId] *= -LearningRate / formulaDenominators[removedDocLeafId];
+
+    for (ui32 batchIdx = 0; batchIdx < batchSize; ++batchIdx) {
+        const ui32 removedDocId = removedDocBegin + batchIdx;
+        const ui32 removedDocLeafId = treeStatistics.LeafIndices[removedDocId];
+        for (ui32 leafId = 0; leafId < treeStatistics.LeafCount; ++leafId) {
+            double& leafDerivative = leafDerivativesRef[leafId * batchSize + batchIdx];
+            if (!isLeafUpdated[leafId * batchSize + batchIdx]) {
+                leafDerivative = 0;
+                continue;
+            }
+            if (leafId == removedDocLeafId) {
+                leafDerivative += formulaNumeratorAdding[removedDocId];
+            }
+            leafDerivative *= -LearningRate / formulaDenominators[leafId];
+        }
+        if (!isLeafUpdated[removedDocLeafId * batchSize + batchIdx]) {
+            double& leafDerivative = leafDerivativesRef[removedDocLeafId * batchSize + batchIdx];
+            leafDerivative += jacobian[removedDocId * batchSize + batchIdx] * formulaNumeratorMultiplier[removedDocId];
+            leafDerivative += formulaNumeratorAdding[removedDocId];
+            leafDerivative *= -LearningRate / formulaDenominators[removedDocLeafId];
+        }
     }
 }
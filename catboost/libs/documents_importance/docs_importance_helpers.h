@@ -61,24 +61,38 @@ public:
 
     // Getting the importance of all train objects for all objects from pool.
     TVector<TVector<double>> GetDocumentImportances(const TPool& pool);
+    // Getting the importance of train objects from [trainDocBegin, trainDocEnd) for all objects from pool.
+    TVector<TVector<double>> GetDocumentImportances(const TPool& pool, ui32 trainDocBegin, ui32 trainDocEnd);
+
+    // Results don't depend on the batch size, batchSize = 1 evaluates each removed train object separately.
+    void SetMaxRemovedDocsBatchSize(ui32 batchSize) {
+        CB_ENSURE(batchSize > 0, "Batch size of removed train objects should be positive");
+        MaxRemovedDocsBatchSize = batchSize;
+    }
 
 private:
+    /* Removed train objects are processed by batches, so that statistics of each tree are read once per batch.
+     * Per-batch vectors are stored as [docId * batchSize + batchIdx] and [leafId * batchSize + batchIdx].
+     */
+    ui32 GetRemovedDocsBatchSize() const;
     // Evaluate first derivatives at the final approxes
     void UpdateFinalFirstDerivatives(const TVector<TVector<ui32>>& leafIndices, const TPool& pool);
-    // Leaves derivatives will be updated based on objects from these leaves.
-    TVector<ui32> GetLeafIdToUpdate(ui32 treeId, const TVector<double>& jacobian);
-    // Algorithm 4 from paper.
-    void UpdateLeavesDerivatives(ui32 removedDocId, TVector<TVector<TVector<double>>>* leafDerivatives);
-    // Getting the importance of one train object for all objects from pool.
-    void GetDocumentImportancesForOneTrainDoc(
-        const TVector<TVector<TVector<double>>>& leafDerivatives,
+    // Leaves derivatives will be updated based on objects from these leaves (separately for each removed object).
+    void GetLeavesToUpdate(ui32 treeId, const TVector<double>& jacobian, ui32 batchSize, TVector<ui8>* isLeafUpdated);
+    // Algorithm 4 from paper, leafDerivatives are [treeCount * LeavesEstimationIterationsCount][leafCount * batchSize].
+    void UpdateLeavesDerivatives(ui32 removedDocBegin, ui32 batchSize, TVector<TVector<double>>* leafDerivatives);
+    // Getting the importance of a batch of train objects for all objects from pool.
+    void GetDocumentImportancesForTrainDocs(
+        const TVector<TVector<double>>& leafDerivatives,
         const TVector<TVector<ui32>>& leafIndices,
-        TVector<double>* documentImportance
+        ui32 batchSize,
+        TVector<double>* documentImportances
     );
-    // Evaluate leaf derivatives at a given removedDocId weight (Equation (6) from paper).
+    // Evaluate leaf derivatives at given removed objects weights (Equation (6) from paper).
     void UpdateLeavesDerivativesForTree(
-        const TVector<ui32>& leafIdToUpdate,
-        ui32 removedDocId,
+        const TVector<ui8>& isLeafUpdated,
+        ui32 removedDocBegin,
+        ui32 batchSize,
         const TVector<double>& jacobian,
         ui32 treeId,
         ui32 leavesEstimationIteration,
@@ -97,4 +111,5 @@ private:
     ui32 TreeCount;
     ui32 DocCount;
     int ThreadCount;
+    ui32 MaxRemovedDocsBatchSize = 16;
 };
@@ -0,0 +1,74 @@
+#include <catboost/libs/documents_importance/docs_importance_helpers.h>
+#include <catboost/libs/train_lib/train_model.h>
+
+#include <library/unittest/registar.h>
+
+#include <util/random/fast.h>
+
+static TPool CreateRandomPool(ui32 docCount, ui32 featureCount, ui32 seed) {
+    TReallyFastRng32 rng(seed);
+    TPool pool;
+    pool.Docs.Resize(docCount, featureCount, /*baseline dimension*/ 0, /*has queryId*/ false, /*has subgroupId*/ false);
+    for (ui32 docId = 0; docId < docCount; ++docId) {
+        float sum = 0;
+        for (ui32 featureId = 0; featureId < featureCount; ++featureId) {
+            pool.Docs.Factors[featureId][docId] = rng.GenRandReal1();
+            sum += pool.Docs.Factors[featureId][docId];
+        }
+        pool.Docs.Target[docId] = sum + rng.GenRandReal1();
+    }
+    return pool;
+}
+
+Y_UNIT_TEST_SUITE(TDocumentImportancesTest) {
+    // removed train objects evaluated by batches should have the same importances as evaluated one by one
+    Y_UNIT_TEST(TestBatchedImportancesEqualUnbatched) {
+        TPool trainPool = CreateRandomPool(/*docCount*/ 100, /*featureCount*/ 5, /*seed*/ 0);
+        TPool testPool = CreateRandomPool(/*docCount*/ 30, /*featureCount*/ 5, /*seed*/ 1);
+
+        for (const auto& leafEstimationMethod : {"Gradient", "Newton"}) {
+            NJson::TJsonValue params;
+            params.InsertValue("iterations", 10);
+            params.InsertValue("depth", 3);
+            params.InsertValue("leaf_estimation_method", leafEstimationMethod);
+            params.InsertValue("leaf_estimation_iterations", 2);
+            params.InsertValue("thread_count", 1);
+            TFullModel model;
+            TEvalResult evalResult;
+            TrainModel(params, Nothing(), Nothing(), TClearablePoolPtrs(trainPool, {&testPool}), "", &model, {&evalResult});
+
+            for (const auto& updateMethod : {
+                TUpdateMethod(EUpdateType::SinglePoint),
+                TUpdateMethod(EUpdateType::TopKLeaves, /*topSize*/ 2),
+                TUpdateMethod(EUpdateType::AllPoints)
+            }) {
+                TDocumentImportancesEvaluator batchedEvaluator(model, trainPool, updateMethod, /*threadCount*/ 2);
+                // the last batch is incomplete
+                batchedEvaluator.SetMaxRemovedDocsBatchSize(16);
+                const auto batchedImportances = batchedEvaluator.GetDocumentImportances(testPool);
+
+                TDocumentImportancesEvaluator unbatchedEvaluator(model, trainPool, updateMethod, /*threadCount*/ 1);
+                unbatchedEvaluator.SetMaxRemovedDocsBatchSize(1);
+                const auto unbatchedImportances = unbatchedEvaluator.GetDocumentImportances(testPool);
+
+                UNIT_ASSERT_VALUES_EQUAL(batchedImportances.size(), trainPool.Docs.GetDocCount());
+                UNIT_ASSERT_VALUES_EQUAL(unbatchedImportances.size(), trainPool.Docs.GetDocCount());
+                for (ui32 trainDocId = 0; trainDocId < batchedImportances.size(); ++trainDocId) {
+                    UNIT_ASSERT_VALUES_EQUAL(batchedImportances[trainDocId].size(), testPool.Docs.GetDocCount());
+                    for (ui32 testDocId = 0; testDocId < batchedImportances[trainDocId].size(); ++testDocId) {
+                        UNIT_ASSERT_DOUBLES_EQUAL(batchedImportances[trainDocId][testDocId], unbatchedImportances[trainDocId][testDocId], 1e-12);
+                    }
+                }
+
+                // a range of train objects has the same importances as in the whole evaluation
+                const auto rangeImportances = batchedEvaluator.GetDocumentImportances(testPool, 10, 30);
+                UNIT_ASSERT_VALUES_EQUAL(rangeImportances.size(), 20);
+                for (ui32 idx = 0; idx < rangeImportances.size(); ++idx) {
+                    for (ui32 testDocId = 0; testDocId < rangeImportances[idx].size(); ++testDocId) {
+                        UNIT_ASSERT_DOUBLES_EQUAL(rangeImportances[idx][testDocId], batchedImportances[10 + idx][testDocId], 1e-12);
+                    }
+                }
+            }
+        }
+    }
+}
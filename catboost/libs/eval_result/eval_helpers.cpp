@@ -296,6 +296,31 @@ namespace {
         const TString Header;
     };
 
+    class TDocIdPrinter: public IColumnPrinter {
+    public:
+        TDocIdPrinter(const TDocumentStorage& docs, const TString& header)
+            : Docs(docs)
+            , Header(header)
+        {
+        }
+
+        void OutputValue(IOutputStream* outStream, size_t docIndex) override {
+            if (Docs.HasExplicitDocIds()) {
+                *outStream << Docs.Id[docIndex];
+            } else {
+                *outStream << Docs.GeneratedIdsOffset + docIndex;
+            }
+        }
+
+        void OutputHeader(IOutputStream* outStream) override {
+            *outStream << Header;
+        }
+
+    private:
+        const TDocumentStorage& Docs;
+        const TString Header;
+    };
+
     template <typename T>
     class TPrefixPrinter: public IColumnPrinter {
     public:
@@ -593,11 +618,15 @@ void TEvalResult::OutputToFile(
                 if (testFileWhichOf.second > 1) {
                     columnPrinter.push_back(MakeHolder<TPrefixPrinter<TString>>(ToString(testFileWhichOf.first), "EvalSet", ":"));
                 }
-                columnPrinter.push_back(MakeHolder<TVectorPrinter<TString>>(pool.Docs.Id, "DocId"));
+                columnPrinter.push_back(MakeHolder<TDocIdPrinter>(pool.Docs, "DocId"));
                 continue;
             }
             if (outputType == EColumn::Timestamp) {
-                columnPrinter.push_back(MakeHolder<TVectorPrinter<ui64>>(pool.Docs.Timestamp, columnName));
+                if (pool.Docs.Timestamp.empty()) { // timestamps are not stored if they were not specified
+                    columnPrinter.push_back(MakeHolder<TPrefixPrinter<TString>>("0", columnName, "\t"));
+                } else {
+                    columnPrinter.push_back(MakeHolder<TVectorPrinter<ui64>>(pool.Docs.Timestamp, columnName));
+                }
                 continue;
             }
             if (outputType == EColumn::Weight) {
@@ -1,5 +1,6 @@
 #include "calc_fstr.h"
 #include "feature_str.h"
+#include "loss_function_change.h"
 #include "shap_values.h"
 #include "util.h"
 
@@ -339,6 +340,18 @@ TVector<TVector<double>> GetFeatureImportances(const TString& type,
 
             return CalcShapValues(model, *pool, &localExecutor, logPeriod);
         }
+        case EFstrType::LossFunctionChange: {
+            CB_ENSURE(pool, "dataset is not provided");
+
+            NPar::TLocalExecutor localExecutor;
+            localExecutor.RunAdditionalThreads(threadCount - 1);
+
+            TVector<TVector<double>> result;
+            for (const auto& featureLossChange : CalcLossFunctionChange(model, *pool, /*sampleRate*/ 1.0, /*randomSeed*/ 0, &localExecutor)) {
+                result.push_back({featureLossChange.Score});
+            }
+            return result;
+        }
         default:
             Y_UNREACHABLE();
     }
@@ -0,0 +1,341 @@
+#include "loss_function_change.h"
+#include "util.h"
+
+#include <catboost/libs/algo/index_calcer.h>
+#include <catboost/libs/data_new/features_layout.h>
+#include <catboost/libs/helpers/exception.h>
+#include <catboost/libs/helpers/query_info_helper.h>
+#include <catboost/libs/labels/label_converter.h>
+#include <catboost/libs/labels/label_helper_builder.h>
+#include <catboost/libs/metrics/metric.h>
+#include <catboost/libs/options/json_helper.h>
+#include <catboost/libs/options/loss_description.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/xrange.h>
+#include <util/generic/ymath.h>
+#include <util/random/fast.h>
+#include <util/random/shuffle.h>
+
+// documents are binarized and leaf indices of all trees are cached by blocks of up to this size
+static constexpr int LOSS_CHANGE_BLOCK_SIZE = 1 << 12;
+static constexpr int LOSS_CHANGE_MIN_BLOCK_SIZE = 1 << 8;
+// blocks of models with many trees are smaller, so that cached leaf indices of a block take up to this memory
+static constexpr size_t LOSS_CHANGE_LEAF_INDICES_MEMORY = 16 << 20;
+// two-sided 95% quantile of the normal distribution
+static constexpr double CONFIDENCE_QUANTILE = 1.959964;
+
+namespace {
+    // trees with splits depending on a feature and differences of their leaf values after removal of these splits
+    struct TFeatureTreeDeltas {
+        TVector<int> Trees;
+        TVector<ui64> DeltasOffsets;    // [treeIdx in Trees]
+        TVector<double> LeafDeltas;     // [DeltasOffsets[i] + leafIdx * approxDimension + dimension]
+    };
+}
+
+static THolder<IMetric> CreateModelLossMetric(const TFullModel& model) {
+    CB_ENSURE(model.ModelInfo.has("params"), "LossFunctionChange requires training parameters in the model");
+    NCatboostOptions::TLossDescription lossDescription;
+    lossDescription.Load(ReadTJsonValue(model.ModelInfo.at("params"))["loss_function"]);
+    TVector<THolder<IMetric>> metrics = CreateMetricFromDescription(lossDescription, model.ObliviousTrees.ApproxDimension);
+    CB_ENSURE(!metrics.empty(), "No metric for loss function " << lossDescription.GetLossFunction());
+    THolder<IMetric> metric = std::move(metrics.front());
+    CB_ENSURE(metric->IsAdditiveMetric(), "LossFunctionChange is not supported for non-additive loss " << metric->GetDescription());
+    CB_ENSURE(metric->GetErrorType() != EErrorType::PairwiseError,
+        "LossFunctionChange is not supported for pairwise loss " << metric->GetDescription());
+    return metric;
+}
+
+// external indices of features a split depends on
+static TVector<int> GetSplitExternalFeatures(const TModelSplit& split, const NCB::TFeaturesLayout& layout) {
+    TVector<int> result;
+    switch (split.Type) {
+        case ESplitType::FloatFeature:
+            result.push_back(layout.GetExternalFeatureIdx(split.FloatFeature.FloatFeature, EFeatureType::Float));
+            break;
+        case ESplitType::OneHotFeature:
+            result.push_back(layout.GetExternalFeatureIdx(split.OneHotFeature.CatFeatureIdx, EFeatureType::Categorical));
+            break;
+        case ESplitType::OnlineCtr: {
+            const auto& projection = split.OnlineCtr.Ctr.Base.Projection;
+            for (const auto& binFeature : projection.BinFeatures) {
+                result.push_back(layout.GetExternalFeatureIdx(binFeature.FloatFeature, EFeatureType::Float));
+            }
+            for (int catFeature : projection.CatFeatures) {
+                result.push_back(layout.GetExternalFeatureIdx(catFeature, EFeatureType::Categorical));
+            }
+            for (const auto& oneHotFeature : projection.OneHotFeatures) {
+                result.push_back(layout.GetExternalFeatureIdx(oneHotFeature.CatFeatureIdx, EFeatureType::Categorical));
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+static TVector<TFeatureTreeDeltas> CalcFeatureTreeDeltas(
+    const TFullModel& model,
+    const TVector<TVector<double>>& leafWeights,
+    int externalFeatureCount
+) {
+    const auto& trees = model.ObliviousTrees;
+    const int approxDimension = trees.ApproxDimension;
+    NCB::TFeaturesLayout layout(trees.FloatFeatures, trees.CatFeatures);
+    const auto& binFeatures = trees.GetBinFeatures();
+
+    TVector<TFeatureTreeDeltas> result(externalFeatureCount);
+    for (int treeIdx : xrange(trees.GetTreeCount())) {
+        // leaf index bits of splits depending on each feature
+        THashMap<int, ui32> featureSplitMasks;
+        const int treeDepth = trees.TreeSizes[treeIdx];
+        for (int depth : xrange(treeDepth)) {
+            const TModelSplit& split = binFeatures[trees.TreeSplits[trees.TreeStartOffsets[treeIdx] + depth]];
+            for (int feature : GetSplitExternalFeatures(split, layout)) {
+                featureSplitMasks[feature] |= 1u << depth;
+            }
+        }
+
+        const ui32 leafCount = 1u << treeDepth;
+        const double* leafValues = trees.GetFirstLeafPtrForTree(treeIdx);
+        TVector<double> weightedValueSums(leafCount * approxDimension);
+        TVector<double> weightSums(leafCount);
+        for (const auto& featureSplitMask : featureSplitMasks) {
+            const ui32 keptBitsMask = ~featureSplitMask.second;
+            Fill(weightedValueSums.begin(), weightedValueSums.end(), 0.0);
+            Fill(weightSums.begin(), weightSums.end(), 0.0);
+            for (ui32 leafIdx : xrange(leafCount)) {
+                const ui32 mergedLeafIdx = leafIdx & keptBitsMask;
+                const double weight = leafWeights[treeIdx][leafIdx];
+                weightSums[mergedLeafIdx] += weight;
+                for (int dimension : xrange(approxDimension)) {
+                    weightedValueSums[mergedLeafIdx * approxDimension + dimension] += weight * leafValues[leafIdx * approxDimension + dimension];
+                }
+            }
+
+            TFeatureTreeDeltas& featureDeltas = result[featureSplitMask.first];
+            featureDeltas.Trees.push_back(treeIdx);
+            featureDeltas.DeltasOffsets.push_back(featureDeltas.LeafDeltas.size());
+            for (ui32 leafIdx : xrange(leafCount)) {
+                const ui32 mergedLeafIdx = leafIdx & keptBitsMask;
+                for (int dimension : xrange(approxDimension)) {
+                    const double leafValue = leafValues[leafIdx * approxDimension + dimension];
+                    // leaves without weight are kept as is
+                    const double mergedValue = weightSums[mergedLeafIdx] > 0
+                        ? weightedValueSums[mergedLeafIdx * approxDimension + dimension] / weightSums[mergedLeafIdx]
+                        : leafValue;
+                    featureDeltas.LeafDeltas.push_back(mergedValue - leafValue);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// documents (or groups) are sampled in random order, so that consecutive blocks of the sample are random too
+static void SamplePool(const TPool& pool, double sampleRate, ui64 randomSeed, TPool* sample) {
+    const auto& docs = pool.Docs;
+    const int docCount = docs.GetDocCount();
+    TVector<std::pair<int, int>> units; // [begin, end) of documents
+    for (int begin = 0; begin < docCount;) {
+        int end = begin + 1;
+        while (!docs.QueryId.empty() && end < docCount && docs.QueryId[end] == docs.QueryId[begin]) {
+            ++end;
+        }
+        units.emplace_back(begin, end);
+        begin = end;
+    }
+
+    TFastRng64 rand(randomSeed);
+    EraseIf(units, [&](const std::pair<int, int>&) { return rand.GenRandReal1() >= sampleRate; });
+    Shuffle(units.begin(), units.end(), rand);
+
+    int sampleDocCount = 0;
+    for (const auto& unit : units) {
+        sampleDocCount += unit.second - unit.first;
+    }
+    sample->Docs.Resize(
+        sampleDocCount,
+        docs.GetEffectiveFactorCount(),
+        docs.GetBaselineDimension(),
+        !docs.QueryId.empty(),
+        !docs.SubgroupId.empty(),
+        !docs.Timestamp.empty()
+    );
+    int sampleDocIdx = 0;
+    for (const auto& unit : units) {
+        for (int docIdx = unit.first; docIdx < unit.second; ++docIdx) {
+            sample->Docs.AssignDoc(sampleDocIdx++, docs, docIdx);
+        }
+    }
+    sample->CatFeatures = pool.CatFeatures;
+    sample->FeatureId = pool.FeatureId;
+    sample->MetaInfo = pool.MetaInfo;
+}
+
+static int GetDocBlockSize(int treeCount) {
+    const size_t blockSize = LOSS_CHANGE_LEAF_INDICES_MEMORY / (Max(treeCount, 1) * sizeof(TIndexType));
+    return Max<size_t>(LOSS_CHANGE_MIN_BLOCK_SIZE, Min<size_t>(LOSS_CHANGE_BLOCK_SIZE, blockSize));
+}
+
+// [begin, end) of blocks, groups are not split between blocks
+static TVector<std::pair<int, int>> GetDocBlocks(const TPool& pool, int blockSize) {
+    const auto& queryId = pool.Docs.QueryId;
+    const int docCount = pool.Docs.GetDocCount();
+    TVector<std::pair<int, int>> blocks;
+    for (int begin = 0; begin < docCount;) {
+        int end = Min(begin + blockSize, docCount);
+        while (!queryId.empty() && end < docCount && queryId[end] == queryId[end - 1]) {
+            ++end;
+        }
+        blocks.emplace_back(begin, end);
+        begin = end;
+    }
+    return blocks;
+}
+
+static TMetricHolder SubtractStats(const TMetricHolder& total, const TMetricHolder& part) {
+    TMetricHolder result = total;
+    for (auto statIdx : xrange(part.Stats.size())) {
+        result.Stats[statIdx] -= part.Stats[statIdx];
+    }
+    return result;
+}
+
+TVector<TFeatureLossChange> CalcLossFunctionChange(
+    const TFullModel& model,
+    const TPool& pool,
+    double sampleRate,
+    ui64 randomSeed,
+    NPar::TLocalExecutor* localExecutor
+) {
+    CB_ENSURE(sampleRate > 0 && sampleRate <= 1, "Sample rate should be in (0, 1], got " << sampleRate);
+    CB_ENSURE(pool.Docs.GetDocCount() != 0, "no docs in pool");
+    const THolder<IMetric> metric = CreateModelLossMetric(model);
+    const bool isQuerywise = metric->GetErrorType() == EErrorType::QuerywiseError;
+    // multiclass metrics expect class indices as targets, the same as in eval-metrics
+    const auto labelConverter = BuildLabelsHelper<TLabelConverter>(model);
+
+    TPool samplePool;
+    if (sampleRate < 1) {
+        SamplePool(pool, sampleRate, randomSeed, &samplePool);
+        CB_ENSURE(samplePool.Docs.GetDocCount() != 0, "Sample of the pool is empty, increase sample rate");
+    }
+    const TPool& data = sampleRate < 1 ? samplePool : pool;
+
+    TVector<TVector<double>> poolLeafWeights;
+    if (model.ObliviousTrees.LeafWeights.empty()) {
+        poolLeafWeights = CollectLeavesStatistics(data, model);
+    }
+    const auto& leafWeights = model.ObliviousTrees.LeafWeights.empty() ? poolLeafWeights : model.ObliviousTrees.LeafWeights;
+
+    NCB::TFeaturesLayout layout(model.ObliviousTrees.FloatFeatures, model.ObliviousTrees.CatFeatures);
+    const int featureCount = layout.GetExternalFeatureCount();
+    const TVector<TFeatureTreeDeltas> featureTreeDeltas = CalcFeatureTreeDeltas(model, leafWeights, featureCount);
+    TVector<int> usedFeatures;
+    for (int feature : xrange(featureCount)) {
+        if (!featureTreeDeltas[feature].Trees.empty()) {
+            usedFeatures.push_back(feature);
+        }
+    }
+
+    const int approxDimension = model.ObliviousTrees.ApproxDimension;
+    const int treeCount = model.ObliviousTrees.GetTreeCount();
+    const auto& docs = data.Docs;
+    const TVector<std::pair<int, int>> blocks = GetDocBlocks(data, GetDocBlockSize(treeCount));
+    TVector<TVector<TMetricHolder>> blockStats(blocks.size()); // [blockIdx][0 for the model, 1 + usedFeatureIdx]
+    localExecutor->ExecRangeWithThrow(
+        [&] (int blockIdx) {
+            NPar::TLocalExecutor sequentialExecutor;
+            const int begin = blocks[blockIdx].first;
+            const int end = blocks[blockIdx].second;
+            const int docCount = end - begin;
+
+            const TVector<ui8> binarizedFeatures = BinarizeFeatures(model, data, begin, end);
+            TVector<TVector<TIndexType>> leafIndices(treeCount);
+            TVector<TVector<double>> modelApprox(approxDimension, TVector<double>(docCount, 0.0));
+            for (int treeIdx : xrange(treeCount)) {
+                leafIndices[treeIdx] = BuildIndicesForBinTree(model, binarizedFeatures, treeIdx);
+                if (leafIndices[treeIdx].empty()) { // the model doesn't have splits
+                    leafIndices[treeIdx].assign(docCount, 0);
+                }
+                const double* leafValues = model.ObliviousTrees.GetFirstLeafPtrForTree(treeIdx);
+                for (int docIdx : xrange(docCount)) {
+                    for (int dimension : xrange(approxDimension)) {
+                        modelApprox[dimension][docIdx] += leafValues[leafIndices[treeIdx][docIdx] * approxDimension + dimension];
+                    }
+                }
+            }
+
+            TVector<float> target(docs.Target.begin() + begin, docs.Target.begin() + end);
+            if (labelConverter.IsInitialized()) {
+                PrepareTargetCompressed(labelConverter, &target);
+            }
+            const TVector<float> weight(docs.Weight.begin() + begin, docs.Weight.begin() + end);
+            TVector<TQueryInfo> queriesInfo;
+            if (isQuerywise) {
+                const TVector<TGroupId> queryId(docs.QueryId.begin() + begin, docs.QueryId.begin() + end);
+                const TVector<ui32> subgroupId = docs.SubgroupId.empty()
+                    ? TVector<ui32>()
+                    : TVector<ui32>(docs.SubgroupId.begin() + begin, docs.SubgroupId.begin() + end);
+                UpdateQueriesInfo(queryId, data.MetaInfo.HasGroupWeight ? weight : TVector<float>(), subgroupId, 0, docCount, &queriesInfo);
+            }
+            const int evalEnd = isQuerywise ? queriesInfo.ysize() : docCount;
+
+            auto& stats = blockStats[blockIdx];
+            stats.push_back(metric->Eval(modelApprox, target, weight, queriesInfo, 0, evalEnd, sequentialExecutor));
+            TVector<TVector<double>> approx;
+            for (int feature : usedFeatures) {
+                approx = modelApprox;
+                const TFeatureTreeDeltas& deltas = featureTreeDeltas[feature];
+                for (auto i : xrange(deltas.Trees.size())) {
+                    const TVector<TIndexType>& treeLeafIndices = leafIndices[deltas.Trees[i]];
+                    const double* leafDeltas = deltas.LeafDeltas.data() + deltas.DeltasOffsets[i];
+                    for (int docIdx : xrange(docCount)) {
+                        for (int dimension : xrange(approxDimension)) {
+                            approx[dimension][docIdx] += leafDeltas[treeLeafIndices[docIdx] * approxDimension + dimension];
+                        }
+                    }
+                }
+                stats.push_back(metric->Eval(approx, target, weight, queriesInfo, 0, evalEnd, sequentialExecutor));
+            }
+        },
+        0,
+        blocks.ysize(),
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+
+    TVector<TMetricHolder> totalStats(usedFeatures.size() + 1);
+    for (const auto& stats : blockStats) {
+        for (auto i : xrange(stats.size())) {
+            totalStats[i].Add(stats[i]);
+        }
+    }
+
+    const double sign = IsMaxOptimal(*metric) ? -1 : 1;
+    auto getScore = [&] (const TMetricHolder& featureStats, const TMetricHolder& modelStats) {
+        return sign * (metric->GetFinalError(featureStats) - metric->GetFinalError(modelStats));
+    };
+    TVector<TFeatureLossChange> result(featureCount);
+    const int blockCount = blocks.ysize();
+    for (auto i : xrange(usedFeatures.size())) {
+        TFeatureLossChange& featureResult = result[usedFeatures[i]];
+        featureResult.Score = getScore(totalStats[i + 1], totalStats[0]);
+        if (sampleRate == 1 || blockCount < 2) {
+            continue;
+        }
+        TVector<double> jackknifeScores;
+        for (const auto& stats : blockStats) {
+            jackknifeScores.push_back(getScore(SubtractStats(totalStats[i + 1], stats[i + 1]), SubtractStats(totalStats[0], stats[0])));
+        }
+        const double meanScore = Accumulate(jackknifeScores, 0.0) / blockCount;
+        double variance = 0;
+        for (double score : jackknifeScores) {
+            variance += Sqr(score - meanScore);
+        }
+        // with finite population correction, the whole pool is the population
+        variance *= (blockCount - 1.0) / blockCount * (1 - sampleRate);
+        featureResult.ConfidenceInterval = CONFIDENCE_QUANTILE * sqrt(variance);
+    }
+    return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <catboost/libs/data/pool.h>
+#include <catboost/libs/model/model.h>
+
+#include <library/threading/local_executor/local_executor.h>
+
+#include <util/generic/vector.h>
+#include <util/system/types.h>
+
+struct TFeatureLossChange {
+    double Score = 0;               // loss change if the feature is removed, positive for useful features
+    double ConfidenceInterval = 0;  // half-width of 95% confidence interval of Score, zero without sampling
+};
+
+/* LossFunctionChange feature importance: the change of the model loss on the pool if the feature is removed
+ * from the model. The splits depending on the feature (including ctrs on it) are dropped from the trees,
+ * leaf values are replaced by their averages over both sides of the dropped splits weighted by leaf weights
+ * (LeafWeights of the model or weights of the pool documents if the model doesn't have them).
+ *
+ * The pool is binarized once by blocks of documents, leaf indices of all trees are cached for a block,
+ * so for each feature only the trees with splits depending on it are recomputed. Blocks of models with
+ * many trees are smaller to bound the memory of the cached leaf indices.
+ * Targets of multiclass models are converted to class indices by the model's class names.
+ *
+ * If sampleRate < 1, the importance is calculated on a random sample of documents (of groups for pools
+ * with groups), confidence intervals are estimated by the delete-a-block jackknife.
+ */
+TVector<TFeatureLossChange> CalcLossFunctionChange(
+    const TFullModel& model,
+    const TPool& pool,
+    double sampleRate,
+    ui64 randomSeed,
+    NPar::TLocalExecutor* localExecutor
+);   // [externalFeatureIdx]
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "calc_fstr.h"
+#include "loss_function_change.h"
 
 #include <catboost/libs/algo/tree_print.h>
 
@@ -99,3 +100,30 @@ inline void CalcAndOutputInteraction(const TFullModel& model,
         OutputRegularInteraction(layout, interaction, *regularFstrPath);
     }
 }
+
+// features are sorted by score, each line is score, half-width of its confidence interval and feature description
+inline void CalcAndOutputLossFunctionChange(const TFullModel& model,
+                                            const TPool& pool,
+                                            double sampleRate,
+                                            ui64 randomSeed,
+                                            int threadCount,
+                                            const TString& path) {
+    NCB::TFeaturesLayout layout(model.ObliviousTrees.FloatFeatures, model.ObliviousTrees.CatFeatures);
+
+    NPar::TLocalExecutor localExecutor;
+    localExecutor.RunAdditionalThreads(threadCount - 1);
+    TVector<TFeatureLossChange> lossChange = CalcLossFunctionChange(model, pool, sampleRate, randomSeed, &localExecutor);
+
+    TVector<int> features(lossChange.size());
+    std::iota(features.begin(), features.end(), 0);
+    StableSort(features.begin(), features.end(), [&](int left, int right) {
+        return lossChange[left].Score > lossChange[right].Score;
+    });
+    TFileOutput out(path);
+    for (int feature : features) {
+        out << lossChange[feature].Score << "\t" << lossChange[feature].ConfidenceInterval << "\t" <<
+               BuildFeatureDescription(layout,
+                                       layout.GetInternalFeatureIdx(feature),
+                                       layout.GetExternalFeatureType(feature)) << Endl;
+    }
+}
@@ -4,8 +4,14 @@
 #include <catboost/libs/algo/index_calcer.h>
 #include <catboost/libs/loggers/logger.h>
 #include <catboost/libs/logging/profile_info.h>
+#include <catboost/libs/model/formula_evaluator.h>
 
+#include <library/threading/future/future.h>
+
+#include <util/digest/murmur.h>
 #include <util/generic/algorithm.h>
+#include <util/stream/file.h>
+#include <util/stream/str.h>
 
 namespace {
     struct TFeaturePathElement {
@@ -334,6 +340,58 @@ static void MapBinFeaturesToClasses(
     }
 }
 
+TShapPreparedTrees::TShapPreparedTrees(int approxDimension, ui64 modelHash)
+    : ApproxDimension(approxDimension)
+    , ModelHash(modelHash)
+    , TreeFirstLeaf(1, 0)
+    , LeafOffsets(1, 0)
+    , MeanValuesSum(approxDimension, 0.0)
+{
+}
+
+void TShapPreparedTrees::AddTree(const TVector<TVector<TShapValue>>& shapValuesByLeaf, const TVector<double>& meanValue) {
+    Y_ASSERT(meanValue.ysize() == ApproxDimension);
+    for (const auto& shapValues : shapValuesByLeaf) {
+        for (const TShapValue& shapValue : shapValues) {
+            Features.push_back(shapValue.Feature);
+            Values.insert(Values.end(), shapValue.Value.begin(), shapValue.Value.end());
+        }
+        LeafOffsets.push_back(Features.size());
+    }
+    TreeFirstLeaf.push_back(LeafOffsets.size() - 1);
+    MeanValues.insert(MeanValues.end(), meanValue.begin(), meanValue.end());
+    for (int dimension = 0; dimension < ApproxDimension; ++dimension) {
+        MeanValuesSum[dimension] += meanValue[dimension];
+    }
+}
+
+// adds SHAP values of the leaf to shapValues[dimension * dimensionStride + feature]
+static inline void AddLeafShapValues(
+    const TShapPreparedTrees& preparedTrees,
+    size_t treeIdx,
+    size_t leafIdx,
+    size_t dimensionStride,
+    double* shapValues
+) {
+    const size_t flatLeafIdx = preparedTrees.TreeFirstLeaf[treeIdx] + leafIdx;
+    const size_t elementsBegin = preparedTrees.LeafOffsets[flatLeafIdx];
+    const size_t elementsEnd = preparedTrees.LeafOffsets[flatLeafIdx + 1];
+    const int* features = preparedTrees.Features.data();
+    const double* values = preparedTrees.Values.data();
+    const int approxDimension = preparedTrees.ApproxDimension;
+    if (approxDimension == 1) {
+        for (size_t elementIdx = elementsBegin; elementIdx < elementsEnd; ++elementIdx) {
+            shapValues[features[elementIdx]] += values[elementIdx];
+        }
+        return;
+    }
+    for (size_t elementIdx = elementsBegin; elementIdx < elementsEnd; ++elementIdx) {
+        for (int dimension = 0; dimension < approxDimension; ++dimension) {
+            shapValues[dimension * dimensionStride + features[elementIdx]] += values[elementIdx * approxDimension + dimension];
+        }
+    }
+}
+
 void CalcShapValuesForDocumentMulti(
     const TObliviousTrees& forest,
     const TShapPreparedTrees& preparedTrees,
@@ -344,7 +402,8 @@ void CalcShapValuesForDocumentMulti(
     TVector<TVector<double>>* shapValues
 ) {
     const int approxDimension = forest.ApproxDimension;
-    shapValues->assign(approxDimension, TVector<double>(flatFeatureCount + 1, 0.0));
+    const size_t dimensionStride = flatFeatureCount + 1;
+    TVector<double> flatShapValues(approxDimension * dimensionStride, 0.0);
     const size_t treeCount = forest.GetTreeCount();
     for (size_t treeIdx = 0; treeIdx < treeCount; ++treeIdx) {
         size_t leafIdx = CalcLeafToFallForDocument(
@@ -354,14 +413,86 @@ void CalcShapValuesForDocumentMulti(
             documentIdx,
             documentCount
         );
-        for (const TShapValue& shapValue : preparedTrees.ShapValuesByLeafForAllTrees[treeIdx][leafIdx]) {
-            for (int dimension = 0; dimension < approxDimension; ++dimension) {
-                (*shapValues)[dimension][shapValue.Feature] += shapValue.Value[dimension];
+        AddLeafShapValues(preparedTrees, treeIdx, leafIdx, dimensionStride, flatShapValues.data());
+    }
+    shapValues->resize(approxDimension);
+    for (int dimension = 0; dimension < approxDimension; ++dimension) {
+        const double* dimensionShapValues = flatShapValues.data() + dimension * dimensionStride;
+        (*shapValues)[dimension].assign(dimensionShapValues, dimensionShapValues + dimensionStride);
+        (*shapValues)[dimension][flatFeatureCount] = preparedTrees.MeanValuesSum[dimension];
+    }
+}
+
+namespace {
+    // per thread buffers for calculation of SHAP values for a sub-block of documents
+    struct TShapSubBlockBuffers {
+        TVector<ui8> BinarizedFeatures;
+        TVector<ui32> LeafIndices;   // [treeIdx * documentCount + documentIdx]
+        TVector<double> ShapValues;  // [(documentIdx * approxDimension + dimension) * (flatFeatureCount + 1) + feature]
+    };
+}
+
+// accumulated SHAP values of a sub-block of documents should fit in L2 cache
+static constexpr size_t ShapSubBlockMemory = 256 << 10;
+// prepared values of trees of a block are added for all documents of a sub-block while they are in cache
+static constexpr size_t ShapTreeBlockSize = 64;
+
+static size_t GetShapSubBlockSize(int approxDimension, int flatFeatureCount) {
+    const size_t documentSize = approxDimension * (flatFeatureCount + 1) * sizeof(double);
+    return Max<size_t>(1, Min<size_t>(FORMULA_EVALUATION_BLOCK_SIZE, ShapSubBlockMemory / documentSize));
+}
+
+/* Calculates SHAP values for documents [start, end) of the pool to buffers->ShapValues.
+ *
+ * Features are binarized and leaf indices are calculated for all trees by vectorized CalcIndexes first,
+ * then SHAP values are accumulated tree block by tree block.
+ * Trees are added to each document in order, so the results are the same as by CalcShapValuesForDocumentMulti.
+ */
+static void CalcShapValuesForDocumentSubBlock(
+    const TFullModel& model,
+    const TPool& pool,
+    const TShapPreparedTrees& preparedTrees,
+    int flatFeatureCount,
+    size_t start,
+    size_t end,
+    TShapSubBlockBuffers* buffers
+) {
+    const TObliviousTrees& forest = model.ObliviousTrees;
+    const size_t documentCount = end - start;
+    const size_t treeCount = forest.GetTreeCount();
+    const int approxDimension = forest.ApproxDimension;
+    const size_t dimensionStride = flatFeatureCount + 1;
+    const size_t documentStride = approxDimension * dimensionStride;
+
+    BinarizeFeatures(model, pool, start, end, &buffers->BinarizedFeatures);
+    buffers->LeafIndices.assign(treeCount * documentCount, 0);
+    const bool needXorMask = !forest.OneHotFeatures.empty();
+    for (size_t treeIdx = 0; treeIdx < treeCount; ++treeIdx) {
+        CalcIndexes(
+            needXorMask,
+            buffers->BinarizedFeatures.data(),
+            documentCount,
+            buffers->LeafIndices.data() + treeIdx * documentCount,
+            forest.GetRepackedBins().data() + forest.TreeStartOffsets[treeIdx],
+            forest.TreeSizes[treeIdx]
+        );
+    }
+
+    buffers->ShapValues.assign(documentCount * documentStride, 0.0);
+    for (size_t treeBlockStart = 0; treeBlockStart < treeCount; treeBlockStart += ShapTreeBlockSize) {
+        const size_t treeBlockEnd = Min(treeBlockStart + ShapTreeBlockSize, treeCount);
+        for (size_t documentIdx = 0; documentIdx < documentCount; ++documentIdx) {
+            double* documentShapValues = buffers->ShapValues.data() + documentIdx * documentStride;
+            for (size_t treeIdx = treeBlockStart; treeIdx < treeBlockEnd; ++treeIdx) {
+                const ui32 leafIdx = buffers->LeafIndices[treeIdx * documentCount + documentIdx];
+                AddLeafShapValues(preparedTrees, treeIdx, leafIdx, dimensionStride, documentShapValues);
             }
         }
+    }
+    for (size_t documentIdx = 0; documentIdx < documentCount; ++documentIdx) {
         for (int dimension = 0; dimension < approxDimension; ++dimension) {
-            (*shapValues)[dimension][flatFeatureCount] +=
-                preparedTrees.MeanValuesForAllTrees[treeIdx][dimension];
+            buffers->ShapValues[documentIdx * documentStride + dimension * dimensionStride + flatFeatureCount]
+                = preparedTrees.MeanValuesSum[dimension];
         }
     }
 }
@@ -375,31 +506,34 @@ static void CalcShapValuesForDocumentBlockMulti(
     NPar::TLocalExecutor* localExecutor,
     TVector<TVector<TVector<double>>>* shapValuesForAllDocuments
 ) {
-    const TObliviousTrees& forest = model.ObliviousTrees;
-    const size_t documentCount = end - start;
-
-    TVector<ui8> binarizedFeaturesForBlock = BinarizeFeatures(model, pool, start, end);
-
+    const int approxDimension = model.ObliviousTrees.ApproxDimension;
     const int flatFeatureCount = pool.Docs.GetEffectiveFactorCount();
+    const size_t dimensionStride = flatFeatureCount + 1;
+    const size_t subBlockSize = GetShapSubBlockSize(approxDimension, flatFeatureCount);
 
-    const int oldShapValuesSize = shapValuesForAllDocuments->size();
+    const size_t oldShapValuesSize = shapValuesForAllDocuments->size();
     shapValuesForAllDocuments->resize(oldShapValuesSize + end - start);
 
-    NPar::TLocalExecutor::TExecRangeParams blockParams(0, documentCount);
-    localExecutor->ExecRange([&] (size_t documentIdx) {
-        TVector<TVector<double>>& shapValues = (*shapValuesForAllDocuments)[oldShapValuesSize + documentIdx];
-
-        CalcShapValuesForDocumentMulti(
-            forest,
-            preparedTrees,
-            binarizedFeaturesForBlock,
-            flatFeatureCount,
-            documentIdx,
-            documentCount,
-            &shapValues
-        );
-
-    }, blockParams, NPar::TLocalExecutor::WAIT_COMPLETE);
+    NPar::TLocalExecutor::TExecRangeParams blockParams(start, end);
+    blockParams.SetBlockCount(localExecutor->GetThreadCount() + 1);
+    localExecutor->ExecRangeWithThrow([&] (int partIdx) {
+        const size_t partStart = start + partIdx * blockParams.GetBlockSize();
+        const size_t partEnd = Min<size_t>(partStart + blockParams.GetBlockSize(), end);
+        TShapSubBlockBuffers buffers;
+        for (size_t subBlockStart = partStart; subBlockStart < partEnd; subBlockStart += subBlockSize) {
+            const size_t subBlockEnd = Min(subBlockStart + subBlockSize, partEnd);
+            CalcShapValuesForDocumentSubBlock(model, pool, preparedTrees, flatFeatureCount, subBlockStart, subBlockEnd, &buffers);
+            for (size_t documentIdx = subBlockStart; documentIdx < subBlockEnd; ++documentIdx) {
+                auto& shapValues = (*shapValuesForAllDocuments)[oldShapValuesSize + documentIdx - start];
+                shapValues.resize(approxDimension);
+                for (int dimension = 0; dimension < approxDimension; ++dimension) {
+                    const double* dimensionShapValues = buffers.ShapValues.data()
+                        + ((documentIdx - subBlockStart) * approxDimension + dimension) * dimensionStride;
+                    shapValues[dimension].assign(dimensionShapValues, dimensionShapValues + dimensionStride);
+                }
+            }
+        }
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
 static void CalcShapValuesByLeafForTreeBlock(
@@ -414,10 +548,13 @@ static void CalcShapValuesByLeafForTreeBlock(
     TVector<TVector<int>> combinationClassFeatures;
     MapBinFeaturesToClasses(forest, &binFeatureCombinationClass, &combinationClassFeatures);
 
+    TVector<TVector<TVector<TShapValue>>> shapValuesByLeafForTreeBlock(end - start); // [treeIdx - start][leafIdx]
+    TVector<TVector<double>> meanValuesForTreeBlock(end - start);
+
     NPar::TLocalExecutor::TExecRangeParams blockParams(start, end);
     localExecutor->ExecRange([&] (size_t treeIdx) {
         const size_t leafCount = (size_t(1) << forest.TreeSizes[treeIdx]);
-        TVector<TVector<TShapValue>>& shapValuesByLeaf = preparedTrees->ShapValuesByLeafForAllTrees[treeIdx];
+        TVector<TVector<TShapValue>>& shapValuesByLeaf = shapValuesByLeafForTreeBlock[treeIdx - start];
         shapValuesByLeaf.resize(leafCount);
 
         TVector<TVector<double>> subtreeWeights
@@ -433,10 +570,13 @@ static void CalcShapValuesByLeafForTreeBlock(
                 subtreeWeights,
                 &shapValuesByLeaf[leafIdx]
             );
-
-            preparedTrees->MeanValuesForAllTrees[treeIdx] = CalcMeanValueForTree(forest, subtreeWeights, treeIdx);
         }
+        meanValuesForTreeBlock[treeIdx - start] = CalcMeanValueForTree(forest, subtreeWeights, treeIdx);
     }, blockParams, NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    for (int treeIdx = start; treeIdx < end; ++treeIdx) {
+        preparedTrees->AddTree(shapValuesByLeafForTreeBlock[treeIdx - start], meanValuesForTreeBlock[treeIdx - start]);
+    }
 }
 
 static void WarnForComplexCtrs(const TObliviousTrees& forest) {
@@ -449,7 +589,7 @@ static void WarnForComplexCtrs(const TObliviousTrees& forest) {
     }
 }
 
-static TShapPreparedTrees PrepareTrees(
+TShapPreparedTrees PrepareTrees(
     const TFullModel& model,
     const TPool& pool,
     NPar::TLocalExecutor* localExecutor,
@@ -468,10 +608,10 @@ static TShapPreparedTrees PrepareTrees(
         leafWeights = CollectLeavesStatistics(pool, model);
     }
 
-    TShapPreparedTrees preparedTrees;
-
-    preparedTrees.ShapValuesByLeafForAllTrees.resize(treeCount);
-    preparedTrees.MeanValuesForAllTrees.resize(treeCount);
+    TShapPreparedTrees preparedTrees(
+        model.ObliviousTrees.ApproxDimension,
+        CalcModelHashForShap(model, model.ObliviousTrees.LeafWeights.empty() ? leafWeights : model.ObliviousTrees.LeafWeights)
+    );
 
     TProfileInfo processTreesProfile(treeCount);
 
@@ -505,6 +645,72 @@ TShapPreparedTrees PrepareTrees(const TFullModel& model, NPar::TLocalExecutor* l
     return PrepareTrees(model, TPool(), localExecutor, 0);
 }
 
+ui64 CalcModelHashForShap(const TFullModel& model, const TVector<TVector<double>>& leafWeights) {
+    const TObliviousTrees& forest = model.ObliviousTrees;
+    ui64 hash = MurmurHash<ui64>(&forest.ApproxDimension, sizeof(forest.ApproxDimension));
+    hash = MurmurHash<ui64>(forest.TreeSizes.data(), forest.TreeSizes.size() * sizeof(int), hash);
+    hash = MurmurHash<ui64>(forest.TreeSplits.data(), forest.TreeSplits.size() * sizeof(int), hash);
+    hash = MurmurHash<ui64>(forest.LeafValues.data(), forest.LeafValues.size() * sizeof(double), hash);
+    for (const auto& treeLeafWeights : leafWeights) {
+        hash = MurmurHash<ui64>(treeLeafWeights.data(), treeLeafWeights.size() * sizeof(double), hash);
+    }
+    return hash;
+}
+
+static constexpr ui64 ShapPreparedTreesMagic = 0x7365657254706853ull; // "ShpTrees"
+static constexpr ui32 ShapPreparedTreesVersion = 1;
+
+void SaveShapPreparedTrees(const TShapPreparedTrees& preparedTrees, IOutputStream* out) {
+    ::SaveMany(out, ShapPreparedTreesMagic, ShapPreparedTreesVersion, preparedTrees);
+}
+
+void SaveShapPreparedTrees(const TShapPreparedTrees& preparedTrees, const TString& path) {
+    TFileOutput out(path);
+    SaveShapPreparedTrees(preparedTrees, &out);
+}
+
+static TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, ui64 modelHash, IInputStream* in) {
+    ui64 magic = 0;
+    ui32 version = 0;
+    ::LoadMany(in, magic, version);
+    CB_ENSURE(magic == ShapPreparedTreesMagic, "Wrong format of SHAP prepared trees");
+    CB_ENSURE(version == ShapPreparedTreesVersion, "Unsupported version of SHAP prepared trees " << version);
+    TShapPreparedTrees preparedTrees;
+    ::Load(in, preparedTrees);
+    CB_ENSURE(
+        preparedTrees.ModelHash == modelHash
+            && preparedTrees.GetTreeCount() == model.GetTreeCount(),
+        "SHAP prepared trees were calculated for another model or leaf weights of another pool"
+    );
+    return preparedTrees;
+}
+
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, IInputStream* in) {
+    CB_ENSURE(
+        !model.ObliviousTrees.LeafWeights.empty(),
+        "Model must have leaf weights or sample pool must be provided"
+    );
+    return LoadShapPreparedTrees(model, CalcModelHashForShap(model, model.ObliviousTrees.LeafWeights), in);
+}
+
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TString& path) {
+    TIFStream in(path);
+    return LoadShapPreparedTrees(model, &in);
+}
+
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TPool& pool, IInputStream* in) {
+    if (!model.ObliviousTrees.LeafWeights.empty()) {
+        return LoadShapPreparedTrees(model, in);
+    }
+    // leaf weights from the pool are much cheaper than the prepared trees, so they are recalculated for the check
+    return LoadShapPreparedTrees(model, CalcModelHashForShap(model, CollectLeavesStatistics(pool, model)), in);
+}
+
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TPool& pool, const TString& path) {
+    TIFStream in(path);
+    return LoadShapPreparedTrees(model, pool, &in);
+}
+
 TVector<TVector<TVector<double>>> CalcShapValuesMulti(
     const TFullModel& model,
     const TPool& pool,
@@ -519,7 +725,10 @@ TVector<TVector<TVector<double>>> CalcShapValuesMulti(
     );
 
     const size_t documentCount = pool.Docs.GetDocCount();
-    const size_t documentBlockSize = CB_THREAD_LIMIT; // least necessary for threading
+    const size_t documentBlockSize = CB_THREAD_LIMIT * GetShapSubBlockSize(
+        model.ObliviousTrees.ApproxDimension,
+        pool.Docs.GetEffectiveFactorCount()
+    );
 
     TFstrLogger documentsLogger(documentCount, "documents processed", "Processing documents...", logPeriod);
 
@@ -572,63 +781,146 @@ TVector<TVector<double>> CalcShapValues(
     return shapValues;
 }
 
-static void OutputShapValuesMulti(const TVector<TVector<TVector<double>>>& shapValues, TFileOutput& out) {
-    for (const auto& shapValuesForDocument : shapValues) {
-        for (const auto& shapValuesForClass : shapValuesForDocument) {
-            int valuesCount = shapValuesForClass.size();
-            for (int valueIdx = 0; valueIdx < valuesCount; ++valueIdx) {
-                out << shapValuesForClass[valueIdx] << (valueIdx + 1 == valuesCount ? '\n' : '\t');
+namespace {
+    // writes formatted blocks in the background, so the next block can be calculated meanwhile
+    class TAsyncShapValuesWriter {
+    public:
+        TAsyncShapValuesWriter(IOutputStream* out, NPar::TLocalExecutor* localExecutor)
+            : Out(out)
+            , LocalExecutor(localExecutor)
+        {
+        }
+
+        ~TAsyncShapValuesWriter() {
+            if (WriteFuture.Initialized()) {
+                WriteFuture.Wait();
             }
         }
-    }
+
+        // returns a buffer for the next block, previous contents of which have been already written
+        TVector<TString>* GetFreeBuffer() {
+            return &Buffers[CurrentBuffer];
+        }
+
+        // writes the buffer from the last GetFreeBuffer call asynchronously
+        void WriteBufferAsync() {
+            Finish(); // previous block must be written before this one
+            TVector<TString>* buffer = &Buffers[CurrentBuffer];
+            CurrentBuffer ^= 1;
+            auto writeBuffer = [this, buffer](int) {
+                for (const TString& text : *buffer) {
+                    Out->Write(text.data(), text.size());
+                }
+            };
+            if (LocalExecutor->GetThreadCount() > 0) {
+                auto writeFutures = LocalExecutor->ExecRangeWithFutures(writeBuffer, 0, 1, NPar::TLocalExecutor::HIGH_PRIORITY);
+                Y_VERIFY(writeFutures.size() == 1);
+                WriteFuture = std::move(writeFutures[0]);
+            } else {
+                writeBuffer(0);
+            }
+        }
+
+        // waits for the last write, rethrows its exception if any
+        void Finish() {
+            if (WriteFuture.Initialized()) {
+                auto writeFuture = std::move(WriteFuture);
+                WriteFuture = NThreading::TFuture<void>();
+                writeFuture.GetValueSync();
+            }
+        }
+
+    private:
+        IOutputStream* Out;
+        NPar::TLocalExecutor* LocalExecutor;
+        TVector<TString> Buffers[2]; // [subBlockIdx] formatted SHAP values
+        int CurrentBuffer = 0;
+        NThreading::TFuture<void> WriteFuture;
+    };
+}
+
+// memory for text of SHAP values of one block of documents
+static constexpr size_t ShapOutputBlockMemory = 64 << 20;
+static constexpr size_t MaxFormattedDoubleSize = 24;
+
+static size_t GetShapOutputBlockSize(const TFullModel& model, int flatFeatureCount, int threadCount) {
+    const size_t documentSize = model.ObliviousTrees.ApproxDimension * (flatFeatureCount + 1) * MaxFormattedDoubleSize;
+    return Max<size_t>(threadCount, ShapOutputBlockMemory / documentSize);
 }
 
 void CalcAndOutputShapValues(
     const TFullModel& model,
     const TPool& pool,
-    const TString& outputPath,
-    int threadCount,
+    const TShapPreparedTrees& preparedTrees,
+    IOutputStream* out,
+    NPar::TLocalExecutor* localExecutor,
     int logPeriod
 ) {
-    NPar::TLocalExecutor localExecutor;
-    localExecutor.RunAdditionalThreads(threadCount - 1);
-
-    TShapPreparedTrees preparedTrees = PrepareTrees(
-        model,
-        pool,
-        &localExecutor,
-        logPeriod
-    );
-
+    const int approxDimension = model.ObliviousTrees.ApproxDimension;
+    const int flatFeatureCount = pool.Docs.GetEffectiveFactorCount();
+    const size_t dimensionStride = flatFeatureCount + 1;
+    const int threadCount = localExecutor->GetThreadCount() + 1;
     const size_t documentCount = pool.Docs.GetDocCount();
-    const size_t documentBlockSize = CB_THREAD_LIMIT; // least necessary for threading
+    const size_t documentBlockSize = GetShapOutputBlockSize(model, flatFeatureCount, threadCount);
+    const size_t subBlockSize = GetShapSubBlockSize(approxDimension, flatFeatureCount);
 
     TFstrLogger documentsLogger(documentCount, "documents processed", "Processing documents...", logPeriod);
 
     TProfileInfo processDocumentsProfile(documentCount);
 
-    TFileOutput out(outputPath);
+    TAsyncShapValuesWriter writer(out, localExecutor);
     for (size_t start = 0; start < documentCount; start += documentBlockSize) {
-        size_t end = Min(start + documentBlockSize, pool.Docs.GetDocCount());
+        size_t end = Min(start + documentBlockSize, documentCount);
         processDocumentsProfile.StartIterationBlock();
 
-        TVector<TVector<TVector<double>>> shapValuesForBlock;
-        shapValuesForBlock.reserve(end - start);
-
-        CalcShapValuesForDocumentBlockMulti(
-            model,
-            pool,
-            preparedTrees,
-            start,
-            end,
-            &localExecutor,
-            &shapValuesForBlock
-        );
+        // each thread calculates and formats its part of the block, so only text is kept in memory
+        NPar::TLocalExecutor::TExecRangeParams blockParams(start, end);
+        blockParams.SetBlockCount(threadCount);
+        TVector<TString>* texts = writer.GetFreeBuffer();
+        texts->resize(blockParams.GetBlockCount());
+        localExecutor->ExecRangeWithThrow([&] (int partIdx) {
+            TString& text = (*texts)[partIdx];
+            text.clear();
+            TStringOutput textOutput(text);
+            const size_t partStart = start + partIdx * blockParams.GetBlockSize();
+            const size_t partEnd = Min<size_t>(partStart + blockParams.GetBlockSize(), end);
+            TShapSubBlockBuffers buffers;
+            for (size_t subBlockStart = partStart; subBlockStart < partEnd; subBlockStart += subBlockSize) {
+                const size_t subBlockEnd = Min(subBlockStart + subBlockSize, partEnd);
+                CalcShapValuesForDocumentSubBlock(model, pool, preparedTrees, flatFeatureCount, subBlockStart, subBlockEnd, &buffers);
+                const size_t valuesCount = (subBlockEnd - subBlockStart) * approxDimension * dimensionStride;
+                for (size_t valueIdx = 0; valueIdx < valuesCount; ++valueIdx) {
+                    textOutput << buffers.ShapValues[valueIdx] << ((valueIdx + 1) % dimensionStride == 0 ? '\n' : '\t');
+                }
+            }
+        }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
 
-        OutputShapValuesMulti(shapValuesForBlock, out);
+        writer.WriteBufferAsync();
 
         processDocumentsProfile.FinishIterationBlock(end - start);
         auto profileResults = processDocumentsProfile.GetProfileResults();
         documentsLogger.Log(profileResults);
     }
+    writer.Finish();
+}
+
+void CalcAndOutputShapValues(
+    const TFullModel& model,
+    const TPool& pool,
+    const TString& outputPath,
+    int threadCount,
+    int logPeriod
+) {
+    NPar::TLocalExecutor localExecutor;
+    localExecutor.RunAdditionalThreads(threadCount - 1);
+
+    TShapPreparedTrees preparedTrees = PrepareTrees(
+        model,
+        pool,
+        &localExecutor,
+        logPeriod
+    );
+
+    TFileOutput out(outputPath);
+    CalcAndOutputShapValues(model, pool, preparedTrees, &out, &localExecutor, logPeriod);
 }
@@ -22,24 +22,54 @@ struct TShapValue {
     Y_SAVELOAD_DEFINE(Feature, Value);
 };
 
+/* SHAP values of features for all leaves of all trees in a flat CSR layout.
+ *
+ * Elements for leaf leafIdx of tree treeIdx are [LeafOffsets[flatLeafIdx], LeafOffsets[flatLeafIdx + 1])
+ * where flatLeafIdx = TreeFirstLeaf[treeIdx] + leafIdx, each element is a feature index in Features
+ * and ApproxDimension values in Values.
+ */
 struct TShapPreparedTrees {
-    TVector<TVector<TVector<TShapValue>>> ShapValuesByLeafForAllTrees;
-    TVector<TVector<double>> MeanValuesForAllTrees;
+    int ApproxDimension = 1;
+    ui64 ModelHash = 0;             // CalcModelHashForShap of the model and leaf weights the trees are prepared for
+    TVector<ui64> TreeFirstLeaf;    // [treeIdx], size is treeCount + 1
+    TVector<ui64> LeafOffsets;      // [flatLeafIdx], size is leafCount + 1
+    TVector<int> Features;          // [elementIdx]
+    TVector<double> Values;         // [elementIdx * ApproxDimension + dimension]
+    TVector<double> MeanValues;     // [treeIdx * ApproxDimension + dimension]
+    TVector<double> MeanValuesSum;  // [dimension], sum of MeanValues over trees
 
+public:
     TShapPreparedTrees() = default;
 
-    TShapPreparedTrees(
-        const TVector<TVector<TVector<TShapValue>>>& shapValuesByLeafForAllTrees,
-        const TVector<TVector<double>>& meanValuesForAllTrees
-    )
-        : ShapValuesByLeafForAllTrees(shapValuesByLeafForAllTrees)
-        , MeanValuesForAllTrees(meanValuesForAllTrees)
-    {
+    TShapPreparedTrees(int approxDimension, ui64 modelHash);
+
+    size_t GetTreeCount() const {
+        return TreeFirstLeaf.size() - 1;
     }
 
-    Y_SAVELOAD_DEFINE(ShapValuesByLeafForAllTrees, MeanValuesForAllTrees);
+    // appends the next tree
+    void AddTree(const TVector<TVector<TShapValue>>& shapValuesByLeaf, const TVector<double>& meanValue);
+
+    Y_SAVELOAD_DEFINE(ApproxDimension, ModelHash, TreeFirstLeaf, LeafOffsets, Features, Values, MeanValues, MeanValuesSum);
 };
 
+// identifies trees and leaf values of the model and the leaf weights used for SHAP values,
+// prepared trees can be used only for the model and leaf weights with the same hash
+ui64 CalcModelHashForShap(const TFullModel& model, const TVector<TVector<double>>& leafWeights);
+
+// prepared trees are saved with a header, so they can be stored next to the model and loaded without recalculation
+void SaveShapPreparedTrees(const TShapPreparedTrees& preparedTrees, IOutputStream* out);
+void SaveShapPreparedTrees(const TShapPreparedTrees& preparedTrees, const TString& path);
+
+// checks that the trees were prepared for the model, the model must have leaf weights
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, IInputStream* in);
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TString& path);
+
+// pool is used for leaf weights if the model doesn't have them, as in PrepareTrees,
+// so trees prepared with leaf weights of another pool are rejected
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TPool& pool, IInputStream* in);
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TPool& pool, const TString& path);
+
 void CalcShapValuesForDocumentMulti(
     const TObliviousTrees& forest,
     const TShapPreparedTrees& preparedTrees,
@@ -52,6 +82,14 @@ void CalcShapValuesForDocumentMulti(
 
 TShapPreparedTrees PrepareTrees(const TFullModel& model, NPar::TLocalExecutor* localExecutor);
 
+// pool is used for leaf weights if the model doesn't have them
+TShapPreparedTrees PrepareTrees(
+    const TFullModel& model,
+    const TPool& pool,
+    NPar::TLocalExecutor* localExecutor,
+    int logPeriod = 0
+);
+
 // returned: ShapValues[documentIdx][dimenesion][feature]
 TVector<TVector<TVector<double>>> CalcShapValuesMulti(
     const TFullModel& model,
@@ -68,7 +106,20 @@ TVector<TVector<double>> CalcShapValues(
     int logPeriod = 0
 );
 
-// outputs for each document in order for each dimension in order an array of feature contributions
+/* outputs for each document in order for each dimension in order an array of feature contributions
+ *
+ * Documents are processed by blocks, memory for the results is bounded by the block size.
+ * Output of a block is written asynchronously while the next block is calculated.
+ */
+void CalcAndOutputShapValues(
+    const TFullModel& model,
+    const TPool& pool,
+    const TShapPreparedTrees& preparedTrees,
+    IOutputStream* out,
+    NPar::TLocalExecutor* localExecutor,
+    int logPeriod = 0
+);
+
 void CalcAndOutputShapValues(
     const TFullModel& model,
     const TPool& pool,
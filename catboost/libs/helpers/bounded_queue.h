@@ -0,0 +1,94 @@
+#pragma once
+
+#include "exception.h"
+
+#include <util/generic/deque.h>
+#include <util/system/condvar.h>
+#include <util/system/guard.h>
+#include <util/system/mutex.h>
+
+#include <utility>
+
+
+namespace NCB {
+
+    /*
+     * Blocking FIFO queue with limited capacity for passing data between stages of a pipeline
+     * running in different threads.
+     *
+     * Producer calls Finish after pushing the last value, consumer pops values until Pop returns false.
+     * Stop is used to interrupt the pipeline (e.g. on an exception in one of the stages): remaining
+     *  values are discarded and all blocked and subsequent Push and Pop calls return false.
+     */
+    template <class T>
+    class TBoundedQueue {
+    public:
+        explicit TBoundedQueue(size_t capacity)
+            : Capacity(capacity)
+        {
+            CB_ENSURE(Capacity, "TBoundedQueue: capacity == 0");
+        }
+
+        // blocks while the queue is full, returns false if the queue has been stopped
+        bool Push(T&& value) {
+            with_lock (Mutex) {
+                while (!Stopped && (Values.size() == Capacity)) {
+                    NotFull.WaitI(Mutex);
+                }
+                if (Stopped) {
+                    return false;
+                }
+                CB_ENSURE(!Finished, "TBoundedQueue: Push after Finish");
+                Values.push_back(std::move(value));
+            }
+            NotEmpty.Signal();
+            return true;
+        }
+
+        bool Push(const T& value) {
+            return Push(T(value));
+        }
+
+        // blocks while the queue is empty, returns false if there'll be no more values
+        bool Pop(T* value) {
+            with_lock (Mutex) {
+                while (!Stopped && !Finished && Values.empty()) {
+                    NotEmpty.WaitI(Mutex);
+                }
+                if (Stopped || Values.empty()) {
+                    return false;
+                }
+                *value = std::move(Values.front());
+                Values.pop_front();
+            }
+            NotFull.Signal();
+            return true;
+        }
+
+        void Finish() {
+            with_lock (Mutex) {
+                Finished = true;
+            }
+            NotEmpty.BroadCast();
+        }
+
+        void Stop() {
+            with_lock (Mutex) {
+                Stopped = true;
+                Values.clear();
+            }
+            NotEmpty.BroadCast();
+            NotFull.BroadCast();
+        }
+
+    private:
+        const size_t Capacity;
+
+        TMutex Mutex; // protects all fields below
+        TCondVar NotEmpty;
+        TCondVar NotFull;
+        TDeque<T> Values;
+        bool Finished = false;
+        bool Stopped = false;
+    };
+}
@@ -4,9 +4,13 @@
 
 #include <catboost/libs/logging/logging.h>
 
+#include <util/generic/utility.h>
 #include <util/generic/vector.h>
+#include <util/generic/yexception.h>
 #include <util/stream/str.h>
+#include <util/system/condvar.h>
 #include <util/system/guard.h>
+#include <util/system/mutex.h>
 
 #include <exception>
 
@@ -46,40 +50,87 @@ namespace NCB {
     }
 
     void TResourceConstrainedExecutor::ExecTasks() {
-        while (!Queue.empty()) {
-            TVector<std::function<void()>> tasks;
-
-            TResourceUnit freeResource = ResourceQuota;
+        if (Queue.empty()) {
+            return;
+        }
 
-            while (true) {
-                auto it = Queue.lower_bound(freeResource);
-                if (it == Queue.end()) {
-                    break;
+        /* Each worker takes the task with the maximum resource usage that fits into the currently
+         * free resource as soon as it finishes the previous one, so one long task does not stall
+         * the others.
+         */
+
+        TMutex mutex; // protects Queue, usedResource, runningTaskCount and failed
+        TCondVar resourceReleased;
+        TResourceUnit usedResource = 0;
+        size_t runningTaskCount = 0;
+        bool failed = false;
+
+        // returns false if there're no more tasks to run
+        auto acquireTask = [&] (std::function<void()>* task, TResourceUnit* resourceUsage) -> bool {
+            with_lock (mutex) {
+                while (true) {
+                    if (failed || Queue.empty()) {
+                        return false;
+                    }
+
+                    auto it = (usedResource <= ResourceQuota) ?
+                        Queue.lower_bound(ResourceQuota - usedResource)
+                        : Queue.end();
+                    if ((it == Queue.end()) && LenientMode && !runningTaskCount) {
+                        // execute task even if it requests more than ResourceQuota, but exclusively
+                        it = Queue.begin();
+                    }
+                    if (it != Queue.end()) {
+                        *resourceUsage = it->first;
+                        *task = std::move(it->second);
+                        Queue.erase(it);
+
+                        usedResource += *resourceUsage;
+                        ++runningTaskCount;
+                        return true;
+                    }
+
+                    // some tasks are running, wait until they release resources
+                    Y_ASSERT(runningTaskCount);
+                    resourceReleased.WaitI(mutex);
                 }
-
-                freeResource -= it->first;
-                tasks.push_back(std::move(it->second));
-                Queue.erase(it);
-            };
-
-            if (LenientMode && tasks.empty()) {
-                // execute at least one task even if it requests more than ResourceQuota
-                auto it = Queue.begin();
-                tasks.push_back(std::move(it->second));
-                Queue.erase(it);
-            } else {
-                Y_ASSERT(!tasks.empty());
             }
-
-            LocalExecutor.ExecRangeWithThrow(
-                [&tasks](int id) {
-                    tasks[id]();
-                    tasks[id] = nullptr; // destroy early, do not wait for all tasks to finish
-                },
-                0,
-                tasks.size(),
-                NPar::TLocalExecutor::WAIT_COMPLETE
-            );
-        }
+            Y_UNREACHABLE();
+        };
+
+        auto releaseTask = [&] (TResourceUnit resourceUsage, bool taskFailed) {
+            with_lock (mutex) {
+                usedResource -= resourceUsage;
+                --runningTaskCount;
+                if (taskFailed) {
+                    failed = true;
+                    Queue.clear(); // do not run the remaining tasks in destructor
+                }
+            }
+            resourceReleased.BroadCast();
+        };
+
+        const int workerCount = (int)Min<size_t>(LocalExecutor.GetThreadCount() + 1, Queue.size());
+
+        LocalExecutor.ExecRangeWithThrow(
+            [&] (int /*workerIdx*/) {
+                std::function<void()> task;
+                TResourceUnit resourceUsage = 0;
+                while (acquireTask(&task, &resourceUsage)) {
+                    try {
+                        task();
+                    } catch (...) {
+                        task = nullptr;
+                        releaseTask(resourceUsage, /*taskFailed*/ true);
+                        throw;
+                    }
+                    task = nullptr; // destroy early, do not wait for all tasks to finish
+                    releaseTask(resourceUsage, /*taskFailed*/ false);
+                }
+            },
+            0,
+            workerCount,
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
     }
 }
@@ -17,12 +17,15 @@ namespace NCB {
         Tasks are run in order of decreasing resource usage within current limit
         (taking into account already running tasks):
          task with the maximum resource usage that can be run under current limit is chosen first.
+        A new task is started as soon as some thread is free and there's enough resource for it,
+         tasks are not executed in lock-step batches.
 
         If LenientMode is enabled allow to execute tasks with more resource usage than the quota
+         (such tasks are executed exclusively)
 
         Destructor is equivalent to ExecTasks
 
-        Exceptions are propagated.
+        Exceptions are propagated, tasks that have not been started yet are discarded in this case.
 
       TODO(akhropov): maybe add task priorities
     */
@@ -0,0 +1,78 @@
+#include <catboost/libs/helpers/bounded_queue.h>
+
+#include <util/generic/vector.h>
+#include <util/generic/xrange.h>
+#include <util/system/thread.h>
+
+#include <library/unittest/registar.h>
+
+#include <functional>
+
+
+static void* RunFunction(void* function) {
+    (*static_cast<std::function<void()>*>(function))();
+    return nullptr;
+}
+
+Y_UNIT_TEST_SUITE(TBoundedQueue) {
+    Y_UNIT_TEST(TestFifo) {
+        NCB::TBoundedQueue<int> queue(3);
+        for (auto i : xrange(3)) {
+            UNIT_ASSERT(queue.Push(i));
+        }
+        queue.Finish();
+
+        int value = -1;
+        for (auto i : xrange(3)) {
+            UNIT_ASSERT(queue.Pop(&value));
+            UNIT_ASSERT_VALUES_EQUAL(value, i);
+        }
+        UNIT_ASSERT(!queue.Pop(&value));
+    }
+
+    Y_UNIT_TEST(TestProducerConsumer) {
+        constexpr int VALUE_COUNT = 10000;
+
+        NCB::TBoundedQueue<int> queue(2);
+        std::function<void()> producer = [&] () {
+            for (auto i : xrange(VALUE_COUNT)) {
+                UNIT_ASSERT(queue.Push(i));
+            }
+            queue.Finish();
+        };
+        TThread producerThread(&RunFunction, &producer);
+        producerThread.Start();
+
+        TVector<int> values;
+        int value;
+        while (queue.Pop(&value)) {
+            values.push_back(value);
+        }
+        producerThread.Join();
+
+        UNIT_ASSERT_VALUES_EQUAL(values.ysize(), VALUE_COUNT);
+        for (auto i : xrange(VALUE_COUNT)) {
+            UNIT_ASSERT_VALUES_EQUAL(values[i], i);
+        }
+    }
+
+    Y_UNIT_TEST(TestStop) {
+        NCB::TBoundedQueue<int> queue(1);
+        UNIT_ASSERT(queue.Push(0));
+
+        // producer is blocked on the full queue until it is stopped
+        bool pushResult = true;
+        std::function<void()> producer = [&] () {
+            pushResult = queue.Push(1);
+        };
+        TThread producerThread(&RunFunction, &producer);
+        producerThread.Start();
+        queue.Stop();
+        producerThread.Join();
+
+        UNIT_ASSERT(!pushResult);
+        int value;
+        UNIT_ASSERT(!queue.Pop(&value));
+        UNIT_ASSERT(!queue.Push(2));
+    }
+}
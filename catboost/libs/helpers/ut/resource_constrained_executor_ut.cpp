@@ -6,6 +6,8 @@
 #include <util/generic/xrange.h>
 #include <util/stream/output.h>
 #include <util/string/cast.h>
+#include <util/system/atomic.h>
+#include <util/system/event.h>
 #include <util/system/guard.h>
 #include <util/system/mutex.h>
 
@@ -144,5 +146,39 @@ Y_UNIT_TEST_SUITE(TResourceConstrainedExecutor) {
             }
         }
     }
-}
 
+    Y_UNIT_TEST(TestNoLockStep) {
+        // long task can be finished only after all short ones, so they must not wait for it
+        NPar::TLocalExecutor localExecutor;
+        localExecutor.RunAdditionalThreads(2);
+
+        TManualEvent shortTasksFinished;
+        TAtomic shortTasksLeft = 4;
+        bool longTaskFinished = false;
+        {
+            NCB::TResourceConstrainedExecutor executor(localExecutor, "Memory", 3, false);
+            executor.Add(
+                {
+                    2,
+                    [&] () {
+                        longTaskFinished = shortTasksFinished.WaitT(TDuration::Seconds(60));
+                    }
+                }
+            );
+            for (auto i : xrange(AtomicGet(shortTasksLeft))) {
+                Y_UNUSED(i);
+                executor.Add(
+                    {
+                        1,
+                        [&] () {
+                            if (AtomicDecrement(shortTasksLeft) == 0) {
+                                shortTasksFinished.Signal();
+                            }
+                        }
+                    }
+                );
+            }
+        }
+        UNIT_ASSERT(longTaskFinished);
+    }
+}
@@ -1,10 +1,12 @@
 #include "auc.h"
 
 #include <util/generic/algorithm.h>
+#include <util/generic/utility.h>
 
 using NMetrics::TSample;
 
-static double MergeAndCountInversions(TVector<TSample>* samples, TVector<TSample>* aux, ui32 lo, ui32 hi, ui32 mid) {
+template <class TLess>
+static double MergeAndCountInversions(TVector<TSample>* samples, TVector<TSample>* aux, ui32 lo, ui32 hi, ui32 mid, TLess less) {
     double result = 0;
     ui32 left = lo;
     ui32 right = mid;
@@ -13,7 +15,7 @@ static double MergeAndCountInversions(TVector<TSample>* samples, TVector<TSample
     ui32 outputIndex = lo;
     double accumulatedWeight = 0;
     while (outputIndex < hi) {
-        if (left == mid || right < hi && input[right].Target < input[left].Target) {
+        if (left == mid || right < hi && less(input[right], input[left])) {
             accumulatedWeight += input[right].Weight;
             output[outputIndex] = input[right];
             ++outputIndex;
@@ -28,22 +30,204 @@ static double MergeAndCountInversions(TVector<TSample>* samples, TVector<TSample
     return result;
 }
 
-static double SortAndCountInversions(TVector<TSample>* samples, TVector<TSample>* aux, ui32 lo, ui32 hi) {
+template <class TLess>
+static double SortAndCountInversions(TVector<TSample>* samples, TVector<TSample>* aux, ui32 lo, ui32 hi, TLess less) {
     if (lo + 1 >= hi) return 0;
     ui32 mid = lo + (hi - lo) / 2;
-    auto leftCount = SortAndCountInversions(samples, aux, lo, mid);
-    auto rightCount = SortAndCountInversions(samples, aux, mid, hi);
-    auto mergeCount = MergeAndCountInversions(samples, aux, lo, hi, mid);
+    auto leftCount = SortAndCountInversions(samples, aux, lo, mid, less);
+    auto rightCount = SortAndCountInversions(samples, aux, mid, hi, less);
+    auto mergeCount = MergeAndCountInversions(samples, aux, lo, hi, mid, less);
     std::copy(aux->begin() + lo, aux->begin() + hi, samples->begin() + lo);
     return leftCount + rightCount + mergeCount;
 }
 
+namespace {
+    struct TMergePartResult {
+        double Inversions = 0;
+        double LeftWeight = 0;
+        double RightWeight = 0;
+    };
+}
+
+// number of elements taken from left among the first diag elements of the stable merge of left and right
+template <class TLess>
+static ui32 FindMergeSplit(const TSample* left, ui32 leftSize, const TSample* right, ui32 rightSize, ui32 diag, TLess less) {
+    ui32 lo = diag > rightSize ? diag - rightSize : 0;
+    ui32 hi = Min(diag, leftSize);
+    while (lo < hi) {
+        const ui32 leftCount = lo + (hi - lo) / 2;
+        const ui32 rightCount = diag - leftCount;
+        if (rightCount > 0 && !less(right[rightCount - 1], left[leftCount])) {
+            lo = leftCount + 1;
+        } else {
+            hi = leftCount;
+        }
+    }
+    return lo;
+}
+
+// merges a part of two sorted ranges, inversions are counted as if there were no right elements before the part
+template <class TLess>
+static TMergePartResult MergePart(
+    const TSample* left,
+    const TSample* leftEnd,
+    const TSample* right,
+    const TSample* rightEnd,
+    TSample* output,
+    TLess less
+) {
+    TMergePartResult result;
+    while (left != leftEnd || right != rightEnd) {
+        if (left == leftEnd || right != rightEnd && less(*right, *left)) {
+            result.RightWeight += right->Weight;
+            *output++ = *right++;
+        } else {
+            result.Inversions += left->Weight * result.RightWeight;
+            result.LeftWeight += left->Weight;
+            *output++ = *left++;
+        }
+    }
+    return result;
+}
+
+/* Stable sort of samples by less, returns weighted number of inversions
+ * (sum of weight[i] * weight[j] over pairs i < j with less(samples[j], samples[i])) if countInversions is true.
+ *
+ * Blocks are sorted in parallel, then pairs of blocks are merged level by level. Each merge is split into
+ * parts of equal size (found by binary search on the merge path), so all threads are busy on every level.
+ * aux must have the same size as samples.
+ */
+template <class TLess>
+static double ParallelSortAndCountInversions(
+    TVector<TSample>* samples,
+    TVector<TSample>* aux,
+    TLess less,
+    bool countInversions,
+    NPar::TLocalExecutor* localExecutor
+) {
+    Y_ASSERT(samples->size() == aux->size());
+    constexpr ui32 MinBlockSize = 1 << 14;
+    const ui32 sampleCount = samples->size();
+    const ui32 threadCount = localExecutor ? localExecutor->GetThreadCount() + 1 : 1;
+    ui32 blockCount = Max<ui32>(1, Min<ui32>(threadCount, sampleCount / MinBlockSize));
+    if (blockCount == 1) {
+        if (countInversions) {
+            return SortAndCountInversions(samples, aux, 0, sampleCount, less);
+        }
+        StableSort(samples->begin(), samples->end(), less);
+        return 0;
+    }
+
+    TVector<ui32> blockBounds(blockCount + 1);
+    for (ui32 blockIdx = 0; blockIdx <= blockCount; ++blockIdx) {
+        blockBounds[blockIdx] = (ui64)sampleCount * blockIdx / blockCount;
+    }
+    TVector<double> blockInversions(blockCount, 0.0);
+    localExecutor->ExecRangeWithThrow(
+        [&] (int blockIdx) {
+            const ui32 blockBegin = blockBounds[blockIdx];
+            const ui32 blockEnd = blockBounds[blockIdx + 1];
+            if (countInversions) {
+                blockInversions[blockIdx] = SortAndCountInversions(samples, aux, blockBegin, blockEnd, less);
+            } else {
+                StableSort(samples->begin() + blockBegin, samples->begin() + blockEnd, less);
+            }
+        },
+        0,
+        blockCount,
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+    double inversions = Accumulate(blockInversions, 0.0);
+
+    TVector<TSample>* input = samples;
+    TVector<TSample>* output = aux;
+    while (blockCount > 1) {
+        const ui32 mergeCount = blockCount / 2;
+        const ui32 partsPerMerge = Max<ui32>(1, threadCount / mergeCount);
+        TVector<TMergePartResult> partResults(mergeCount * partsPerMerge);
+        localExecutor->ExecRangeWithThrow(
+            [&] (int taskIdx) {
+                if ((ui32)taskIdx == mergeCount * partsPerMerge) { // odd block is just copied to the output
+                    const ui32 lastBlockBegin = blockBounds[blockCount - 1];
+                    std::copy(input->begin() + lastBlockBegin, input->end(), output->begin() + lastBlockBegin);
+                    return;
+                }
+                const ui32 mergeIdx = taskIdx / partsPerMerge;
+                const ui32 partIdx = taskIdx % partsPerMerge;
+                const ui32 lo = blockBounds[2 * mergeIdx];
+                const ui32 mid = blockBounds[2 * mergeIdx + 1];
+                const ui32 hi = blockBounds[2 * mergeIdx + 2];
+                const TSample* left = input->data() + lo;
+                const TSample* right = input->data() + mid;
+                const ui32 leftSize = mid - lo;
+                const ui32 rightSize = hi - mid;
+                const ui32 partBegin = (ui64)(hi - lo) * partIdx / partsPerMerge;
+                const ui32 partEnd = (ui64)(hi - lo) * (partIdx + 1) / partsPerMerge;
+                const ui32 leftBegin = FindMergeSplit(left, leftSize, right, rightSize, partBegin, less);
+                const ui32 leftEnd = FindMergeSplit(left, leftSize, right, rightSize, partEnd, less);
+                partResults[taskIdx] = MergePart(
+                    left + leftBegin,
+                    left + leftEnd,
+                    right + (partBegin - leftBegin),
+                    right + (partEnd - leftEnd),
+                    output->data() + lo + partBegin,
+                    less
+                );
+            },
+            0,
+            mergeCount * partsPerMerge + (blockCount % 2),
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+
+        // left elements of each part are also preceded by right elements of the previous parts
+        for (ui32 mergeIdx = 0; mergeIdx < mergeCount; ++mergeIdx) {
+            double rightWeightBefore = 0;
+            for (ui32 partIdx = 0; partIdx < partsPerMerge; ++partIdx) {
+                const auto& partResult = partResults[mergeIdx * partsPerMerge + partIdx];
+                inversions += partResult.Inversions + partResult.LeftWeight * rightWeightBefore;
+                rightWeightBefore += partResult.RightWeight;
+            }
+        }
+
+        TVector<ui32> mergedBlockBounds;
+        for (ui32 blockIdx = 0; blockIdx <= blockCount; blockIdx += 2) {
+            mergedBlockBounds.push_back(blockBounds[blockIdx]);
+        }
+        if (blockCount % 2) {
+            mergedBlockBounds.push_back(blockBounds[blockCount]);
+        }
+        blockBounds.swap(mergedBlockBounds);
+        blockCount = blockBounds.size() - 1;
+        DoSwap(input, output);
+    }
+    if (input != samples) {
+        samples->swap(*aux);
+    }
+    return countInversions ? inversions : 0;
+}
+
 double CalcAUC(TVector<TSample>* samples, double* outWeightSum, double* outPairWeightSum) {
+    return CalcAUC(samples, /*localExecutor*/ nullptr, outWeightSum, outPairWeightSum);
+}
+
+double CalcAUC(
+    TVector<TSample>* samples,
+    NPar::TLocalExecutor* localExecutor,
+    double* outWeightSum,
+    double* outPairWeightSum
+) {
     double weightSum = 0;
     double pairWeightSum = 0;
-    Sort(samples->begin(), samples->end(), [](const TSample& left, const TSample& right) {
-        return left.Target < right.Target;
-    });
+    TVector<TSample> aux(samples->begin(), samples->end());
+    ParallelSortAndCountInversions(
+        samples,
+        &aux,
+        [](const TSample& left, const TSample& right) {
+            return left.Target < right.Target;
+        },
+        /*countInversions*/ false,
+        localExecutor
+    );
     double accumulatedWeight = 0;
     for (ui32 i = 0; i < samples->size(); ++i) {
         auto& sample = (*samples)[i];
@@ -62,17 +246,30 @@ double CalcAUC(TVector<TSample>* samples, double* outWeightSum, double* outPairW
     if (pairWeightSum == 0) {
         return 0;
     }
-    TVector<TSample> aux(samples->begin(), samples->end());
-    Sort(samples->begin(), samples->end(), [](const TSample& left, const TSample& right) {
-        return left.Prediction < right.Prediction ||
-               left.Prediction == right.Prediction && left.Target < right.Target;
-    });
-    auto optimisticAUC = 1 - SortAndCountInversions(samples, &aux, 0, samples->size()) / pairWeightSum;
-    Sort(samples->begin(), samples->end(), [](const TSample& left, const TSample& right) {
-        return left.Prediction < right.Prediction ||
-               left.Prediction == right.Prediction && left.Target > right.Target;
-    });
-    auto pessimisticAUC = 1 - SortAndCountInversions(samples, &aux, 0, samples->size()) / pairWeightSum;
+    auto targetLess = [](const TSample& left, const TSample& right) {
+        return left.Target < right.Target;
+    };
+    ParallelSortAndCountInversions(
+        samples,
+        &aux,
+        [](const TSample& left, const TSample& right) {
+            return left.Prediction < right.Prediction ||
+                   left.Prediction == right.Prediction && left.Target < right.Target;
+        },
+        /*countInversions*/ false,
+        localExecutor
+    );
+    auto optimisticAUC = 1 - ParallelSortAndCountInversions(samples, &aux, targetLess, /*countInversions*/ true, localExecutor) / pairWeightSum;
+    ParallelSortAndCountInversions(
+        samples,
+        &aux,
+        [](const TSample& left, const TSample& right) {
+            return left.Prediction < right.Prediction ||
+                   left.Prediction == right.Prediction && left.Target > right.Target;
+        },
+        /*countInversions*/ false,
+        localExecutor
+    );
+    auto pessimisticAUC = 1 - ParallelSortAndCountInversions(samples, &aux, targetLess, /*countInversions*/ true, localExecutor) / pairWeightSum;
     return (optimisticAUC + pessimisticAUC) / 2.0;
 }
-
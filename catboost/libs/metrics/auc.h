@@ -2,4 +2,14 @@
 
 #include "sample.h"
 
+#include <library/threading/local_executor/local_executor.h>
+
 double CalcAUC(TVector<NMetrics::TSample>* samples, double* outWeightSum = nullptr, double* outPairWeightSum = nullptr);
+
+// sorting and counting of inversions are done in parallel, localExecutor can be nullptr
+double CalcAUC(
+    TVector<NMetrics::TSample>* samples,
+    NPar::TLocalExecutor* localExecutor,
+    double* outWeightSum = nullptr,
+    double* outPairWeightSum = nullptr
+);
@@ -5,3 +5,10 @@ struct TDers {
     double Der2;
     double Der3;
 };
+
+// derivatives of a range of objects stored as structure of arrays to allow vectorized calculation
+struct TDersArrays {
+    double* Der1;
+    double* Der2;
+    double* Der3; // can be nullptr if third derivatives are not calculated
+};
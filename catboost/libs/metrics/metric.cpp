@@ -16,6 +16,7 @@
 #include <util/generic/ymath.h>
 #include <util/generic/string.h>
 #include <util/generic/maybe.h>
+#include <util/generic/xrange.h>
 #include <util/string/iterator.h>
 #include <util/string/cast.h>
 #include <util/string/printf.h>
@@ -447,22 +448,32 @@ TMetricHolder TMedianAbsoluteErrorMetric::Eval(
     const TVector<TQueryInfo>& /*queriesInfo*/,
     int begin,
     int end,
-    NPar::TLocalExecutor& /*executor*/
+    NPar::TLocalExecutor& executor
 ) const {
     CB_ENSURE(approx.size() == 1, "Metric Median absolute error supports only single-dimensional data");
     const auto& approxVec = approx.front();
     Y_ASSERT(approxVec.size() == target.size());
 
     TMetricHolder error(2);
+    const int count = end - begin;
+    CB_ENSURE(count > 0, "Metric Median absolute error requires non-empty data");
     TVector<double> values;
-    values.reserve(end - begin);
-    for (int i = begin; i < end; ++i) {
-        values.push_back(fabs(approxVec[i] - target[i]));
-    }
-    int median = (end - begin) / 2;
-    PartialSort(values.begin(), values.begin() + median + 1, values.end());
-    if (target.size() % 2 == 0) {
-        error.Stats[0] = (values[median - 1] + values[median]) / 2;
+    values.yresize(count);
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, count);
+    blockParams.SetBlockCount(executor.GetThreadCount() + 1);
+    executor.ExecRangeWithThrow(
+        NPar::TLocalExecutor::BlockedLoopBody(blockParams, [&](int i) {
+            values[i] = fabs(approxVec[begin + i] - target[begin + i]);
+        }),
+        0,
+        blockParams.GetBlockCount(),
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+    // linear selection instead of sorting, the lower half is not greater than the median element after it
+    int median = count / 2;
+    NthElement(values.begin(), values.begin() + median, values.end());
+    if (count % 2 == 0) {
+        error.Stats[0] = (*MaxElement(values.begin(), values.begin() + median) + values[median]) / 2;
     } else {
         error.Stats[0] = values[median];
     }
@@ -471,6 +482,10 @@ TMetricHolder TMedianAbsoluteErrorMetric::Eval(
     return error;
 }
 
+THolder<IMetricSketch> TMedianAbsoluteErrorMetric::CreateSketch() const {
+    return CreateMedianAbsoluteErrorSketch();
+}
+
 TString TMedianAbsoluteErrorMetric::GetDescription() const {
     return ToString(ELossFunction::MedianAbsoluteError);
 }
@@ -1000,7 +1015,7 @@ TMetricHolder TAUCMetric::Eval(
     const TVector<TQueryInfo>& /*queriesInfo*/,
     int begin,
     int end,
-    NPar::TLocalExecutor& /* executor */
+    NPar::TLocalExecutor& executor
 ) const {
     Y_ASSERT((approx.size() > 1) == IsMultiClass);
     const auto& approxVec = approx.ysize() == 1 ? approx.front() : approx[PositiveClass];
@@ -1032,11 +1047,15 @@ TMetricHolder TAUCMetric::Eval(
     }
 
     TMetricHolder error(2);
-    error.Stats[0] = CalcAUC(&samples);
+    error.Stats[0] = CalcAUC(&samples, &executor);
     error.Stats[1] = 1.0;
     return error;
 }
 
+THolder<IMetricSketch> TAUCMetric::CreateSketch() const {
+    return CreateAUCSketch(PositiveClass, IsMultiClass, Border, UseWeights);
+}
+
 TString TAUCMetric::GetDescription() const {
     if (IsMultiClass) {
         const TMetricParam<int> positiveClass("class", PositiveClass, /*userDefined*/true);
@@ -2510,6 +2529,108 @@ double EvalErrors(
 }
 
 
+// size of sub-blocks evaluated by all fused metrics in turn, so that the data stays in cache
+static constexpr int FusedEvalSubBlockSize = 4096;
+
+static void EvalBlockKernelsFused(
+    const TVector<TVector<double>>& approx,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TVector<TQueryInfo>& queriesInfo,
+    TConstArrayRef<const IMetric*> metrics,
+    int begin,
+    int end,
+    NPar::TLocalExecutor* localExecutor,
+    TVector<TMetricHolder>* results
+) {
+    results->assign(metrics.size(), TMetricHolder());
+    if (metrics.empty() || begin == end) {
+        return;
+    }
+    // querywise metrics process whole queries, so use smaller sub-blocks for them
+    const int subBlockSize = metrics[0]->GetErrorType() == EErrorType::PerObjectError ?
+        FusedEvalSubBlockSize
+        : Max(1, FusedEvalSubBlockSize / 16);
+
+    const auto blockParams = GetAdditiveMetricBlockParams(begin, end, *localExecutor);
+    const int blockSize = blockParams.GetBlockSize();
+    const int blockCount = blockParams.GetBlockCount();
+
+    TVector<TVector<TMetricHolder>> blockResults(blockCount, TVector<TMetricHolder>(metrics.size())); // [blockIdx][metricIdx]
+    localExecutor->ExecRangeWithThrow(
+        [&](int blockIdx) {
+            const int blockBegin = begin + blockIdx * blockSize;
+            const int blockEnd = Min(blockBegin + blockSize, end);
+            auto& blockResult = blockResults[blockIdx];
+            for (int subBlockBegin = blockBegin; subBlockBegin < blockEnd; subBlockBegin += subBlockSize) {
+                const int subBlockEnd = Min(subBlockBegin + subBlockSize, blockEnd);
+                for (auto metricIdx : xrange(metrics.size())) {
+                    blockResult[metricIdx].Add(
+                        metrics[metricIdx]->EvalBlock(approx, target, weight, queriesInfo, subBlockBegin, subBlockEnd)
+                    );
+                }
+            }
+        },
+        0,
+        blockCount,
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+
+    for (const auto& blockResult : blockResults) {
+        for (auto metricIdx : xrange(metrics.size())) {
+            (*results)[metricIdx].Add(blockResult[metricIdx]);
+        }
+    }
+}
+
+TVector<double> EvalErrors(
+    const TVector<TVector<double>>& approx,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TVector<TQueryInfo>& queriesInfo,
+    TConstArrayRef<const IMetric*> metrics,
+    NPar::TLocalExecutor* localExecutor
+) {
+    TVector<double> errors(metrics.size());
+
+    // metrics with block kernels grouped by the type of the range they are evaluated on
+    TVector<const IMetric*> perObjectMetrics, querywiseMetrics;
+    TVector<size_t> perObjectMetricIndices, querywiseMetricIndices;
+    for (auto metricIdx : xrange(metrics.size())) {
+        const IMetric* metric = metrics[metricIdx];
+        if (!metric->HasBlockKernel()) {
+            errors[metricIdx] = metric->GetFinalError(
+                metric->GetErrorType() == EErrorType::PerObjectError ?
+                    metric->Eval(approx, target, weight, queriesInfo, 0, target.ysize(), *localExecutor)
+                    : metric->Eval(approx, target, weight, queriesInfo, 0, queriesInfo.ysize(), *localExecutor)
+            );
+        } else if (metric->GetErrorType() == EErrorType::PerObjectError) {
+            perObjectMetrics.push_back(metric);
+            perObjectMetricIndices.push_back(metricIdx);
+        } else {
+            Y_VERIFY(metric->GetErrorType() == EErrorType::QuerywiseError || metric->GetErrorType() == EErrorType::PairwiseError);
+            querywiseMetrics.push_back(metric);
+            querywiseMetricIndices.push_back(metricIdx);
+        }
+    }
+
+    TVector<TMetricHolder> results;
+    if (!perObjectMetrics.empty()) {
+        Y_VERIFY(approx[0].ysize() == target.ysize());
+        EvalBlockKernelsFused(approx, target, weight, queriesInfo, perObjectMetrics, 0, target.ysize(), localExecutor, &results);
+        for (auto i : xrange(perObjectMetrics.size())) {
+            errors[perObjectMetricIndices[i]] = perObjectMetrics[i]->GetFinalError(results[i]);
+        }
+    }
+    if (!querywiseMetrics.empty()) {
+        EvalBlockKernelsFused(approx, target, weight, queriesInfo, querywiseMetrics, 0, queriesInfo.ysize(), localExecutor, &results);
+        for (auto i : xrange(querywiseMetrics.size())) {
+            errors[querywiseMetricIndices[i]] = querywiseMetrics[i]->GetFinalError(results[i]);
+        }
+    }
+    return errors;
+}
+
 static inline double BestQueryShift(const double* cursor,
                                     const float* targets,
                                     const float* weights,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "metric_holder.h"
+#include "metric_sketch.h"
 #include "ders_holder.h"
 #include "pfound.h"
 
@@ -109,6 +110,19 @@ struct TCustomObjectiveDescriptor {
         THessianInfo* der2,
         void* customData
     ) = nullptr;
+    // Optional batched version of CalcDersMulti for count objects:
+    // approxes and ders are [objectIdx][dim], der2 is [objectIdx][THessianInfo::Data index] or nullptr if not needed,
+    // weights is nullptr for unweighted objects.
+    void (*CalcDersMultiRange)(
+        int count,
+        int approxDimension,
+        const double* approxes,
+        const float* targets,
+        const float* weights,
+        double* ders,
+        double* der2,
+        void* customData
+    ) = nullptr;
 };
 
 struct IMetric {
@@ -129,6 +143,30 @@ struct IMetric {
     virtual bool IsAdditiveMetric() const = 0;
     virtual const TMap<TString, TString>& GetHints() const = 0;
     virtual void AddHint(const TString& key, const TString& value) = 0;
+
+    /* Metrics with block kernels are additive metrics that can be evaluated on [begin, end)
+     * in the calling thread, results for consecutive ranges are combined by TMetricHolder::Add.
+     * They are evaluated together in one pass over the data by EvalErrors for several metrics.
+     */
+    virtual bool HasBlockKernel() const {
+        return false;
+    }
+    virtual TMetricHolder EvalBlock(
+        const TVector<TVector<double>>& /*approx*/,
+        const TVector<float>& /*target*/,
+        const TVector<float>& /*weight*/,
+        const TVector<TQueryInfo>& /*queriesInfo*/,
+        int /*begin*/,
+        int /*end*/
+    ) const {
+        Y_FAIL("EvalBlock is not supported for this metric");
+    }
+
+    // non-additive metrics can provide a sketch for approximate evaluation on data processed by parts
+    virtual THolder<IMetricSketch> CreateSketch() const {
+        return nullptr;
+    }
+
     virtual ~IMetric()
     {
     }
@@ -147,6 +185,22 @@ private:
     TMap<TString, TString> Hints;
 };
 
+// split of [begin, end) into blocks for parallel evaluation of additive metrics
+inline NPar::TLocalExecutor::TExecRangeParams GetAdditiveMetricBlockParams(
+    int begin,
+    int end,
+    const NPar::TLocalExecutor& executor
+) {
+    NPar::TLocalExecutor::TExecRangeParams blockParams(begin, end);
+
+    const int threadCount = executor.GetThreadCount() + 1;
+    const int MinBlockSize = 10000;
+    const int effectiveBlockCount = Min(threadCount, (int)ceil((end - begin) * 1.0 / MinBlockSize));
+
+    blockParams.SetBlockCount(effectiveBlockCount);
+    return blockParams;
+}
+
 template <class TImpl>
 struct TAdditiveMetric: public TMetric {
     TMetricHolder Eval(
@@ -158,14 +212,7 @@ struct TAdditiveMetric: public TMetric {
         int end,
         NPar::TLocalExecutor& executor
     ) const final {
-        NPar::TLocalExecutor::TExecRangeParams blockParams(begin, end);
-
-        const int threadCount = executor.GetThreadCount() + 1;
-        const int MinBlockSize = 10000;
-        const int effectiveBlockCount = Min(threadCount, (int)ceil((end - begin) * 1.0 / MinBlockSize));
-
-        blockParams.SetBlockCount(effectiveBlockCount);
-
+        const auto blockParams = GetAdditiveMetricBlockParams(begin, end, executor);
         const int blockSize = blockParams.GetBlockSize();
         const ui32 blockCount = blockParams.GetBlockCount();
 
@@ -174,10 +221,7 @@ struct TAdditiveMetric: public TMetric {
             const int from = begin + blockId * blockSize;
             const int to = Min<int>(begin + (blockId + 1) * blockSize, end);
             Y_ASSERT(from < to);
-            if (UseWeights.IsIgnored() || UseWeights)
-                results[blockId] = static_cast<const TImpl*>(this)->EvalSingleThread(approx, target, weight, queriesInfo, from, to);
-            else
-                results[blockId] = static_cast<const TImpl*>(this)->EvalSingleThread(approx, target, {}, queriesInfo, from, to);
+            results[blockId] = EvalBlock(approx, target, weight, queriesInfo, from, to);
         });
 
         TMetricHolder result;
@@ -190,6 +234,24 @@ struct TAdditiveMetric: public TMetric {
     bool IsAdditiveMetric() const final {
         return true;
     }
+
+    bool HasBlockKernel() const final {
+        return true;
+    }
+
+    TMetricHolder EvalBlock(
+        const TVector<TVector<double>>& approx,
+        const TVector<float>& target,
+        const TVector<float>& weight,
+        const TVector<TQueryInfo>& queriesInfo,
+        int begin,
+        int end
+    ) const final {
+        if (UseWeights.IsIgnored() || UseWeights)
+            return static_cast<const TImpl*>(this)->EvalSingleThread(approx, target, weight, queriesInfo, begin, end);
+        else
+            return static_cast<const TImpl*>(this)->EvalSingleThread(approx, target, {}, queriesInfo, begin, end);
+    }
 };
 
 struct TNonAdditiveMetric: public TMetric {
@@ -348,6 +410,7 @@ struct TMedianAbsoluteErrorMetric : public TNonAdditiveMetric {
             NPar::TLocalExecutor& executor) const override;
     virtual TString GetDescription() const override;
     virtual void GetBestValue(EMetricBestValue* valueType, float* bestValue) const override;
+    virtual THolder<IMetricSketch> CreateSketch() const override;
     TMedianAbsoluteErrorMetric() {
         UseWeights.MakeIgnored();
     }
@@ -543,6 +606,7 @@ struct TAUCMetric: public TNonAdditiveMetric {
         NPar::TLocalExecutor& executor) const override;
     virtual TString GetDescription() const override;
     virtual void GetBestValue(EMetricBestValue* valueType, float* bestValue) const override;
+    virtual THolder<IMetricSketch> CreateSketch() const override;
 private:
     int PositiveClass = 1;
     bool IsMultiClass = false;
@@ -1041,6 +1105,19 @@ double EvalErrors(
     NPar::TLocalExecutor* localExecutor
 );
 
+/* Evaluates final errors of several metrics on the same data, results are in the order of metrics.
+ * Metrics with block kernels are evaluated in one blocked parallel pass over the data
+ * (separately for per-object and querywise metrics), other metrics are evaluated one by one.
+ */
+TVector<double> EvalErrors(
+    const TVector<TVector<double>>& approx,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TVector<TQueryInfo>& queriesInfo,
+    TConstArrayRef<const IMetric*> metrics,
+    NPar::TLocalExecutor* localExecutor
+);
+
 inline bool IsMaxOptimal(const IMetric& metric) {
     EMetricBestValue bestValueType;
     float bestPossibleValue;
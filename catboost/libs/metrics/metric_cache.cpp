@@ -0,0 +1,96 @@
+#include "metric_cache.h"
+
+#include <catboost/libs/helpers/exception.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/xrange.h>
+
+
+void TIncrementalMetricsCache::Reset(int docCount) {
+    DocCount = docCount;
+    Generation = 1;
+    BlockChangeGeneration.assign((docCount + BlockSize - 1) / BlockSize, Generation);
+    MetricStats.clear();
+}
+
+void TIncrementalMetricsCache::MarkAllChanged() {
+    Fill(BlockChangeGeneration.begin(), BlockChangeGeneration.end(), Generation);
+}
+
+TVector<double> TIncrementalMetricsCache::EvalErrors(
+    const TVector<TVector<double>>& approx,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TVector<TQueryInfo>& queriesInfo,
+    TConstArrayRef<const IMetric*> metrics,
+    NPar::TLocalExecutor* localExecutor
+) {
+    CB_ENSURE(target.ysize() == DocCount, "Metrics cache was built for " << DocCount << " objects, got " << target.size());
+    TVector<double> errors(metrics.size());
+
+    TVector<const IMetric*> cachedMetrics, otherMetrics;
+    TVector<size_t> cachedMetricIndices, otherMetricIndices;
+    for (auto metricIdx : xrange(metrics.size())) {
+        const IMetric* metric = metrics[metricIdx];
+        if (metric->HasBlockKernel() && metric->GetErrorType() == EErrorType::PerObjectError) {
+            cachedMetrics.push_back(metric);
+            cachedMetricIndices.push_back(metricIdx);
+        } else {
+            otherMetrics.push_back(metric);
+            otherMetricIndices.push_back(metricIdx);
+        }
+    }
+
+    if (!otherMetrics.empty()) {
+        const TVector<double> otherErrors = ::EvalErrors(approx, target, weight, queriesInfo, otherMetrics, localExecutor);
+        for (auto i : xrange(otherMetrics.size())) {
+            errors[otherMetricIndices[i]] = otherErrors[i];
+        }
+    }
+    if (cachedMetrics.empty()) {
+        return errors;
+    }
+
+    Y_VERIFY(approx[0].ysize() == DocCount);
+    const int blockCount = BlockChangeGeneration.ysize();
+    TVector<TMetricBlockStats*> metricStats;
+    for (const IMetric* metric : cachedMetrics) {
+        TMetricBlockStats& stats = MetricStats[metric];
+        if (stats.Stats.empty()) {
+            stats.Stats.resize(blockCount);
+            stats.Generation.assign(blockCount, 0);
+        }
+        metricStats.push_back(&stats);
+    }
+
+    if (blockCount > 0) {
+        localExecutor->ExecRangeWithThrow(
+            [&](int blockIdx) {
+                const int blockBegin = blockIdx * BlockSize;
+                const int blockEnd = Min(blockBegin + BlockSize, DocCount);
+                const ui64 blockChangeGeneration = BlockChangeGeneration[blockIdx];
+                for (auto i : xrange(cachedMetrics.size())) {
+                    TMetricBlockStats& stats = *metricStats[i];
+                    if (stats.Generation[blockIdx] >= blockChangeGeneration) {
+                        continue;
+                    }
+                    stats.Stats[blockIdx] = cachedMetrics[i]->EvalBlock(approx, target, weight, queriesInfo, blockBegin, blockEnd);
+                    stats.Generation[blockIdx] = Generation;
+                }
+            },
+            0,
+            blockCount,
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+    }
+    ++Generation;
+
+    for (auto i : xrange(cachedMetrics.size())) {
+        TMetricHolder result;
+        for (const auto& blockStats : metricStats[i]->Stats) {
+            result.Add(blockStats);
+        }
+        errors[cachedMetricIndices[i]] = cachedMetrics[i]->GetFinalError(result);
+    }
+    return errors;
+}
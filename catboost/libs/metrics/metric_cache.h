@@ -0,0 +1,117 @@
+#pragma once
+
+#include "metric.h"
+#include "metric_holder.h"
+
+#include <library/threading/local_executor/local_executor.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/array_ref.h>
+#include <util/generic/hash.h>
+#include <util/generic/utility.h>
+#include <util/generic/vector.h>
+#include <util/system/types.h>
+
+/* Cache of per-block statistics of additive per-object metrics for a dataset whose approx
+ * is updated in place between evaluations (e.g. learn approx during training).
+ *
+ * Approx updates must be reported by MarkChanged or MarkAllChanged before the next EvalErrors call.
+ * Statistics of blocks without changed documents since the last evaluation of a metric are reused,
+ * so metrics evaluated with a period still see all the changes made between evaluations.
+ * Metrics without block kernels and non per-object metrics are evaluated on the whole data each time.
+ */
+class TIncrementalMetricsCache {
+public:
+    static constexpr int BlockSize = 1 << 14;
+
+public:
+    // drops all cached statistics
+    void Reset(int docCount);
+
+    int GetDocCount() const {
+        return DocCount;
+    }
+
+    // isChanged(docIdx) is called in parallel for documents until the first changed one in each block
+    template <class TIsChanged>
+    void MarkChanged(const TIsChanged& isChanged, NPar::TLocalExecutor* localExecutor) {
+        const int blockCount = BlockChangeGeneration.ysize();
+        if (blockCount == 0) {
+            return;
+        }
+        localExecutor->ExecRangeWithThrow(
+            [&](int blockIdx) {
+                const int blockEnd = Min(blockIdx * BlockSize + BlockSize, DocCount);
+                for (int docIdx = blockIdx * BlockSize; docIdx < blockEnd; ++docIdx) {
+                    if (isChanged(docIdx)) {
+                        BlockChangeGeneration[blockIdx] = Generation;
+                        return;
+                    }
+                }
+            },
+            0,
+            blockCount,
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+    }
+
+    // isChangedAt(position) is called in parallel for all positions, docPermutation[position] is the document at position
+    template <class TIsChangedAt>
+    void MarkChangedPermuted(TConstArrayRef<size_t> docPermutation, const TIsChangedAt& isChangedAt, NPar::TLocalExecutor* localExecutor) {
+        Y_VERIFY(docPermutation.size() == static_cast<size_t>(DocCount));
+        const int blockCount = BlockChangeGeneration.ysize();
+        if (blockCount == 0) {
+            return;
+        }
+        NPar::TLocalExecutor::TExecRangeParams positionBlockParams(0, DocCount);
+        positionBlockParams.SetBlockSize(BlockSize);
+        TVector<TVector<int>> changedBlocks(positionBlockParams.GetBlockCount()); // [positionBlockIdx]
+        localExecutor->ExecRangeWithThrow(
+            [&](int positionBlockIdx) {
+                auto& positionBlockChanges = changedBlocks[positionBlockIdx];
+                const int blockEnd = Min(positionBlockIdx * BlockSize + BlockSize, DocCount);
+                for (int position = positionBlockIdx * BlockSize; position < blockEnd; ++position) {
+                    if (isChangedAt(position)) {
+                        const int blockIdx = docPermutation[position] / BlockSize;
+                        if (positionBlockChanges.empty() || positionBlockChanges.back() != blockIdx) {
+                            positionBlockChanges.push_back(blockIdx);
+                        }
+                    }
+                }
+                SortUnique(positionBlockChanges);
+            },
+            0,
+            positionBlockParams.GetBlockCount(),
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+        for (const auto& positionBlockChanges : changedBlocks) {
+            for (int blockIdx : positionBlockChanges) {
+                BlockChangeGeneration[blockIdx] = Generation;
+            }
+        }
+    }
+
+    void MarkAllChanged();
+
+    // the same as EvalErrors for several metrics, approx must be the same object for all calls
+    TVector<double> EvalErrors(
+        const TVector<TVector<double>>& approx,
+        const TVector<float>& target,
+        const TVector<float>& weight,
+        const TVector<TQueryInfo>& queriesInfo,
+        TConstArrayRef<const IMetric*> metrics,
+        NPar::TLocalExecutor* localExecutor
+    );
+
+private:
+    struct TMetricBlockStats {
+        TVector<TMetricHolder> Stats;   // [blockIdx]
+        TVector<ui64> Generation;       // [blockIdx], generation of the evaluation the stats were calculated at
+    };
+
+private:
+    int DocCount = 0;
+    ui64 Generation = 1;                   // generation of the next evaluation
+    TVector<ui64> BlockChangeGeneration;   // [blockIdx], generation of the evaluation the last change is visible to
+    THashMap<const IMetric*, TMetricBlockStats> MetricStats;
+};
@@ -0,0 +1,154 @@
+#include "metric_sketch.h"
+
+#include <catboost/libs/helpers/exception.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/hash.h>
+#include <util/generic/ymath.h>
+#include <util/system/types.h>
+
+#include <cmath>
+#include <cstring>
+
+// bins are the highest 16 bits of order-preserving keys of float values: sign, exponent and 7 bits of mantissa
+static constexpr int SKETCH_BIN_SHIFT = 16;
+
+static inline ui32 GetFloatBits(float value) {
+    ui32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline float GetFloatFromBits(ui32 bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// bins of keys are ordered as values
+static inline ui32 GetOrderedBin(float value) {
+    const ui32 bits = GetFloatBits(value);
+    const ui32 key = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    return key >> SKETCH_BIN_SHIFT;
+}
+
+namespace {
+    class TAUCSketch : public IMetricSketch {
+    public:
+        TAUCSketch(int positiveClass, bool isMultiClass, double border, bool useWeights)
+            : PositiveClass(positiveClass)
+            , IsMultiClass(isMultiClass)
+            , Border(border)
+            , UseWeights(useWeights)
+        {
+        }
+
+        void Add(
+            const TVector<TVector<double>>& approx,
+            const TVector<float>& target,
+            const TVector<float>& weight,
+            int begin,
+            int end
+        ) override {
+            Y_ASSERT((approx.size() > 1) == IsMultiClass);
+            const auto& approxVec = approx.ysize() == 1 ? approx.front() : approx[PositiveClass];
+            const bool hasWeights = UseWeights && !weight.empty();
+            for (int docIdx = begin; docIdx < end; ++docIdx) {
+                const bool isPositive = IsMultiClass ? target[docIdx] == PositiveClass : target[docIdx] > Border;
+                const double docWeight = hasWeights ? weight[docIdx] : 1.0;
+                auto& binWeights = BinWeights[GetOrderedBin(approxVec[docIdx])];
+                (isPositive ? binWeights.first : binWeights.second) += docWeight;
+            }
+        }
+
+        TMetricHolder GetResult() const override {
+            TVector<std::pair<ui32, std::pair<double, double>>> bins(BinWeights.begin(), BinWeights.end());
+            Sort(bins);
+            double negativeWeightBefore = 0;
+            double correctPairWeight = 0;
+            double positiveWeight = 0;
+            for (const auto& bin : bins) {
+                const double binPositiveWeight = bin.second.first;
+                const double binNegativeWeight = bin.second.second;
+                correctPairWeight += binPositiveWeight * (negativeWeightBefore + binNegativeWeight / 2);
+                negativeWeightBefore += binNegativeWeight;
+                positiveWeight += binPositiveWeight;
+            }
+            const double pairWeight = positiveWeight * negativeWeightBefore;
+
+            TMetricHolder error(2);
+            error.Stats[0] = pairWeight == 0 ? 0 : correctPairWeight / pairWeight;
+            error.Stats[1] = 1.0;
+            return error;
+        }
+
+    private:
+        int PositiveClass;
+        bool IsMultiClass;
+        double Border;
+        bool UseWeights;
+        THashMap<ui32, std::pair<double, double>> BinWeights; // bin -> (positive weight, negative weight), only non-empty bins
+    };
+
+    class TMedianAbsoluteErrorSketch : public IMetricSketch {
+    public:
+        void Add(
+            const TVector<TVector<double>>& approx,
+            const TVector<float>& target,
+            const TVector<float>& /*weight*/,
+            int begin,
+            int end
+        ) override {
+            CB_ENSURE(approx.size() == 1, "Metric Median absolute error supports only single-dimensional data");
+            const auto& approxVec = approx.front();
+            for (int docIdx = begin; docIdx < end; ++docIdx) {
+                // bins of non-negative values don't have the sign bit
+                const float value = fabs(approxVec[docIdx] - target[docIdx]);
+                ++Counts[GetFloatBits(value) >> SKETCH_BIN_SHIFT];
+            }
+            DocCount += end - begin;
+        }
+
+        TMetricHolder GetResult() const override {
+            CB_ENSURE(DocCount > 0, "Metric Median absolute error requires non-empty data");
+            TVector<std::pair<ui32, ui64>> bins(Counts.begin(), Counts.end());
+            Sort(bins);
+            TMetricHolder error(2);
+            const ui64 median = DocCount / 2;
+            if (DocCount % 2 == 0) {
+                error.Stats[0] = (GetValueByRank(bins, median - 1) + GetValueByRank(bins, median)) / 2;
+            } else {
+                error.Stats[0] = GetValueByRank(bins, median);
+            }
+            error.Stats[1] = 1;
+            return error;
+        }
+
+    private:
+        // middle of the bin of the value with the given rank among the added ones, bins are sorted
+        static double GetValueByRank(const TVector<std::pair<ui32, ui64>>& bins, ui64 rank) {
+            ui64 countBefore = 0;
+            size_t binIdx = 0;
+            while (countBefore + bins[binIdx].second <= rank) {
+                countBefore += bins[binIdx].second;
+                ++binIdx;
+            }
+            const ui32 bin = bins[binIdx].first;
+            const double binBegin = GetFloatFromBits(bin << SKETCH_BIN_SHIFT);
+            const double binEnd = GetFloatFromBits((bin + 1) << SKETCH_BIN_SHIFT);
+            return IsFinite(binEnd) ? (binBegin + binEnd) / 2 : binBegin;
+        }
+
+    private:
+        THashMap<ui32, ui64> Counts;   // bin -> count, only non-empty bins
+        ui64 DocCount = 0;
+    };
+}
+
+THolder<IMetricSketch> CreateAUCSketch(int positiveClass, bool isMultiClass, double border, bool useWeights) {
+    return MakeHolder<TAUCSketch>(positiveClass, isMultiClass, border, useWeights);
+}
+
+THolder<IMetricSketch> CreateMedianAbsoluteErrorSketch() {
+    return MakeHolder<TMedianAbsoluteErrorSketch>();
+}
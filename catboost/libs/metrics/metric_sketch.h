@@ -0,0 +1,41 @@
+#pragma once
+
+#include "metric_holder.h"
+
+#include <util/generic/ptr.h>
+#include <util/generic/vector.h>
+
+/* Bounded-size summary of approxes and targets of documents for approximate evaluation of
+ * a non-additive per-object metric on data that is processed by parts (e.g. metric plots
+ * on a pool that doesn't fit in memory), documents can be added in any order.
+ * Values are grouped into bins by the highest 16 bits of their float representation
+ * (sign, exponent and 7 bits of mantissa), so a bin spans a relative range of at most 2^-7.
+ * Only non-empty bins are stored: the size is proportional to the number of distinct bins,
+ * which is at most 2^16 and usually a few thousands.
+ */
+class IMetricSketch {
+public:
+    virtual ~IMetricSketch() = default;
+
+    virtual void Add(
+        const TVector<TVector<double>>& approx,
+        const TVector<float>& target,
+        const TVector<float>& weight,
+        int begin,
+        int end
+    ) = 0;
+
+    // stats in the same format as Eval of the metric returns
+    virtual TMetricHolder GetResult() const = 0;
+};
+
+/* Weighted histograms of positive and negative documents by approx with relative precision 2^-7,
+ * pairs of documents in the same bin are counted as ties. The absolute error of AUC is at most
+ * half of the weighted share of positive-negative pairs that fall into the same bin.
+ */
+THolder<IMetricSketch> CreateAUCSketch(int positiveClass, bool isMultiClass, double border, bool useWeights);
+
+/* Histogram of absolute errors, weights are ignored. The median is replaced by the middle of its bin,
+ * so the relative error of the result is at most 2^-8.
+ */
+THolder<IMetricSketch> CreateMedianAbsoluteErrorSketch();
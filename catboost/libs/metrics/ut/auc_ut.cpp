@@ -0,0 +1,37 @@
+#include <library/unittest/registar.h>
+#include <catboost/libs/metrics/auc.h>
+
+#include <util/random/fast.h>
+
+Y_UNIT_TEST_SUITE(AUCMetricTest) {
+Y_UNIT_TEST(AUCTest) {
+    {
+        TVector<NMetrics::TSample> samples = NMetrics::TSample::FromVectors({0, 0, 1, 1}, {0.1, 0.4, 0.35, 0.8});
+        UNIT_ASSERT_DOUBLES_EQUAL(CalcAUC(&samples), 0.75, 1e-6);
+    }
+    {
+        TVector<NMetrics::TSample> samples = NMetrics::TSample::FromVectors({0, 1, 0, 1}, {0.5, 0.5, 0.5, 0.5});
+        UNIT_ASSERT_DOUBLES_EQUAL(CalcAUC(&samples), 0.5, 1e-6);
+    }
+}
+
+Y_UNIT_TEST(ParallelAUCTest) {
+    TReallyFastRng32 rng(0);
+    NPar::TLocalExecutor executor;
+    executor.RunAdditionalThreads(4);
+    for (ui32 sampleCount : {1, 1000, 100000, 300001}) {
+        TVector<NMetrics::TSample> samples;
+        for (ui32 i = 0; i < sampleCount; ++i) {
+            samples.emplace_back(rng.Uniform(3), rng.Uniform(1000) / 10.0, 1 + rng.Uniform(3));
+        }
+        TVector<NMetrics::TSample> samplesCopy = samples;
+        double weightSum = 0, pairWeightSum = 0;
+        double parallelWeightSum = 0, parallelPairWeightSum = 0;
+        const double auc = CalcAUC(&samples, &weightSum, &pairWeightSum);
+        const double parallelAUC = CalcAUC(&samplesCopy, &executor, &parallelWeightSum, &parallelPairWeightSum);
+        UNIT_ASSERT_DOUBLES_EQUAL(auc, parallelAUC, 1e-9);
+        UNIT_ASSERT_DOUBLES_EQUAL(weightSum, parallelWeightSum, 1e-6);
+        UNIT_ASSERT_DOUBLES_EQUAL(pairWeightSum, parallelPairWeightSum, 1e-6);
+    }
+}
+}
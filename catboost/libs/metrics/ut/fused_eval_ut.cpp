@@ -0,0 +1,43 @@
+#include <library/unittest/registar.h>
+#include <catboost/libs/metrics/metric.h>
+#include <catboost/libs/metrics/metric_holder.h>
+
+#include <util/generic/xrange.h>
+#include <util/random/fast.h>
+
+// fused evaluation of several metrics should give the same results as evaluation one by one
+Y_UNIT_TEST_SUITE(FusedEvalTest) {
+Y_UNIT_TEST(FusedEvalTest) {
+    TReallyFastRng32 rng(0);
+    const int docCount = 100000;
+    const int querySize = 10;
+
+    TVector<TVector<double>> approx(1);
+    TVector<float> target;
+    TVector<float> weight;
+    for (int i = 0; i < docCount; ++i) {
+        approx[0].push_back(rng.GenRandReal1() * 2 - 1);
+        target.push_back(rng.Uniform(2));
+        weight.push_back(rng.GenRandReal1());
+    }
+    TVector<TQueryInfo> queriesInfo;
+    for (int begin = 0; begin < docCount; begin += querySize) {
+        queriesInfo.emplace_back(begin, begin + querySize);
+    }
+
+    TVector<THolder<IMetric>> metrics = CreateMetricsFromDescription(
+        {"RMSE", "Logloss", "MAE", "AUC", "QueryRMSE", "Accuracy"},
+        /*approxDim*/ 1
+    );
+
+    NPar::TLocalExecutor executor;
+    executor.RunAdditionalThreads(3);
+
+    const TVector<double> fusedErrors = EvalErrors(approx, target, weight, queriesInfo, GetConstPointers(metrics), &executor);
+    UNIT_ASSERT_VALUES_EQUAL(fusedErrors.size(), metrics.size());
+    for (auto i : xrange(metrics.size())) {
+        const double error = EvalErrors(approx, target, weight, queriesInfo, metrics[i], &executor);
+        UNIT_ASSERT_DOUBLES_EQUAL(fusedErrors[i], error, 1e-9);
+    }
+}
+}
@@ -0,0 +1,195 @@
+#include <library/unittest/registar.h>
+#include <catboost/libs/metrics/metric.h>
+#include <catboost/libs/metrics/metric_cache.h>
+
+#include <util/generic/xrange.h>
+#include <util/random/shuffle.h>
+#include <util/random/fast.h>
+
+namespace {
+    // sum of approx with the number of EvalBlock calls for each block
+    struct TBlockCallsCountingMetric: public TMetric {
+        explicit TBlockCallsCountingMetric(int blockCount)
+            : BlockCalls(blockCount, 0)
+        {
+        }
+
+        TMetricHolder Eval(
+            const TVector<TVector<double>>& approx,
+            const TVector<float>& /*target*/,
+            const TVector<float>& /*weight*/,
+            const TVector<TQueryInfo>& /*queriesInfo*/,
+            int begin,
+            int end,
+            NPar::TLocalExecutor& /*executor*/
+        ) const override {
+            TMetricHolder result(2);
+            for (int blockBegin = begin; blockBegin < end; blockBegin += TIncrementalMetricsCache::BlockSize) {
+                const int blockEnd = Min(blockBegin + TIncrementalMetricsCache::BlockSize, end);
+                result.Add(CalcSum(approx, blockBegin, blockEnd));
+            }
+            return result;
+        }
+
+        bool HasBlockKernel() const override {
+            return true;
+        }
+
+        TMetricHolder EvalBlock(
+            const TVector<TVector<double>>& approx,
+            const TVector<float>& /*target*/,
+            const TVector<float>& /*weight*/,
+            const TVector<TQueryInfo>& /*queriesInfo*/,
+            int begin,
+            int end
+        ) const override {
+            // blocks are evaluated by different threads, so each counter has a single writer
+            ++BlockCalls[begin / TIncrementalMetricsCache::BlockSize];
+            return CalcSum(approx, begin, end);
+        }
+
+        TString GetDescription() const override {
+            return "BlockCallsCounting";
+        }
+
+        void GetBestValue(EMetricBestValue* valueType, float* /*bestValue*/) const override {
+            *valueType = EMetricBestValue::Min;
+        }
+
+        bool IsAdditiveMetric() const override {
+            return true;
+        }
+
+        static TMetricHolder CalcSum(const TVector<TVector<double>>& approx, int begin, int end) {
+            TMetricHolder result(2);
+            for (int i = begin; i < end; ++i) {
+                result.Stats[0] += approx[0][i];
+                result.Stats[1] += 1;
+            }
+            return result;
+        }
+
+        mutable TVector<int> BlockCalls; // [blockIdx]
+    };
+}
+
+// cached evaluation after partial approx updates should give the same results as evaluation from scratch
+Y_UNIT_TEST_SUITE(MetricCacheTest) {
+Y_UNIT_TEST(MetricCacheTest) {
+    TReallyFastRng32 rng(0);
+    const int docCount = 3 * TIncrementalMetricsCache::BlockSize + 100;
+
+    TVector<TVector<double>> approx(1);
+    TVector<float> target;
+    TVector<float> weight;
+    for (int i = 0; i < docCount; ++i) {
+        approx[0].push_back(rng.GenRandReal1() * 2 - 1);
+        target.push_back(rng.Uniform(2));
+        weight.push_back(rng.GenRandReal1());
+    }
+    TVector<TQueryInfo> queriesInfo;
+
+    TVector<THolder<IMetric>> metrics = CreateMetricsFromDescription({"RMSE", "Logloss", "AUC"}, /*approxDim*/ 1);
+    const TVector<const IMetric*> allMetrics = GetConstPointers(metrics);
+    const TVector<const IMetric*> firstMetric = {metrics[0].Get()};
+
+    NPar::TLocalExecutor executor;
+    executor.RunAdditionalThreads(3);
+
+    TIncrementalMetricsCache cache;
+    cache.Reset(docCount);
+    for (int iter = 0; iter < 4; ++iter) {
+        // change documents of the second block only
+        const int changedDoc = TIncrementalMetricsCache::BlockSize + iter;
+        approx[0][changedDoc] += 0.5;
+        cache.MarkChanged([=](int docIdx) { return docIdx == changedDoc; }, &executor);
+
+        // the second metric skips some evaluations, but should see all the changes
+        const auto& evaluatedMetrics = iter % 2 ? allMetrics : firstMetric;
+        const TVector<double> errors = cache.EvalErrors(approx, target, weight, queriesInfo, evaluatedMetrics, &executor);
+        const TVector<double> expectedErrors = EvalErrors(approx, target, weight, queriesInfo, evaluatedMetrics, &executor);
+        UNIT_ASSERT_VALUES_EQUAL(errors.size(), evaluatedMetrics.size());
+        for (auto i : xrange(errors.size())) {
+            UNIT_ASSERT_DOUBLES_EQUAL(errors[i], expectedErrors[i], 1e-9);
+        }
+    }
+}
+
+Y_UNIT_TEST(MetricCachePermutedChangesTest) {
+    TReallyFastRng32 rng(0);
+    const int docCount = 3 * TIncrementalMetricsCache::BlockSize + 100;
+
+    TVector<TVector<double>> approx(1);
+    TVector<float> target;
+    TVector<float> weight;
+    TVector<size_t> permutation(docCount);
+    for (int i = 0; i < docCount; ++i) {
+        approx[0].push_back(rng.GenRandReal1() * 2 - 1);
+        target.push_back(rng.Uniform(2));
+        weight.push_back(rng.GenRandReal1());
+        permutation[i] = i;
+    }
+    Shuffle(permutation.begin(), permutation.end(), rng);
+    TVector<TQueryInfo> queriesInfo;
+
+    TVector<THolder<IMetric>> metrics = CreateMetricsFromDescription({"RMSE", "Logloss"}, /*approxDim*/ 1);
+    const TVector<const IMetric*> allMetrics = GetConstPointers(metrics);
+
+    NPar::TLocalExecutor executor;
+    executor.RunAdditionalThreads(3);
+
+    TIncrementalMetricsCache cache;
+    cache.Reset(docCount);
+    cache.EvalErrors(approx, target, weight, queriesInfo, allMetrics, &executor);
+    for (int iter = 0; iter < 4; ++iter) {
+        // change every fifth position of the permuted order, as a tree with a zero leaf does
+        for (int position = iter; position < docCount; position += 5) {
+            approx[0][permutation[position]] += 0.5;
+        }
+        cache.MarkChangedPermuted(permutation, [=](size_t position) { return position % 5 == static_cast<size_t>(iter); }, &executor);
+
+        const TVector<double> errors = cache.EvalErrors(approx, target, weight, queriesInfo, allMetrics, &executor);
+        const TVector<double> expectedErrors = EvalErrors(approx, target, weight, queriesInfo, allMetrics, &executor);
+        for (auto i : xrange(errors.size())) {
+            UNIT_ASSERT_DOUBLES_EQUAL(errors[i], expectedErrors[i], 1e-9);
+        }
+    }
+}
+
+// blocks without changes since the previous evaluation are not evaluated again
+Y_UNIT_TEST(MetricCacheSkipsUnchangedBlocksTest) {
+    const int blockCount = 3;
+    const int docCount = blockCount * TIncrementalMetricsCache::BlockSize;
+
+    TVector<TVector<double>> approx(1, TVector<double>(docCount, 1.0));
+    TVector<float> target(docCount, 0.0f);
+    TVector<float> weight;
+    TVector<TQueryInfo> queriesInfo;
+
+    TBlockCallsCountingMetric metric(blockCount);
+    const TVector<const IMetric*> metrics = {&metric};
+
+    NPar::TLocalExecutor executor;
+    executor.RunAdditionalThreads(3);
+
+    TIncrementalMetricsCache cache;
+    cache.Reset(docCount);
+    cache.EvalErrors(approx, target, weight, queriesInfo, metrics, &executor);
+    UNIT_ASSERT_VALUES_EQUAL(metric.BlockCalls, TVector<int>({1, 1, 1}));
+
+    // no changes
+    cache.EvalErrors(approx, target, weight, queriesInfo, metrics, &executor);
+    UNIT_ASSERT_VALUES_EQUAL(metric.BlockCalls, TVector<int>({1, 1, 1}));
+
+    // change in the second block only
+    const int changedDoc = TIncrementalMetricsCache::BlockSize + 1;
+    approx[0][changedDoc] += 1.0;
+    cache.MarkChanged([=](int docIdx) { return docIdx == changedDoc; }, &executor);
+    const TVector<double> errors = cache.EvalErrors(approx, target, weight, queriesInfo, metrics, &executor);
+    UNIT_ASSERT_VALUES_EQUAL(metric.BlockCalls, TVector<int>({1, 2, 1}));
+    UNIT_ASSERT_DOUBLES_EQUAL(errors[0], (docCount + 1.0) / docCount, 1e-9);
+
+    cache.EvalErrors(approx, target, weight, queriesInfo, metrics, &executor);
+    UNIT_ASSERT_VALUES_EQUAL(metric.BlockCalls, TVector<int>({1, 2, 1}));
+}
+}
@@ -0,0 +1,35 @@
+#include <library/unittest/registar.h>
+#include <catboost/libs/metrics/metric.h>
+
+#include <util/random/fast.h>
+
+// sketches of data added by parts should give results close to exact evaluation
+Y_UNIT_TEST_SUITE(MetricSketchTest) {
+Y_UNIT_TEST(MetricSketchTest) {
+    TReallyFastRng32 rng(0);
+    const int docCount = 10000;
+
+    TVector<TVector<double>> approx(1);
+    TVector<float> target;
+    TVector<float> weight;
+    for (int i = 0; i < docCount; ++i) {
+        target.push_back(rng.Uniform(2));
+        approx[0].push_back(target.back() + rng.GenRandReal1() * 4 - 2);
+        weight.push_back(rng.GenRandReal1());
+    }
+
+    NPar::TLocalExecutor executor;
+    for (const auto& description : {"AUC", "MedianAbsoluteError"}) {
+        TVector<THolder<IMetric>> metrics = CreateMetricsFromDescription({description}, /*approxDim*/ 1);
+        const IMetric& metric = *metrics[0];
+        THolder<IMetricSketch> sketch = metric.CreateSketch();
+        UNIT_ASSERT(sketch);
+        sketch->Add(approx, target, weight, docCount / 3, docCount);
+        sketch->Add(approx, target, weight, 0, docCount / 3);
+
+        const double exact = metric.GetFinalError(metric.Eval(approx, target, weight, {}, 0, docCount, executor));
+        const double approximate = metric.GetFinalError(sketch->GetResult());
+        UNIT_ASSERT_DOUBLES_EQUAL(approximate, exact, 1e-2 * exact);
+    }
+}
+}
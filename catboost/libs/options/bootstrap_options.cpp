@@ -6,6 +6,9 @@ namespace NCatboostOptions {
         CB_ENSURE(GetBaggingTemperature() >= 0, "Bagging temperature should be >= 0");
 
         EBootstrapType type = BootstrapType;
+        if (type != EBootstrapType::GOSS && LargeGradientFraction.IsSet()) {
+            ythrow TCatboostException() << "Error: large gradient fraction is available for GOSS bootstrap only";
+        }
         switch (type) {
             case EBootstrapType::Bayesian: {
                 if (TakenFraction.IsSet()) {
@@ -27,6 +30,17 @@ namespace NCatboostOptions {
                 }
                 break;
             }
+            case EBootstrapType::GOSS: {
+                if (TaskType == ETaskType::GPU) {
+                    ythrow TCatboostException()
+                        << "Error: GOSS bootstrap is not supported on GPU";
+                }
+                if (BaggingTemperature.IsSet()) {
+                    ythrow TCatboostException() << "Error: bagging temperature available for bayesian bootstrap only";
+                }
+                CB_ENSURE((GetLargeGradientFraction() > 0) && (GetLargeGradientFraction() < 1.0f), "Large gradient fraction should be in (0,1)");
+                break;
+            }
             default: {
                 Y_ASSERT(type == EBootstrapType::Bernoulli);
                 if (BaggingTemperature.IsSet()) {
@@ -13,6 +13,7 @@ namespace NCatboostOptions {
         explicit TBootstrapConfig(ETaskType taskType)
             : TakenFraction("subsample", 0.66f)
             , BaggingTemperature("bagging_temperature", 1.0)
+            , LargeGradientFraction("large_gradient_fraction", 0.2f)
             , BootstrapType("type", EBootstrapType::Bayesian)
             , TaskType(taskType)
         {
@@ -35,6 +36,11 @@ namespace NCatboostOptions {
             return BaggingTemperature.Get();
         }
 
+        // GOSS keeps this fraction of objects with the largest gradients
+        float GetLargeGradientFraction() const {
+            return LargeGradientFraction.Get();
+        }
+
         void Validate() const;
 
         TOption<float>& GetTakenFraction() {
@@ -45,12 +51,16 @@ namespace NCatboostOptions {
             return BaggingTemperature;
         }
 
+        TOption<float>& GetLargeGradientFraction() {
+            return LargeGradientFraction;
+        }
+
         TOption<EBootstrapType>& GetBootstrapType() {
             return BootstrapType;
         }
 
         void Load(const NJson::TJsonValue& options) {
-            CheckedLoad(options, &TakenFraction, &BaggingTemperature, &BootstrapType);
+            CheckedLoad(options, &TakenFraction, &BaggingTemperature, &LargeGradientFraction, &BootstrapType);
         }
 
         void Save(NJson::TJsonValue* options) const {
@@ -63,6 +73,10 @@ namespace NCatboostOptions {
                     SaveFields(options, BootstrapType);
                     break;
                 }
+                case EBootstrapType::GOSS: {
+                    SaveFields(options, TakenFraction, LargeGradientFraction, BootstrapType);
+                    break;
+                }
                 default: {
                     SaveFields(options, TakenFraction, BootstrapType);
                     break;
@@ -71,8 +85,8 @@ namespace NCatboostOptions {
         }
 
         bool operator==(const TBootstrapConfig& rhs) const {
-            return std::tie(TakenFraction, BaggingTemperature, BootstrapType) ==
-                   std::tie(rhs.TakenFraction, rhs.BaggingTemperature, rhs.BootstrapType);
+            return std::tie(TakenFraction, BaggingTemperature, LargeGradientFraction, BootstrapType) ==
+                   std::tie(rhs.TakenFraction, rhs.BaggingTemperature, rhs.LargeGradientFraction, rhs.BootstrapType);
         }
 
         bool operator!=(const TBootstrapConfig& rhs) const {
@@ -83,6 +97,7 @@ namespace NCatboostOptions {
     private:
         TOption<float> TakenFraction;
         TOption<float> BaggingTemperature;
+        TOption<float> LargeGradientFraction;
         TOption<EBootstrapType> BootstrapType;
         ETaskType TaskType;
     };
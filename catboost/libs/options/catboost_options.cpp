@@ -367,6 +367,11 @@ void TCatboostOptions::Validate() const {
                   "This leaf estimation method is not supported for querywise error for CPU learning");
     }
 
+    if (ObliviousTreeOptions->BootstrapConfig->GetBootstrapType() == EBootstrapType::GOSS) {
+        CB_ENSURE(!IsPairwiseScoring(lossFunction), "GOSS bootstrap is not supported for " << lossFunction << " loss function");
+        CB_ENSURE(BoostingOptions->BoostingType == EBoostingType::Plain, "GOSS bootstrap is supported for Plain boosting type only");
+    }
+
     ValidateCtrs(CatFeatureParams->SimpleCtrs, lossFunction, false);
     for (const auto& perFeatureCtr : CatFeatureParams->PerFeatureCtrs.Get()) {
         ValidateCtrs(perFeatureCtr.second, lossFunction, false);
@@ -384,6 +389,10 @@ void TCatBoostOptions::SetNotSpecifiedOptionsToDefaults() {
         BoostingOptions->BoostingType.SetDefault(EBoostingType::Plain);
         CB_ENSURE(BoostingOptions->BoostingType.IsDefault(), "Boosting type should be plain for " << LossFunctionDescription->GetLossFunction());
     }
+    if (ObliviousTreeOptions->BootstrapConfig->GetBootstrapType() == EBootstrapType::GOSS) {
+        BoostingOptions->BoostingType.SetDefault(EBoostingType::Plain);
+        CB_ENSURE(BoostingOptions->BoostingType == EBoostingType::Plain, "Boosting type should be Plain for GOSS bootstrap");
+    }
 
     switch (LossFunctionDescription->GetLossFunction()) {
         case ELossFunction::QueryCrossEntropy:
@@ -70,6 +70,7 @@ enum class EBootstrapType {
     Poisson,
     Bayesian,
     Bernoulli,
+    GOSS,
     No
 };
 
@@ -181,7 +182,8 @@ enum class EFstrType {
     InternalFeatureImportance,
     Interaction,
     InternalInteraction,
-    ShapValues
+    ShapValues,
+    LossFunctionChange
 };
 
 enum class EObservationsToBootstrap {
@@ -167,6 +167,7 @@ namespace NCatboostOptions {
         CopyOptionWithNewKey(plainOptions, "bootstrap_type", "type", &bootstrapOptions, &seenKeys);
         CopyOption(plainOptions, "bagging_temperature", &bootstrapOptions, &seenKeys);
         CopyOption(plainOptions, "subsample", &bootstrapOptions, &seenKeys);
+        CopyOption(plainOptions, "large_gradient_fraction", &bootstrapOptions, &seenKeys);
 
         //cat-features
         auto& ctrOptions = trainOptions["cat_feature_params"];
@@ -217,6 +218,7 @@ namespace NCatboostOptions {
         CopyOptionWithNewKey(plainOptions, "device_config", "devices", &systemOptions, &seenKeys);
         CopyOption(plainOptions, "devices", &systemOptions, &seenKeys);
         CopyOption(plainOptions, "used_ram_limit", &systemOptions, &seenKeys);
+        CopyOption(plainOptions, "dev_permuted_features_ram_limit", &systemOptions, &seenKeys);
         CopyOption(plainOptions, "gpu_ram_part", &systemOptions, &seenKeys);
         CopyOptionWithNewKey(plainOptions, "pinned_memory_size",
                              "pinned_memory_bytes", &systemOptions, &seenKeys);
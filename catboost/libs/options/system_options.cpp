@@ -18,6 +18,7 @@ TSystemOptions::TSystemOptions(ETaskType taskType)
     , NodeType("node_type", ENodeType::SingleHost, taskType)
     , FileWithHosts("file_with_hosts", "hosts.txt", taskType)
     , NodePort("node_port", GetUnusedNodePort(), taskType)
+    , PermutedFeaturesRamLimit("dev_permuted_features_ram_limit", "0", taskType)
 {
     Devices.ChangeLoadUnimplementedPolicy(ELoadUnimplementedPolicy::SkipWithWarning);
     GpuRamPart.ChangeLoadUnimplementedPolicy(ELoadUnimplementedPolicy::SkipWithWarning);
@@ -25,18 +26,19 @@ TSystemOptions::TSystemOptions(ETaskType taskType)
 }
 
 void TSystemOptions::Load(const NJson::TJsonValue& options) {
-    CheckedLoad(options, &NumThreads, &CpuUsedRamLimit, &Devices, &GpuRamPart, &PinnedMemorySize, &NodeType, &FileWithHosts, &NodePort);
+    CheckedLoad(options, &NumThreads, &CpuUsedRamLimit, &Devices, &GpuRamPart, &PinnedMemorySize, &NodeType, &FileWithHosts, &NodePort, &PermutedFeaturesRamLimit);
 }
 
 void TSystemOptions::Save(NJson::TJsonValue* options) const {
-    SaveFields(options, NumThreads, CpuUsedRamLimit, Devices, GpuRamPart, PinnedMemorySize, NodeType, FileWithHosts, NodePort);
+    SaveFields(options, NumThreads, CpuUsedRamLimit, Devices, GpuRamPart, PinnedMemorySize, NodeType, FileWithHosts, NodePort, PermutedFeaturesRamLimit);
 }
 
 bool TSystemOptions::operator==(const TSystemOptions& rhs) const {
     return std::tie(NumThreads, CpuUsedRamLimit, Devices,
-                    GpuRamPart, PinnedMemorySize, NodeType, FileWithHosts, NodePort) ==
+                    GpuRamPart, PinnedMemorySize, NodeType, FileWithHosts, NodePort, PermutedFeaturesRamLimit) ==
            std::tie(rhs.NumThreads, rhs.CpuUsedRamLimit, rhs.Devices,
-                    rhs.GpuRamPart, rhs.PinnedMemorySize, rhs.NodeType, rhs.FileWithHosts, rhs.NodePort);
+                    rhs.GpuRamPart, rhs.PinnedMemorySize, rhs.NodeType, rhs.FileWithHosts, rhs.NodePort,
+                    rhs.PermutedFeaturesRamLimit);
 }
 
 bool TSystemOptions::operator!=(const TSystemOptions& rhs) const {
@@ -47,6 +49,7 @@ void TSystemOptions::Validate() const {
     CB_ENSURE(NumThreads > 0, "thread count should be positive");
     CB_ENSURE(GpuRamPart.GetUnchecked() > 0 && GpuRamPart.GetUnchecked() <= 1.0, "GPU ram part should be in (0, 1]");
     ParseMemorySizeDescription(CpuUsedRamLimit);
+    ParseMemorySizeDescription(PermutedFeaturesRamLimit.GetUnchecked());
 }
 
 bool TSystemOptions::IsMaster() const {
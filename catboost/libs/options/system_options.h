@@ -26,6 +26,8 @@ namespace NCatboostOptions {
         TCpuOnlyOption<ENodeType> NodeType;
         TCpuOnlyOption<TString> FileWithHosts;
         TCpuOnlyOption<ui32> NodePort;
+        // RAM budget for copies of quantized learn features reordered by fold permutations
+        TCpuOnlyOption<TString> PermutedFeaturesRamLimit;
 
         static ui32 GetUnusedNodePort() { return 0; }
         bool IsMaster() const;
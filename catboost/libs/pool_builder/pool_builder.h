@@ -67,6 +67,12 @@ namespace NCB {
         virtual void AddBinarizedFloatFeature(ui32 localIdx, ui32 featureId, ui8 binarizedFeature) = 0;
         virtual void AddBinarizedFloatFeaturePack(ui32 localIdx, ui32 featureId, TConstArrayRef<ui8> binarizedFeaturePack) = 0;
         virtual void AddAllFloatFeatures(ui32 localIdx, TConstArrayRef<float> features) = 0;
+        // values of feature featureId for docs [localIdx, localIdx + featurePack.size())
+        virtual void AddFloatFeaturePack(ui32 localIdx, ui32 featureId, TConstArrayRef<float> featurePack) {
+            for (float feature : featurePack) {
+                AddFloatFeature(localIdx++, featureId, feature);
+            }
+        }
         virtual void AddLabel(ui32 localIdx, const TStringBuf& label) = 0;
         virtual void AddTarget(ui32 localIdx, float value) = 0;
         virtual void AddWeight(ui32 localIdx, float value) = 0;
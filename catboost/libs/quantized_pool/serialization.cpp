@@ -494,12 +494,16 @@ NCB::TQuantizedPool NCB::LoadQuantizedPool(
     const TStringBuf path,
     const TLoadQuantizedPoolParameters& params) {
 
-    TQuantizedPool pool;
-    pool.Blobs.push_back(params.LockMemory
+    // TODO(yazevnul): optionally precharge pool
+
+    return LoadQuantizedPool(params.LockMemory
         ? TBlob::LockedFromFile(TString(path))
         : TBlob::FromFile(TString(path)));
+}
 
-    // TODO(yazevnul): optionally precharge pool
+NCB::TQuantizedPool NCB::LoadQuantizedPool(const TBlob& blob) {
+    TQuantizedPool pool;
+    pool.Blobs.push_back(blob);
 
     const TConstArrayRef<char> blobView{
         pool.Blobs.back().AsCharPtr(),
@@ -3,6 +3,8 @@
 #include <util/generic/fwd.h>
 #include <util/stream/fwd.h>
 
+class TBlob;
+
 namespace NCB {
     struct TQuantizedPool;
     struct TQuantizedPoolDigest;
@@ -24,6 +26,10 @@ namespace NCB {
     // Load quantized pool saved by `SaveQuantizedPool` from file.
     TQuantizedPool LoadQuantizedPool(TStringBuf path, const TLoadQuantizedPoolParameters& params);
 
+    // Load quantized pool saved by `SaveQuantizedPool` from memory (e.g. after decompression),
+    // pool keeps a reference to `blob`.
+    TQuantizedPool LoadQuantizedPool(const TBlob& blob);
+
     NIdl::TPoolQuantizationSchema LoadQuantizationSchemaFromPool(TStringBuf path);
     NIdl::TPoolMetainfo LoadPoolMetainfo(TStringBuf path);
     TQuantizedPoolDigest CalculateQuantizedPoolDigest(TStringBuf path);
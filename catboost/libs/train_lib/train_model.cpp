@@ -413,11 +413,14 @@ class TCPUModelTrainer : public IModelTrainer {
         TVector<ui64> indices(pools.Learn->Docs.GetDocCount());
         std::iota(indices.begin(), indices.end(), 0);
 
-        ui64 minTimestamp = *MinElement(pools.Learn->Docs.Timestamp.begin(), pools.Learn->Docs.Timestamp.end());
-        ui64 maxTimestamp = *MaxElement(pools.Learn->Docs.Timestamp.begin(), pools.Learn->Docs.Timestamp.end());
-        if (minTimestamp != maxTimestamp) {
-            indices = CreateOrderByKey(pools.Learn->Docs.Timestamp);
-            ctx.Params.DataProcessingOptions->HasTimeFlag = true;
+        const auto& timestamps = pools.Learn->Docs.Timestamp;
+        if (!timestamps.empty()) {
+            ui64 minTimestamp = *MinElement(timestamps.begin(), timestamps.end());
+            ui64 maxTimestamp = *MaxElement(timestamps.begin(), timestamps.end());
+            if (minTimestamp != maxTimestamp) {
+                indices = CreateOrderByKey(timestamps);
+                ctx.Params.DataProcessingOptions->HasTimeFlag = true;
+            }
         }
 
         if (!ctx.Params.DataProcessingOptions->HasTimeFlag) {
@@ -1801,6 +1801,83 @@ def test_fstr(fstr_type, boosting_type):
     return local_canonical_file(output_fstr_path)
 
 
+@pytest.mark.parametrize('loss_function', ['RMSE', 'MultiClass'])
+def test_loss_function_change_matches_eval_metrics(loss_function):
+    # the model has a single split, so removing its feature replaces the tree by the weighted average of its leaves
+    train, cd = data_file('cloudness_small', 'train_small'), data_file('cloudness_small', 'train_float.cd')
+    model_path = yatest.common.test_output_path('model.bin')
+    eval_metrics_path = yatest.common.test_output_path('eval_metrics.tsv')
+    predictions_path = yatest.common.test_output_path('predictions.tsv')
+    fstr_path = yatest.common.test_output_path('fstr.tsv')
+
+    class_names = ['2', '0', '1']
+    cmd = (
+        CATBOOST_PATH,
+        'fit',
+        '--loss-function', loss_function,
+        '-f', train,
+        '--column-description', cd,
+        '--boosting-type', 'Plain',
+        '-i', '1',
+        '--depth', '1',
+        '-w', '0.5',
+        '-T', '1',
+        '-r', '0',
+        '-m', model_path,
+    )
+    if loss_function == 'MultiClass':
+        # class indices differ from labels
+        cmd += ('--class-names', ','.join(class_names))
+    yatest.common.execute(cmd)
+
+    yatest.common.execute((
+        CATBOOST_PATH,
+        'eval-metrics',
+        '--metrics', loss_function,
+        '--input-path', train,
+        '--column-description', cd,
+        '-m', model_path,
+        '-o', eval_metrics_path,
+        '-T', '1',
+    ))
+    yatest.common.execute((
+        CATBOOST_PATH,
+        'calc',
+        '--input-path', train,
+        '--column-description', cd,
+        '-m', model_path,
+        '--output-path', predictions_path,
+        '--prediction-type', 'RawFormulaVal',
+    ))
+    yatest.common.execute((
+        CATBOOST_PATH,
+        'fstr',
+        '--input-path', train,
+        '--column-description', cd,
+        '-m', model_path,
+        '-o', fstr_path,
+        '--fstr-type', 'LossFunctionChange',
+        '-T', '1',
+    ))
+
+    model_loss = np.loadtxt(eval_metrics_path, skiprows=1, ndmin=2)[0, 1]
+    approx = np.loadtxt(predictions_path, skiprows=1, ndmin=2)[:, 1:]
+    target = np.loadtxt(train, usecols=(0,))
+    leaves = np.unique(approx, axis=0, return_counts=True)
+    assert len(leaves[0]) == 2
+    averaged_approx = np.tile(np.average(leaves[0], axis=0, weights=leaves[1]), (len(target), 1))
+
+    if loss_function == 'MultiClass':
+        class_idx = np.array([class_names.index(str(int(label))) for label in target])
+        averaged_loss = -np.mean(averaged_approx[np.arange(len(target)), class_idx] - np.log(np.sum(np.exp(averaged_approx), axis=1)))
+    else:
+        averaged_loss = np.sqrt(np.mean((averaged_approx[:, 0] - target) ** 2))
+
+    scores = np.loadtxt(fstr_path, usecols=(0,), ndmin=1)
+    assert np.count_nonzero(scores) == 1
+    assert np.allclose(scores.sum(), averaged_loss - model_loss, rtol=1e-4, atol=1e-5)
+
+
 @pytest.mark.parametrize('loss_function', LOSS_FUNCTIONS)
 @pytest.mark.parametrize(
     'dev_score_calc_obj_block_size',
@@ -3146,6 +3223,63 @@ def test_bootstrap(boosting_type, dev_score_calc_obj_block_size):
     return [local_canonical_file(ref_eval_path)]
 
 
+@pytest.mark.parametrize('sampling_frequency', ['PerTree', 'PerTreeLevel'])
+def test_goss_bootstrap(sampling_frequency):
+    cmd = (
+        CATBOOST_PATH,
+        'fit',
+        '--use-best-model', 'false',
+        '--loss-function', 'RMSE',
+        '-f', data_file('adult', 'train_small'),
+        '-t', data_file('adult', 'test_small'),
+        '--column-description', data_file('adult', 'train.cd'),
+        '-i', '10',
+        '-w', '0.03',
+        '-T', '4',
+        '-r', '0',
+        '--sampling-frequency', sampling_frequency,
+    )
+    goss_option = ('--bootstrap-type', 'GOSS', '--large-gradient-fraction', '0.2', '--subsample', '0.1',)
+    output_eval_path = yatest.common.test_output_path('test.eval')
+    yatest.common.execute(cmd + goss_option + ('-m', yatest.common.test_output_path('model.bin'), '--eval-file', output_eval_path,))
+
+    # with a low subsample most of the objects are dropped, so predictions differ from training on all of them
+    no_bootstrap_eval_path = yatest.common.test_output_path('test_no.eval')
+    yatest.common.execute(cmd + ('--bootstrap-type', 'No', '-m', yatest.common.test_output_path('model_no.bin'), '--eval-file', no_bootstrap_eval_path,))
+    assert not filecmp.cmp(output_eval_path, no_bootstrap_eval_path)
+
+    with pytest.raises(yatest.common.ExecutionError):
+        yatest.common.execute(cmd + goss_option + ('-m', yatest.common.test_output_path('model_ordered.bin'), '--boosting-type', 'Ordered',))
+
+
+@pytest.mark.parametrize('boosting_type', BOOSTING_TYPE)
+def test_permuted_features_ram_limit(boosting_type):
+    eval_paths = []
+    for ram_limit in ('0', '100kb', 'inf'):
+        output_eval_path = yatest.common.test_output_path('test_{}.eval'.format(ram_limit))
+        cmd = (
+            CATBOOST_PATH,
+            'fit',
+            '--use-best-model', 'false',
+            '--loss-function', 'Logloss',
+            '-f', data_file('adult', 'train_small'),
+            '-t', data_file('adult', 'test_small'),
+            '--column-description', data_file('adult', 'train.cd'),
+            '--boosting-type', boosting_type,
+            '-i', '10',
+            '-w', '0.03',
+            '-T', '4',
+            '--dev-permuted-features-ram-limit', ram_limit,
+            '-m', yatest.common.test_output_path('model_{}.bin'.format(ram_limit)),
+            '--eval-file', output_eval_path,
+        )
+        yatest.common.execute(cmd)
+        eval_paths.append(output_eval_path)
+
+    for eval_path in eval_paths[1:]:
+        assert filecmp.cmp(eval_paths[0], eval_path)
+
+
 def test_json_logging():
     output_model_path = yatest.common.test_output_path('model.bin')
     output_eval_path = yatest.common.test_output_path('test.eval')
@@ -3684,6 +3818,49 @@ def test_eval_metrics(metric, metric_period):
     return [local_canonical_file(eval_path)]
 
 
+# learn metrics are evaluated incrementally, they should match evaluation of the model on the learn set from scratch
+@pytest.mark.parametrize('metric_period', ['1', '3'])
+def test_learn_metrics_match_eval_metrics(metric_period):
+    train, cd = data_file('querywise', 'train'), data_file('querywise', 'train.cd')
+    output_model_path = yatest.common.test_output_path('model.bin')
+    learn_error_path = yatest.common.test_output_path('learn_error.tsv')
+    eval_path = yatest.common.test_output_path('output.tsv')
+    cmd = (
+        CATBOOST_PATH,
+        'fit',
+        '--loss-function', 'RMSE',
+        '--custom-metric', 'MAE',
+        '--boosting-type', 'Plain',
+        '-f', train,
+        '--column-description', cd,
+        '-i', '20',
+        '-w', '0.03',
+        '-T', '4',
+        '-r', '0',
+        '-m', output_model_path,
+        '--learn-err-log', learn_error_path,
+        '--metric-period', metric_period
+    )
+    yatest.common.execute(cmd)
+
+    cmd = (
+        CATBOOST_PATH,
+        'eval-metrics',
+        '--metrics', 'RMSE,MAE',
+        '--input-path', train,
+        '--column-description', cd,
+        '-m', output_model_path,
+        '-o', eval_path,
+        '--block-size', '100',
+        '--eval-period', metric_period
+    )
+    yatest.common.execute(cmd)
+
+    first_metrics = np.round(np.loadtxt(learn_error_path, skiprows=1)[:, 1:3], 8)
+    second_metrics = np.round(np.loadtxt(eval_path, skiprows=1)[:, 1:3], 8)
+    assert np.all(first_metrics == second_metrics)
+
+
 @pytest.mark.parametrize('metric_period', ['1', '2'])
 @pytest.mark.parametrize('metric', ['MultiClass', 'MultiClassOneVsAll', 'F1', 'Accuracy', 'TotalF1', 'MCC', 'Precision', 'Recall'])
 @pytest.mark.parametrize('loss_function', MULTICLASS_LOSSES)
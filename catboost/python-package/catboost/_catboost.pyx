@@ -331,6 +331,17 @@ cdef extern from "catboost/libs/metrics/metric.h":
             void* customData
         ) except * with gil
 
+        void (*CalcDersMultiRange)(
+            int count,
+            int approxDimension,
+            const double* approxes,
+            const float* targets,
+            const float* weights,
+            double* ders,
+            double* der2,
+            void* customData
+        ) except * with gil
+
 cdef extern from "catboost/libs/options/cross_validation_params.h":
     cdef cppclass TCrossValidationParams:
         size_t FoldCount
@@ -714,6 +725,35 @@ cdef void _ObjectiveCalcDersMulti(
             dereference(der2).Data[index] = num
             index += 1
 
+cdef void _ObjectiveCalcDersMultiRange(
+    int count,
+    int approxDimension,
+    const double* approxes,
+    const float* targets,
+    const float* weights,
+    double* ders,
+    double* der2,
+    void* customData
+) except * with gil:
+    cdef objectiveObject = <object>(customData)
+    cdef int der2Size = approxDimension * (approxDimension + 1) // 2
+
+    # numpy views of catboost buffers, approxes are [object][dimension]
+    approx = np.asarray(<double[:count, :approxDimension]> <double*> approxes)
+    target = np.asarray(<float[:count]> <float*> targets)
+    if weights:
+        weight = np.asarray(<float[:count]> <float*> weights)
+    else:
+        weight = None
+
+    ders_matrix, second_ders_matrices = objectiveObject.calc_ders_multi_range(approx, target, weight)
+    np.asarray(<double[:count, :approxDimension]> ders)[...] = ders_matrix
+    if der2:
+        # only upper triangles of symmetric hessians are stored
+        upper_rows, upper_columns = np.triu_indices(approxDimension)
+        second_ders_matrices = np.asarray(second_ders_matrices, dtype=np.float64)
+        np.asarray(<double[:count, :der2Size]> der2)[...] = second_ders_matrices[:, upper_rows, upper_columns]
+
 cdef TCustomMetricDescriptor _BuildCustomMetricDescriptor(object metricObject):
     cdef TCustomMetricDescriptor descriptor
     descriptor.CustomData = <void*>metricObject
@@ -728,6 +768,8 @@ cdef TCustomObjectiveDescriptor _BuildCustomObjectiveDescriptor(object objective
     descriptor.CustomData = <void*>objectiveObject
     descriptor.CalcDersRange = &_ObjectiveCalcDersRange
     descriptor.CalcDersMulti = &_ObjectiveCalcDersMulti
+    if hasattr(objectiveObject, 'calc_ders_multi_range'):
+        descriptor.CalcDersMultiRange = &_ObjectiveCalcDersMultiRange
     return descriptor
 
 cdef class PyPredictionType:
@@ -776,6 +776,8 @@ def _process_synonyms(params):
 
     if 'used_ram_limit' in params:
         params['used_ram_limit'] = str(params['used_ram_limit'])
+    if 'dev_permuted_features_ram_limit' in params:
+        params['dev_permuted_features_ram_limit'] = str(params['dev_permuted_features_ram_limit'])
 
 
 class _CatBoostBase(object):
@@ -1702,6 +1704,10 @@ class CatBoostClassifier(CatBoost):
         problem to solve. If string, then the name of a supported metric,
         optionally suffixed with parameter description.
         If object, it shall provide methods 'calc_ders_range' or 'calc_ders_multi'.
+        Multiclass objects can also provide 'calc_ders_multi_range(approxes, targets, weights)',
+        it is called for ranges of objects with numpy arrays of approxes [object][dimension], targets and
+        weights (or None) and shall return derivatives [object][dimension] and second derivatives
+        [object][dimension][dimension].
     border_count : int, [default=32]
         The number of partitions for Num features. Used in the preliminary calculation.
         range: (0,+inf]
@@ -1893,18 +1899,29 @@ class CatBoostClassifier(CatBoost):
         String format is: '0' for 1 device or '0:1:3' for multiple devices or '0-3' for range of devices.
         List format is : [0] for 1 device or [0,1,3] for multiple devices.
 
-    bootstrap_type : string, Bayesian, Bernoulli, Poisson.
+    bootstrap_type : string, Bayesian, Bernoulli, Poisson, GOSS.
         Default bootstrap is Bayesian.
         Poisson bootstrap is supported only on GPU.
+        GOSS bootstrap is supported only on CPU for Plain boosting type.
 
     subsample : float, [default=None]
-        Sample rate for bagging. This parameter can be used Poisson or Bernoully bootstrap types.
+        Sample rate for bagging. This parameter can be used Poisson, Bernoully or GOSS bootstrap types.
+        For GOSS it is the sample rate of objects with small gradients.
+
+    large_gradient_fraction : float, [default=None]
+        Fraction of objects with the largest gradients that GOSS bootstrap always takes.
+        Possible values are from (0, 1); 0.2 by default.
 
     dev_score_calc_obj_block_size: int, [default=5000000]
         CPU only. Size of block of samples in score calculation. Should be > 0
         Used only for learning speed tuning.
         Changing this parameter can affect results due to numerical accuracy differences
 
+    dev_permuted_features_ram_limit : string or number, [default='0']
+        CPU only. Memory for copies of quantized features reordered by fold permutations
+        (value like '1.2gb' or 1.2e9), folds that do not fit are read through the permutation.
+        Used only for learning speed tuning, does not change results.
+
     max_depth : int, Synonym for depth.
 
     n_estimators : int, synonym for iterations.
@@ -1999,7 +2016,9 @@ class CatBoostClassifier(CatBoost):
         devices=None,
         bootstrap_type=None,
         subsample=None,
+        large_gradient_fraction=None,
         dev_score_calc_obj_block_size=None,
+        dev_permuted_features_ram_limit=None,
         max_depth=None,
         n_estimators=None,
         num_boost_round=None,
@@ -2358,7 +2377,9 @@ class CatBoostRegressor(CatBoost):
         devices=None,
         bootstrap_type=None,
         subsample=None,
+        large_gradient_fraction=None,
         dev_score_calc_obj_block_size=None,
+        dev_permuted_features_ram_limit=None,
         max_depth=None,
         n_estimators=None,
         num_boost_round=None,
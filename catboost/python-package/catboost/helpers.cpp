@@ -65,10 +65,8 @@ TVector<TVector<double>> EvalMetrics(
         plotCalcer.FinishProceedDataSetForAdditiveMetrics();
     }
     if (plotCalcer.HasNonAdditiveMetric()) {
-        while (!plotCalcer.AreAllIterationsProcessed()) {
-            plotCalcer.ProceedDataSetForNonAdditiveMetrics(pool);
-            plotCalcer.FinishProceedDataSetForNonAdditiveMetrics();
-        }
+        // the pool is in memory, so approxes are kept in memory too instead of saving them to tmpDir
+        plotCalcer.ComputeNonAdditiveMetrics(pool);
     }
 
     TVector<TVector<double>> metricsScore = plotCalcer.GetMetricsScore();
@@ -1198,6 +1198,47 @@ def test_custom_objective(task_type):
         assert abs(p1 - p2) < EPS
 
 
+class MultiClassObjective(object):
+    def calc_ders_multi(self, approxes, target, weight):
+        approxes = np.array(approxes)
+        probabilities = np.exp(approxes - np.max(approxes))
+        probabilities /= np.sum(probabilities)
+        der1 = -probabilities
+        der1[int(target)] += 1
+        der2 = np.outer(probabilities, probabilities) - np.diag(probabilities)
+        return der1 * weight, der2 * weight
+
+
+class MultiClassRangeObjective(MultiClassObjective):
+    def calc_ders_multi_range(self, approxes, targets, weights):
+        assert approxes.shape[0] == len(targets)
+        probabilities = np.exp(approxes - np.max(approxes, axis=1, keepdims=True))
+        probabilities /= np.sum(probabilities, axis=1, keepdims=True)
+        der1 = -probabilities
+        der1[np.arange(len(targets)), targets.astype(int)] += 1
+        der2 = np.einsum('ij,ik->ijk', probabilities, probabilities)
+        der2[:, np.arange(approxes.shape[1]), np.arange(approxes.shape[1])] -= probabilities
+        if weights is not None:
+            der1 *= weights[:, np.newaxis]
+            der2 *= weights[:, np.newaxis, np.newaxis]
+        return der1, der2
+
+
+@fails_on_gpu(how='cuda/train_lib/train.cpp:283: Error: loss function is not supported for GPU learning Custom')
+def test_custom_objective_multi_range(task_type):
+    train_pool = Pool(CLOUDNESS_TRAIN_FILE, column_description=CLOUDNESS_CD_FILE)
+    test_pool = Pool(CLOUDNESS_TEST_FILE, column_description=CLOUDNESS_CD_FILE)
+
+    predictions = []
+    for objective in [MultiClassObjective(), MultiClassRangeObjective()]:
+        model = CatBoost(dict(iterations=5, learning_rate=0.03, random_seed=0, loss_function=objective,
+                              eval_metric='MultiClass', leaf_estimation_method='Newton', task_type=task_type, devices='0'))
+        model.fit(train_pool)
+        predictions.append(model.predict(test_pool, prediction_type='RawFormulaVal'))
+
+    assert np.allclose(predictions[0], predictions[1], atol=EPS)
+
+
 def test_pool_after_fit(task_type):
     pool1 = Pool(TRAIN_FILE, column_description=CD_FILE)
     pool2 = Pool(TRAIN_FILE, column_description=CD_FILE)